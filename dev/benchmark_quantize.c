@@ -0,0 +1,164 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file benchmark_quantize.c
+ * \brief Microbenchmark for the quantize() function emitted by the code generator. Compares the
+ *        generated quantize() with the binary search used by earlier versions of TL2cgen, and
+ *        checks that both give the same bin indices.
+ *
+ * The generated quantize.c is included below, so this file must be compiled with the directory
+ * holding the generated code in the include path. Use dev/benchmark_quantize.py, which generates
+ * the code with quantize=1 for synthetic thresholds, then builds and runs this benchmark.
+ * \author Hyunsu Cho
+ */
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "quantize.c"
+
+#define NUM_QUERY 1000000
+#define NUM_REPEAT 20
+
+/* In the generated code, quantize() is defined in its own translation unit and called once per
+   feature, so keep the compiler from inlining it into the timing loop. The queries are also
+   read through a volatile pointer, so that the calls of one repetition cannot be reused in the
+   next. */
+#if defined(__clang__) || defined(__GNUC__)
+#define NOINLINE __attribute__((noinline))
+#else
+#define NOINLINE
+#endif
+
+/* Binary search, as emitted by earlier versions. Returns -10 for values below all thresholds,
+   2i for a value equal to the i-th threshold, and 2i+1 for a value between the i-th and the
+   (i+1)-th thresholds. */
+static NOINLINE int quantize_binary_search(const float* array, int len, float val) {
+  int low = 0;
+  int high = len;
+  int mid;
+  float mval;
+  if (val < array[0]) {
+    return -10;
+  }
+  while (low + 1 < high) {
+    mid = (low + high) / 2;
+    mval = array[mid];
+    if (val == mval) {
+      return mid * 2;
+    } else if (val < mval) {
+      high = mid;
+    } else {
+      low = mid;
+    }
+  }
+  if (array[low] == val) {
+    return low * 2;
+  } else if (high == len) {
+    return len * 2;
+  } else {
+    return low * 2 + 1;
+  }
+}
+
+/* Map the bin index of the binary search to the one of the current quantize() */
+static int normalize_old_bin(int bin, int len) {
+  if (bin == -10) {
+    return 0;
+  }
+  return (bin == 2 * len) ? bin : bin + 1;
+}
+
+static NOINLINE int quantize_generated(float val, unsigned fid) {
+  return quantize(val, fid);
+}
+
+static int compare_float(const void* a, const void* b) {
+  const float x = *(const float*)a;
+  const float y = *(const float*)b;
+  return (x > y) - (x < y);
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main(void) {
+  const unsigned num_feature = sizeof(th_len) / sizeof(th_len[0]);
+  float* query = (float*)malloc(sizeof(float) * NUM_QUERY);
+  srand(0);
+  printf("%6s %16s %18s   %s\n", "len", "binary (ns/val)", "quantize (ns/val)", "method");
+  for (unsigned fid = 0; fid < num_feature; ++fid) {
+    const int len = th_len[fid];
+    if (len == 0) {
+      continue;
+    }
+    /* Recover the sorted thresholds from the block of the feature, skipping the sentinel and
+       the padding (NaN) */
+    const int num_slot = (th_depth[fid] > 0) ? (1 << th_depth[fid]) - 1 : len;
+    float* sorted = (float*)malloc(sizeof(float) * len);
+    int n = 0;
+    for (int k = 1; k <= num_slot; ++k) {
+      if (!isnan(threshold[th_begin[fid] + k])) {
+        sorted[n++] = (float)threshold[th_begin[fid] + k];
+      }
+    }
+    if (n != len) {
+      fprintf(stderr, "Feature %u: expected %d thresholds, found %d\n", fid, len, n);
+      return 1;
+    }
+    qsort(sorted, len, sizeof(float), compare_float);
+    /* Draw values below, between, equal to and above the thresholds */
+    for (int i = 0; i < NUM_QUERY; ++i) {
+      const int j = rand() % (len + 2) - 1;
+      if (j < 0) {
+        query[i] = sorted[0] - 1.0f;
+      } else if (j == len) {
+        query[i] = sorted[len - 1] + 1.0f;
+      } else if (rand() % 2 == 0 || j == len - 1) {
+        query[i] = sorted[j];
+      } else {
+        query[i] = 0.5f * (sorted[j] + sorted[j + 1]);
+      }
+    }
+
+    for (int i = 0; i < NUM_QUERY; ++i) {
+      const int expected = normalize_old_bin(quantize_binary_search(sorted, len, query[i]), len);
+      const int got = quantize_generated(query[i], fid);
+      if (got != expected) {
+        fprintf(stderr, "Mismatch for len = %d, value = %g: expected %d, got %d\n", len,
+            query[i], expected, got);
+        return 1;
+      }
+    }
+
+    const volatile float* timed_query = query;
+    long long checksum = 0;
+    double elapsed[2];
+    double start = now();
+    for (int r = 0; r < NUM_REPEAT; ++r) {
+      for (int i = 0; i < NUM_QUERY; ++i) {
+        checksum += quantize_binary_search(sorted, len, timed_query[i]);
+      }
+    }
+    elapsed[0] = now() - start;
+    start = now();
+    for (int r = 0; r < NUM_REPEAT; ++r) {
+      for (int i = 0; i < NUM_QUERY; ++i) {
+        checksum += quantize_generated(timed_query[i], fid);
+      }
+    }
+    elapsed[1] = now() - start;
+    printf("%6d %16.2f %18.2f   %s (checksum %lld)\n", len,
+        elapsed[0] * 1e9 / ((double)NUM_QUERY * NUM_REPEAT),
+        elapsed[1] * 1e9 / ((double)NUM_QUERY * NUM_REPEAT),
+        (th_depth[fid] > 0) ? "eytzinger" : "count", checksum);
+    free(sorted);
+  }
+  free(query);
+  return 0;
+}
@@ -0,0 +1,121 @@
+"""
+Microbenchmark for the quantize() function in the generated code. Build a model with
+one feature per number of thresholds, generate its C code with quantize=1, then build
+and run dev/benchmark_quantize.c against the generated quantize.c.
+
+Usage:
+  PYTHONPATH=./python python dev/benchmark_quantize.py
+"""
+
+import argparse
+import os
+import pathlib
+import subprocess
+import tempfile
+
+import numpy as np
+import treelite
+from treelite.model_builder import (
+    Metadata,
+    ModelBuilder,
+    PostProcessorFunc,
+    TreeAnnotation,
+)
+
+import tl2cgen
+
+ROOT = pathlib.Path(__file__).parent.parent.expanduser().resolve()
+NUM_THRESHOLDS = [4, 16, 64, 100, 256, 1000, 4096]
+
+
+def build_model(num_thresholds: list[int], seed: int) -> treelite.Model:
+    """Build a model whose i-th tree tests feature i against num_thresholds[i] distinct
+    thresholds, arranged as a balanced binary search tree"""
+    rng = np.random.default_rng(seed=seed)
+    num_tree = len(num_thresholds)
+    builder = ModelBuilder(
+        threshold_type="float32",
+        leaf_output_type="float32",
+        metadata=Metadata(
+            num_feature=num_tree,
+            task_type="kRegressor",
+            average_tree_output=False,
+            num_target=1,
+            num_class=[1],
+            leaf_vector_shape=(1, 1),
+        ),
+        tree_annotation=TreeAnnotation(
+            num_tree=num_tree, target_id=[0] * num_tree, class_id=[0] * num_tree
+        ),
+        postprocessor=PostProcessorFunc(name="identity"),
+        base_scores=[0.0],
+    )
+    for fid, num_threshold in enumerate(num_thresholds):
+        thresholds = np.empty(0, dtype=np.float32)
+        while thresholds.size < num_threshold:
+            extra = rng.uniform(-100.0, 100.0, size=num_threshold).astype(np.float32)
+            thresholds = np.unique(np.concatenate((thresholds, extra)))
+        thresholds = np.sort(rng.choice(thresholds, size=num_threshold, replace=False))
+        next_key = 0
+
+        def add_subtree(begin: int, end: int) -> int:
+            """Add the test nodes for thresholds[begin:end] and return the key of the
+            subtree root"""
+            nonlocal next_key
+            key = next_key
+            next_key += 1
+            builder.start_node(key)
+            if begin == end:
+                builder.leaf(float(begin))
+                builder.end_node()
+                return key
+            mid = (begin + end) // 2
+            left_key = next_key
+            right_key = next_key + (2 * (mid - begin) + 1)
+            builder.numerical_test(
+                feature_id=fid,
+                threshold=float(thresholds[mid]),
+                default_left=True,
+                opname="<",
+                left_child_key=left_key,
+                right_child_key=right_key,
+            )
+            builder.end_node()
+            assert add_subtree(begin, mid) == left_key
+            assert add_subtree(mid + 1, end) == right_key
+            return key
+
+        builder.start_tree()
+        add_subtree(0, num_threshold)
+        builder.end_tree()
+    return builder.commit()
+
+
+def main(args: argparse.Namespace) -> None:
+    """Generate the code, then build and run the benchmark"""
+    model = build_model(NUM_THRESHOLDS, args.seed)
+    with tempfile.TemporaryDirectory() as tmpdir:
+        dirpath = pathlib.Path(tmpdir) / "model"
+        tl2cgen.generate_c_code(model, dirpath=dirpath, params={"quantize": 1})
+        exe = pathlib.Path(tmpdir) / "benchmark_quantize"
+        subprocess.run(
+            [
+                os.environ.get("CC", "gcc"),
+                "-O3",
+                "-march=native",
+                "-std=c99",
+                f"-I{dirpath}",
+                "-o",
+                str(exe),
+                str(ROOT / "dev" / "benchmark_quantize.c"),
+                "-lm",
+            ],
+            check=True,
+        )
+        subprocess.run([str(exe)], check=True)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--seed", type=int, default=0, help="Seed for the thresholds")
+    main(parser.parse_args())
@@ -184,6 +184,20 @@ TL2CGEN_DLL int TL2cgenGenerateCode(
  */
 TL2CGEN_DLL int TL2cgenDumpAST(
     TL2cgenModelHandle model, char const* compiler_params_json_str, char const** out_dump_str);
+/*!
+ * \brief Compute the largest change in the margin scores caused by storing the leaf outputs with
+ *        reduced precision (compiler parameter leaf_output_precision), over the rows of a
+ *        validation data matrix.
+ * \param model Handle for tree ensemble model
+ * \param compiler_params_json_str JSON string representing the parameters for the compiler
+ * \param dmat Validation data matrix
+ * \param nthread Number of threads to use
+ * \param out_deviation Used to store the largest absolute change in the margin scores
+ * \return 0 for success, -1 for failure
+ */
+TL2CGEN_DLL int TL2cgenComputeLeafOutputDeviation(TL2cgenModelHandle model,
+    char const* compiler_params_json_str, TL2cgenDMatrixHandle dmat, int nthread,
+    double* out_deviation);
 /*! \} */
 
 /*!
@@ -251,6 +265,33 @@ TL2CGEN_DLL int TL2cgenDMatrixFree(TL2cgenDMatrixHandle handle);
 TL2CGEN_DLL int TL2cgenPredictorLoad(
     char const* library_path, int num_worker_thread, TL2cgenPredictorHandle* out);
 
+/*!
+ * \brief Compile a model into machine code in memory and load the prediction function, without
+ *        writing any file or running an external compiler. TL2cgen must be built with the CMake
+ *        option USE_GCCJIT, which uses libgccjit.
+ * \param model Handle to tree ensemble model
+ * \param compiler_params_json_str JSON string representing the parameters for the compiler.
+ *        Only the parameters that change the predictions (e.g. leaf_output_precision) apply.
+ * \param num_worker_thread Number of worker threads (<= 0 to use max number)
+ * \param out Handle to predictor
+ * \return 0 for success, -1 for failure
+ */
+TL2CGEN_DLL int TL2cgenPredictorLoadJIT(TL2cgenModelHandle model,
+    char const* compiler_params_json_str, int num_worker_thread, TL2cgenPredictorHandle* out);
+
+/*!
+ * \brief Load a predictor that walks the trees of a model directly, without generating or
+ *        compiling any code. The predictor holds a copy of the model, so the model may be freed
+ *        afterwards. Prediction with a range of trees and TL2cgenPredictorPredictDecision() are
+ *        not supported.
+ * \param model Handle to tree ensemble model
+ * \param num_worker_thread Number of worker threads (<= 0 to use max number)
+ * \param out Handle to predictor
+ * \return 0 for success, -1 for failure
+ */
+TL2CGEN_DLL int TL2cgenPredictorLoadInterpreter(
+    TL2cgenModelHandle model, int num_worker_thread, TL2cgenPredictorHandle* out);
+
 /*!
  * \brief Make predictions for a data matrix (synchronously). This function internally
  *        divides the workload among all worker threads.
@@ -267,6 +308,64 @@ TL2CGEN_DLL int TL2cgenPredictorLoad(
 TL2CGEN_DLL int TL2cgenPredictorPredictBatch(TL2cgenPredictorHandle predictor,
     TL2cgenDMatrixHandle dmat, int verbose, int pred_margin, void* out_result);
 
+/*!
+ * \brief Make predictions for a data matrix (synchronously), using only the trees in the range
+ *        [tree_begin, tree_end). The shared library must be generated with the compiler
+ *        parameter tree_functions.
+ * \param predictor Predictor
+ * \param dmat Data matrix
+ * \param verbose Whether to produce extra messages
+ * \param pred_margin Whether to produce raw margin scores instead of
+ *                    transformed probabilities
+ * \param tree_begin Beginning of the range of trees
+ * \param tree_end End of the range of trees. Must be at most
+ *                 \ref TL2cgenPredictorGetNumTree.
+ * \param out_result Resulting output vector. This pointer must point to an array of shape
+ *                   \ref TL2cgenPredictorGetOutputShape and of type
+ *                   \ref TL2cgenPredictorGetLeafOutputType.
+ * \return 0 for success, -1 for failure
+ */
+TL2CGEN_DLL int TL2cgenPredictorPredictBatchWithTreeRange(TL2cgenPredictorHandle predictor,
+    TL2cgenDMatrixHandle dmat, int verbose, int pred_margin, int32_t tree_begin,
+    int32_t tree_end, void* out_result);
+
+/*!
+ * \brief For each row in a data matrix, decide whether the margin score is greater than a
+ *        threshold (synchronously). Trees are evaluated only until the decision is certain.
+ *        The shared library must be generated with the compiler parameter tree_functions,
+ *        from a model with a single output that does not average tree outputs.
+ * \param predictor Predictor
+ * \param dmat Data matrix
+ * \param verbose Whether to produce extra messages
+ * \param threshold Threshold for the margin score
+ * \param out_result Resulting decisions (1 or 0). This pointer must point to an array of shape
+ *                   \ref TL2cgenPredictorGetOutputShape and of type
+ *                   \ref TL2cgenPredictorGetLeafOutputType.
+ * \return 0 for success, -1 for failure
+ */
+TL2CGEN_DLL int TL2cgenPredictorPredictDecision(TL2cgenPredictorHandle predictor,
+    TL2cgenDMatrixHandle dmat, int verbose, double threshold, void* out_result);
+
+/*!
+ * \brief For each row in a data matrix, find the k classes with the highest margin scores
+ *        (synchronously). The postprocessor is not applied. A decreasing postprocessor, such as
+ *        exponential_standard_ratio, ranks the classes in the opposite order.
+ * \param predictor Predictor
+ * \param dmat Data matrix
+ * \param verbose Whether to produce extra messages
+ * \param k Number of classes to select per output target. Must be between 1 and the largest
+ *          number of classes. Use k=1 to get the argmax.
+ * \param out_index Resulting class IDs, in descending order of margin score, with NaN scores
+ *                  last. This pointer must point to an array of shape (num_row, num_target, k).
+ *                  For targets with fewer than k classes, the excess entries are set to -1.
+ * \param out_score Resulting margin scores of the selected classes. This pointer must point to
+ *                  an array of shape (num_row, num_target, k) and of type
+ *                  \ref TL2cgenPredictorGetLeafOutputType. The excess entries are set to NaN.
+ * \return 0 for success, -1 for failure
+ */
+TL2CGEN_DLL int TL2cgenPredictorPredictTopK(TL2cgenPredictorHandle predictor,
+    TL2cgenDMatrixHandle dmat, int verbose, int32_t k, int32_t* out_index, void* out_score);
+
 /*!
  * \brief Given a data matrix, get the output shape of array to hold predictions for all rows.
  * \param predictor Predictor
@@ -321,6 +420,16 @@ TL2CGEN_DLL int TL2cgenPredictorGetNumTarget(TL2cgenPredictorHandle predictor, i
  */
 TL2CGEN_DLL int TL2cgenPredictorGetNumClass(TL2cgenPredictorHandle predictor, int32_t* out);
 
+/*!
+ * \brief Get the number of trees that can be selected with
+ *        \ref TL2cgenPredictorPredictBatchWithTreeRange.
+ * \param predictor Predictor
+ * \param out Number of trees, or -1 if the shared library does not support prediction with a
+ *            range of trees
+ * \return 0 for success, -1 for failure
+ */
+TL2CGEN_DLL int TL2cgenPredictorGetNumTree(TL2cgenPredictorHandle predictor, int32_t* out);
+
 /*!
  * \brief Delete predictor from memory
  * \param predictor Predictor to remove
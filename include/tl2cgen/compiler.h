@@ -19,6 +19,14 @@ namespace treelite {
 class Model;  // forward declaration
 }  // namespace treelite
 
+namespace tl2cgen {
+class DMatrix;  // forward declaration
+}  // namespace tl2cgen
+
+namespace tl2cgen::predictor::detail {
+class SharedLibrary;  // forward declaration
+}  // namespace tl2cgen::predictor::detail
+
 namespace tl2cgen::compiler {
 
 struct CompilerParam;  // forward declaration
@@ -33,6 +41,20 @@ struct CompilerParam;  // forward declaration
 void CompileModel(
     treelite::Model const& model, CompilerParam const& param, std::filesystem::path const& dirpath);
 
+/*!
+ * \brief Compile tree model into machine code in memory, using libgccjit. No file is written and
+ *        no external compiler is run. Requires TL2cgen to be built with the CMake option
+ *        USE_GCCJIT. Of the compiler parameters, only those that change the predictions (e.g.
+ *        leaf_output_precision) apply; those that choose the layout of the C code are ignored.
+ * \param model Model to compile
+ * \param param Parameters to control code generation
+ * \return Library with the same prediction functions as the shared library built from the
+ *         generated C code, to be loaded into \ref tl2cgen::predictor::Predictor. Prediction with
+ *         a range of trees is not supported.
+ */
+std::unique_ptr<predictor::detail::SharedLibrary> CompileModelJIT(
+    treelite::Model const& model, CompilerParam const& param);
+
 /*!
  * \brief Obtain human-readable representation of Abstract Syntax Tree (AST) generated by
  *        the compiler. Useful for debugging the code generation process.
@@ -42,6 +64,21 @@ void CompileModel(
  */
 std::string DumpAST(treelite::Model const& model, CompilerParam const& param);
 
+/*!
+ * \brief Compute the largest change in the margin scores caused by storing the leaf outputs with
+ *        the precision given by param.leaf_output_precision, over the rows of a data matrix.
+ *        The change is computed by walking the trees, without generating any code.
+ * \param model Tree ensemble model
+ * \param param Parameters to control code generation
+ * \param dmat Validation data matrix
+ * \param nthread Number of threads to use
+ * \return Largest absolute difference between the margin scores computed with the rounded leaf
+ *         outputs and those computed with the original leaf outputs. 0 if the precision is
+ *         "native".
+ */
+double ComputeLeafOutputDeviation(
+    treelite::Model const& model, CompilerParam const& param, DMatrix const* dmat, int nthread);
+
 }  // namespace tl2cgen::compiler
 
 #endif  // TL2CGEN_COMPILER_H_
@@ -36,6 +36,124 @@ struct CompilerParam {
   int verbose{0};
   /*! \brief Native lib name (without extension) */
   std::string native_lib_name{"predictor"};
+  /*!
+   * \brief Layout of the generated tree code.
+   * \verbatim embed:rst:leading-asterisk
+   * * ``if_else``: Emit every test node as a nested ``if``/``else`` block.
+   * * ``array``: Emit the trees as compact static node arrays, walked by a single small loop.
+   *   This shrinks the generated code and the compilation time by orders of magnitude for
+   *   large models, and may run faster when the ``if_else`` code overflows the instruction
+   *   cache.
+   * * ``quickscorer``: Evaluate the trees with the QuickScorer algorithm. Test nodes of all trees
+   *   are grouped by feature and sorted by threshold; each feature value is compared against the
+   *   sorted thresholds only until the first test succeeds, and the exit leaf of each tree is
+   *   located with bitvector operations. Suited for large ensembles of shallow trees. Trees
+   *   with categorical or equality tests, or more than 256 leaves, fall back to ``if_else``.
+   * \endverbatim
+   */
+  std::string tree_layout{"if_else"};
+  /*!
+   * \brief Whether to generate SIMD kernels (0: no, >0: yes). If enabled, ``predict_batch()``
+   *        evaluates each tree on 8 rows (AVX2) or 16 rows (AVX-512) at once, falling back to
+   *        the scalar code on CPUs without these instruction sets. Requires
+   *        ``tree_layout="array"``. SIMD kernels are only generated for models with ``float32``
+   *        thresholds and leaf outputs, and only if none of the trees uses a categorical or
+   *        equality test and ``quantize`` is disabled.
+   */
+  int simd{0};
+  /*!
+   * \brief Maximum depth of subtrees to evaluate without branches (0: disabled). If set to a
+   *        positive number, the bottom levels of each tree, up to the given depth, are rendered
+   *        as a complete binary tree stored in static arrays and walked by index arithmetic
+   *        instead of ``if``/``else`` blocks, to avoid branch mispredictions. Subtrees with
+   *        categorical or equality tests are left unchanged. Must be at most 8. Requires
+   *        ``tree_layout="if_else"``.
+   */
+  int branchless_depth{0};
+  /*!
+   * \brief Number of trees to walk in lockstep (0 or 1: disabled). If set to 2 or greater, the
+   *        array layout keeps one node cursor for each of that many trees and advances all of
+   *        them in the same loop, so that the CPU can overlap the memory accesses of independent
+   *        trees. Must be at most 16. Requires ``tree_layout="array"``.
+   */
+  int interleave_trees{0};
+  /*!
+   * \brief Whether to compare feature values with thresholds as integers (0: no, >0: yes). If
+   *        enabled, tests against positive ``float32`` thresholds compare the bit patterns of the
+   *        feature value and the threshold as signed 32-bit integers, which gives the same result
+   *        as the floating-point comparison for every non-missing value. Other tests are left
+   *        unchanged. The Predictor treats NaN as missing; code that calls the generated
+   *        ``predict()`` directly must mark NaN as missing too, since a NaN feature value gives
+   *        a different result with integer comparisons. Requires ``tree_layout="if_else"``.
+   */
+  int integer_compare{0};
+  /*!
+   * \brief Whether to render each tree as a separate function (0: no, >0: yes). If enabled, the
+   *        generated library also exports ``get_num_tree()`` and ``predict_range()``, which
+   *        evaluates only the trees in a given range ``[tree_begin, tree_end)``. Requires
+   *        ``tree_layout="if_else"``.
+   */
+  int tree_functions{0};
+  /*!
+   * \brief Whether to deduplicate the model structure (0: no, >0: yes). If enabled, subtrees that
+   *        occur more than once are rendered once as helper functions, and trees that consist of
+   *        a single leaf are folded into the base scores (unless the model averages tree outputs,
+   *        or ``tree_functions`` is set). Requires ``tree_layout="if_else"``.
+   */
+  int dedup_subtrees{0};
+  /*!
+   * \brief Whether to specialize the generated code for rows without missing values (0: no,
+   *        >0: yes). If enabled, every row is first checked for missing values in the features
+   *        that the model uses. Rows with no missing value are predicted by a copy of the trees
+   *        that skips all missing-value checks; other rows take the usual path. Doubles the size
+   *        of the generated code. Requires ``tree_layout="if_else"``.
+   */
+  int missing_fast_path{0};
+  /*!
+   * \brief Whether to evaluate ``exp()`` in the postprocessor with a polynomial approximation
+   *        (0: no, >0: yes). Affects the ``sigmoid``, ``exponential``,
+   *        ``exponential_standard_ratio``, ``logarithm_one_plus_exp``, ``softmax`` and
+   *        ``multiclass_ova`` postprocessors. The approximation has no branch, so that the loops
+   *        of ``postprocess_batch()`` can be vectorized. Its maximum relative error is 1.1e-7
+   *        for ``float32`` models and 2e-16 for ``float64`` models, i.e. about one unit in the
+   *        last place.
+   */
+  int fast_math_postprocess{0};
+  /*!
+   * \brief Storage format of the leaf outputs.
+   * \verbatim embed:rst:leading-asterisk
+   * * ``native``: Store the leaf outputs with the type of the model.
+   * * ``float16``: Round the leaf outputs to IEEE half precision.
+   * * ``bfloat16``: Round the leaf outputs to bfloat16, which keeps the range of ``float32``
+   *   with 8 significant bits.
+   * * ``int16``: Round the leaf outputs to 16-bit integer multiples of a single power of two,
+   *   chosen for the model so that the largest leaf output fits.
+   *
+   * Every leaf output is rounded to the nearest representable value, so that all tree layouts
+   * give the same predictions. Leaf outputs stored in static tables (``tree_layout="array"``,
+   * ``tree_layout="quickscorer"``, ``branchless_depth`` and leaf vectors) take 2 bytes each and
+   * are converted to ``float`` when they are added to the prediction. Use
+   * :py:func:`tl2cgen.compute_leaf_output_deviation` to measure the effect on the predictions.
+   * \endverbatim
+   */
+  std::string leaf_output_precision{"native"};
+  /*!
+   * \brief Whether to store ``float64`` thresholds as ``float32`` where it is exact (0: no, >0:
+   *        yes). If enabled, the threshold table of ``tree_layout="array"`` is stored as
+   *        ``float32`` if every threshold in the table is exactly representable as ``float32``
+   *        and all tests in the table use the same comparison (``<`` or ``<=``). This halves the
+   *        size of the table without changing the outcome of any test. Otherwise the table is
+   *        left unchanged. Has no effect if ``quantize`` is set. Requires
+   *        ``tree_layout="array"``.
+   */
+  int narrow_thresholds{0};
+  /*!
+   * \brief Whether to remove tests whose outcome is decided by the tests above them (0: no, >0:
+   *        yes). A test is removed if every value of the feature that can reach it, including
+   *        the missing value, goes to the same child. Enabled by default; disable it to inspect
+   *        the code generated for the unmodified trees.
+   */
+  int prune_redundant_tests{1};
   /*! \} */
 
   static CompilerParam ParseFromJSON(char const* param_json_str);
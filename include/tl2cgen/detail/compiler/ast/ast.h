@@ -71,6 +71,77 @@ class QuantizerNode : public ASTNode {
   explicit QuantizerNode(ThresholdListVariantT threshold_list)
       : threshold_list_(std::move(threshold_list)) {}
   ThresholdListVariantT threshold_list_;
+  // Width in bits (8 or 16) of the integers in the compact bin[] buffer that holds the quantized
+  // feature values. If 0, the quantized values are instead stored in data[].qvalue.
+  int bin_width_{0};
+  std::string GetDump() const override;
+};
+
+// Holds the trees of a prediction function. The trees are rendered as static node arrays
+// instead of nested if/else blocks.
+class ArrayLayoutNode : public ASTNode {
+ public:
+  explicit ArrayLayoutNode(int layout_id) : layout_id_(layout_id) {}
+  int layout_id_;
+  bool simd_{false};  // Whether to also emit SIMD kernels that evaluate multiple rows at once
+  int num_interleaved_tree_{1};  // Number of trees to walk in lockstep
+  std::string GetDump() const override;
+};
+
+// Holds the trees of a prediction function that are evaluated with the QuickScorer algorithm,
+// i.e. by scanning test nodes in feature-major order and tracking reachable leaves as bitvectors.
+class QuickScorerNode : public ASTNode {
+ public:
+  explicit QuickScorerNode(int layout_id) : layout_id_(layout_id) {}
+  int layout_id_;
+  std::string GetDump() const override;
+};
+
+// Holds a shallow subtree whose tests are all numerical comparisons. The subtree is padded into a
+// complete binary tree of the given depth and evaluated with branch-free index arithmetic.
+class BranchlessSubtreeNode : public ASTNode {
+ public:
+  explicit BranchlessSubtreeNode(int depth) : depth_(depth) {}
+  int depth_;
+  std::string GetDump() const override;
+};
+
+// Holds a rarely visited subtree. The subtree is moved out of the prediction function into a
+// separate function marked as cold, to keep the frequently visited code compact.
+class OutlinedSubtreeNode : public ASTNode {
+ public:
+  explicit OutlinedSubtreeNode(int func_id) : func_id_(func_id) {}
+  int func_id_;
+  std::string GetDump() const override;
+};
+
+// Holds a subtree that occurs more than once in the model. The subtree is rendered once as a
+// helper function, which is called wherever the subtree occurs. Only the first occurrence holds
+// the subtree as its child; the other occurrences have no child and refer to the first one.
+class SharedSubtreeNode : public ASTNode {
+ public:
+  explicit SharedSubtreeNode(int func_id) : func_id_(func_id), definition_(nullptr) {}
+  int func_id_;
+  SharedSubtreeNode const* definition_;  // First occurrence; null for the first occurrence itself
+  std::string GetDump() const override;
+};
+
+// Holds a single tree, given by tree_id_. The tree is rendered as a separate function, so that
+// any range of trees can be evaluated by calling the functions of the trees in the range.
+class TreeFunctionNode : public ASTNode {
+ public:
+  TreeFunctionNode() {}
+  std::string GetDump() const override;
+};
+
+// Holds the trees of the prediction function. The trees are rendered twice: once without any
+// missing-value check, for rows in which none of the features in feature_list_ is missing, and
+// once with the usual checks, for all other rows.
+class MissingFastPathNode : public ASTNode {
+ public:
+  explicit MissingFastPathNode(std::vector<std::uint32_t> feature_list)
+      : feature_list_(std::move(feature_list)) {}
+  std::vector<std::uint32_t> feature_list_;  // Features used by the model, in ascending order
   std::string GetDump() const override;
 };
 
@@ -99,11 +170,13 @@ class NumericalConditionNode : public ConditionNode {
         op_(op),
         threshold_(threshold),
         quantized_threshold_(quantized_threshold),
-        zero_quantized_(-1) {}
+        zero_quantized_(-1),
+        integer_compare_(false) {}
   treelite::Operator op_;
   ThresholdVariantT threshold_;
   std::optional<int> quantized_threshold_;
   int zero_quantized_;  // quantized value of 0.0f (useful when convert_missing_to_zero is set)
+  bool integer_compare_;  // whether to compare the bit patterns of the feature and threshold
   std::string GetDump() const override;
 };
 
@@ -116,6 +189,8 @@ class CategoricalConditionNode : public ConditionNode {
         category_list_right_child_(category_list_right_child) {}
   std::vector<std::uint32_t> category_list_;
   bool category_list_right_child_;
+  std::optional<std::size_t> bitmap_offset_;
+  // Offset of the category bitmap in categorical_bitmap[], if the bitmap is stored there
   std::string GetDump() const override;
 };
 
@@ -139,8 +214,14 @@ class ModelMeta {
   std::int32_t num_feature_;  // Number of features in the training data
   std::vector<bool> is_categorical_;
   // is_categorical_[i]: is feature i categorical?
+  std::vector<std::uint64_t> categorical_bitmap_;
+  // Category bitmaps shared by categorical tests, concatenated
   float sigmoid_alpha_;  // Parameter to control the "sigmoid" postprocessor
   float ratio_c_;  // Parameter to control the "exponential_standard_ratio" postprocessor
+  bool fast_math_postprocess_;  // Whether the postprocessor uses polynomial approximations of exp
+  std::string leaf_output_precision_;  // Storage format of leaf outputs in static tables
+  int leaf_output_scale_exponent_;  // Leaf outputs stored as int16 are multiples of 2^(this)
+  bool narrow_thresholds_;  // Whether to store float64 thresholds as float32 where it is exact
   template <typename ThresholdType, typename LeafOutputType>
   class TypeMeta {
    public:
@@ -8,7 +8,9 @@
 #define TL2CGEN_DETAIL_COMPILER_AST_BUILDER_H_
 
 #include <tl2cgen/detail/compiler/ast/ast.h>
+#include <tl2cgen/logging.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <map>
 #include <memory>
@@ -37,13 +39,52 @@ class ASTBuilder {
   /* \brief Generate is_categorical[] array, which tells whether each feature
             is categorical or numerical */
   void GenerateIsCategoricalArray();
+  /* \brief Collect the category bitmaps spanning multiple words into a deduplicated
+            categorical_bitmap[] array */
+  void GenerateCategoricalBitmapTable();
   /*
    * \brief Split prediction function into multiple translation units
    * \param num_tu Number of translation units
    */
   void SplitIntoTUs(int num_tu);
+  /*
+   * \brief Render the trees in each prediction function as static node arrays, to be
+   *        walked by a loop
+   * \param num_interleaved_tree Number of trees to walk in lockstep
+   */
+  void ConvertToArrayLayout(int num_interleaved_tree);
+  void ConvertToQuickScorer();
+  void EnableSIMDKernels();
+  /*
+   * \brief Evaluate the bottom levels of each tree without branches
+   * \param max_depth Maximum depth of subtrees to convert
+   */
+  void ConvertToBranchlessSubtrees(int max_depth);
+  /* \brief Render each tree as a separate function, to allow prediction with a range of trees */
+  void GenerateTreeFunctions();
+  /* \brief Remove numerical tests whose outcome is decided by the tests above them */
+  void PruneRedundantTests();
+  /* \brief Fold trees consisting of a single leaf into the base scores */
+  void FoldConstantTrees();
+  /* \brief Render subtrees that occur more than once as shared helper functions */
+  void ShareDuplicateSubtrees();
+  /* \brief Render a second copy of the trees without missing-value checks, for dense rows */
+  void GenerateMissingFastPath();
+  /* \brief Move rarely visited subtrees into separate functions, using the data counts */
+  void OutlineColdSubtrees();
   /* \brief Replace split thresholds with integers */
   void QuantizeThresholds();
+  /* \brief Compare feature values with positive float32 thresholds as integers */
+  void EnableIntegerComparisons();
+  /* \brief Evaluate exp() in the postprocessor with polynomial approximations */
+  void EnableFastMathPostprocessor();
+  /*
+   * \brief Round the leaf outputs to the nearest values that can be stored in a given format
+   * \param precision Storage format: "float16", "bfloat16" or "int16"
+   */
+  void ReduceLeafOutputPrecision(std::string const& precision);
+  /* \brief Store float64 thresholds as float32 in static tables, where it is exact */
+  void NarrowThresholds();
   /* \brief Load data counts from annotation file */
   void LoadDataCounts(std::vector<std::vector<std::uint64_t>> const& counts);
   /*
@@ -66,6 +107,25 @@ class ASTBuilder {
     return ref;
   }
 
+  // Insert a new node between an existing node and its parent
+  template <typename NodeType, typename... Args>
+  NodeType* InsertParent(ASTNode* node, Args&&... args) {
+    ASTNode* parent = node->parent_;
+    NodeType* ref = AddNode<NodeType>(parent, std::forward<Args>(args)...);
+    // Keep the annotation: the parent test compares the data counts of its children to put the
+    // more frequent child on the fall-through path, and cold subtrees are found by data count
+    ref->data_count_ = node->data_count_;
+    ref->sum_hess_ = node->sum_hess_;
+    ref->tree_id_ = node->tree_id_;
+    ref->node_id_ = node->node_id_;
+    auto it = std::find(parent->children_.begin(), parent->children_.end(), node);
+    TL2CGEN_CHECK(it != parent->children_.end()) << "Node is not a child of its parent";
+    *it = ref;
+    ref->children_.push_back(node);
+    node->parent_ = ref;
+    return ref;
+  }
+
   template <typename ThresholdType, typename LeafOutputType>
   ASTNode* BuildASTFromTree(ASTNode* parent,
       treelite::Tree<ThresholdType, LeafOutputType> const& tree, int tree_id,
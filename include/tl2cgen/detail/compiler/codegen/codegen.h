@@ -7,6 +7,7 @@
 #ifndef TL2CGEN_DETAIL_COMPILER_CODEGEN_CODEGEN_H_
 #define TL2CGEN_DETAIL_COMPILER_CODEGEN_CODEGEN_H_
 
+#include <cstdint>
 #include <filesystem>
 #include <map>
 #include <ostream>
@@ -35,6 +36,13 @@ class ConditionNode;
 class OutputNode;
 class TranslationUnitNode;
 class QuantizerNode;
+class ArrayLayoutNode;
+class QuickScorerNode;
+class BranchlessSubtreeNode;
+class OutlinedSubtreeNode;
+class TreeFunctionNode;
+class SharedSubtreeNode;
+class MissingFastPathNode;
 class ModelMeta;
 
 }  // namespace tl2cgen::compiler::detail::ast
@@ -55,6 +63,13 @@ void HandleConditionNode(ast::ConditionNode const* node, CodeCollection& gencode
 void HandleOutputNode(ast::OutputNode const* node, CodeCollection& gencode);
 void HandleTranslationUnitNode(ast::TranslationUnitNode const* node, CodeCollection& gencode);
 void HandleQuantizerNode(ast::QuantizerNode const* node, CodeCollection& gencode);
+void HandleArrayLayoutNode(ast::ArrayLayoutNode const* node, CodeCollection& gencode);
+void HandleQuickScorerNode(ast::QuickScorerNode const* node, CodeCollection& gencode);
+void HandleBranchlessSubtreeNode(ast::BranchlessSubtreeNode const* node, CodeCollection& gencode);
+void HandleOutlinedSubtreeNode(ast::OutlinedSubtreeNode const* node, CodeCollection& gencode);
+void HandleTreeFunctionNode(ast::TreeFunctionNode const* node, CodeCollection& gencode);
+void HandleSharedSubtreeNode(ast::SharedSubtreeNode const* node, CodeCollection& gencode);
+void HandleMissingFastPathNode(ast::MissingFastPathNode const* node, CodeCollection& gencode);
 
 std::string GetThresholdTypeStr(ast::ASTNode const* node);
 std::string GetThresholdCType(ast::ASTNode const* node);
@@ -62,6 +77,27 @@ std::string GetLeafOutputTypeStr(ast::ASTNode const* node);
 std::string GetLeafOutputCType(ast::ASTNode const* node);
 std::string GetLeafOutputCType(ast::ModelMeta const& model_meta);
 
+// Parameter list of the helper functions that evaluate some of the trees under a node, and the
+// matching argument list. If the quantized feature values are held in a compact bin[] buffer,
+// the buffer is passed along with data.
+std::string GetTreeFunctionParams(ast::ASTNode const* node);
+std::string GetTreeFunctionArgs(ast::ASTNode const* node);
+
+// Whether a node holds leaves that are rendered in the same function as the node itself, rather
+// than in a separate function
+bool HasInlineOutput(ast::ASTNode const* node);
+// Code to accumulate the outputs of the leaves in a function into a local copy of result[],
+// which is written back at the end. The local copy does not alias data[], so that the C compiler
+// can keep it in registers.
+std::string RenderLocalAccumulatorStart(ast::ASTNode const* node);
+std::string RenderLocalAccumulatorEnd();
+
+// Encode a list of categories as a bitmap of 64-bit words
+std::vector<std::uint64_t> GetCategoricalBitmap(std::vector<std::uint32_t> const& category_list);
+
+// Code to quantize the feature values in data[]. Empty if the model has no threshold to quantize.
+std::string RenderQuantizeLoop(ast::QuantizerNode const* node);
+
 std::string GetPostprocessorFunc(
     ast::ModelMeta const& model_meta, std::string const& postprocessor);
 
@@ -97,10 +133,26 @@ class CodeCollection {
   // sources_["xxx.c"] represents the content of the source file "xxx.c".
   std::string current_file_;
   // The source file that was most recently updated
+  bool assume_no_missing_{false};
+  // Whether the code being generated may assume that no feature value is missing
  public:
   std::string GetCurrentSourceFile() {
     return current_file_;
   }
+  bool HasSourceFile(std::string const& source_name) const {
+    return sources_.count(source_name) > 0;
+  }
+  bool AssumeNoMissing() const {
+    return assume_no_missing_;
+  }
+  void SetAssumeNoMissing(bool assume_no_missing) {
+    assume_no_missing_ = assume_no_missing;
+  }
+  // Suffix for the names of helper functions, so that the helper functions generated for the
+  // fast path do not clash with those generated for the usual path
+  std::string GetFunctionSuffix() const {
+    return assume_no_missing_ ? "_dense" : "";
+  }
   void SwitchToSourceFile(std::string const& source_name);
   void ChangeIndent(int n_tabs_delta);
   void PushFragment(std::string content);
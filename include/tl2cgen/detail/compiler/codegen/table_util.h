@@ -0,0 +1,382 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file table_util.h
+ * \brief Utilities to render trees as static tables, for table-driven code layouts
+ * \author Hyunsu Cho
+ */
+#ifndef TL2CGEN_DETAIL_COMPILER_CODEGEN_TABLE_UTIL_H_
+#define TL2CGEN_DETAIL_COMPILER_CODEGEN_TABLE_UTIL_H_
+
+#include <fmt/format.h>
+#include <tl2cgen/detail/compiler/ast/ast.h>
+#include <tl2cgen/detail/compiler/codegen/format_util.h>
+#include <tl2cgen/detail/compiler/leaf_precision.h>
+#include <tl2cgen/detail/operator_comp.h>
+#include <tl2cgen/logging.h>
+#include <treelite/enum/operator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace tl2cgen::compiler::detail::codegen {
+
+/*!
+ * \brief Render the content of a C array initializer
+ * \param vec Elements of the array
+ * \return Rendered elements, wrapped to 80 characters
+ */
+template <typename T>
+inline std::string RenderArray(std::vector<T> const& vec) {
+  if (vec.empty()) {
+    return "  0";  // C does not allow empty arrays
+  }
+  ArrayFormatter formatter(80, 2);
+  for (auto const& e : vec) {
+    if constexpr (std::is_floating_point_v<T>) {
+      formatter << ToStringHighPrecision(e);
+    } else if constexpr (std::is_same_v<T, std::uint64_t>) {
+      formatter << fmt::format("{}U", e);
+    } else {
+      formatter << e;
+    }
+  }
+  return formatter.str();
+}
+
+/*!
+ * \brief Whether feature values are quantized before the trees under a given node are evaluated
+ * \param node AST node
+ * \return Whether the input is quantized
+ */
+inline bool IsInputQuantized(ast::ASTNode const* node) {
+  for (ast::ASTNode const* p = node->parent_; p; p = p->parent_) {
+    if (auto const* quantizer = dynamic_cast<ast::QuantizerNode const*>(p)) {
+      // HandleQuantizerNode() omits the quantization step if there is no threshold to use
+      return std::visit(
+          [](auto&& threshold_list) {
+            return std::any_of(threshold_list.begin(), threshold_list.end(),
+                [](auto const& e) { return !e.empty(); });
+          },
+          quantizer->threshold_list_);
+    }
+  }
+  return false;
+}
+
+/*!
+ * \brief Width in bits of the integers in the compact bin[] buffer, which holds the quantized
+ *        feature values read by the trees under a given node
+ * \param node AST node
+ * \return 8 or 16. 0 if the input is not quantized, or if the quantized values are held in
+ *         data[].qvalue
+ */
+inline int GetQuantizedBinWidth(ast::ASTNode const* node) {
+  if (!IsInputQuantized(node)) {
+    return 0;
+  }
+  for (ast::ASTNode const* p = node->parent_; p; p = p->parent_) {
+    if (auto const* quantizer = dynamic_cast<ast::QuantizerNode const*>(p)) {
+      return quantizer->bin_width_;
+    }
+  }
+  return 0;
+}
+
+/*!
+ * \brief Numerical test, normalized into the form (feature value < threshold). Missing values
+ *        are sent to the left child if default_left is set.
+ */
+template <typename ThresholdType>
+struct NormalizedNumericalTest {
+  ast::ASTNode const* left_child;
+  ast::ASTNode const* right_child;
+  bool default_left;
+  bool equality_test;  // If set, the test is (feature value == threshold) instead
+  bool inclusive;  // If set, the test is (feature value <= threshold) instead
+  ThresholdType threshold;  // Used if the input is not quantized
+  int quantized_threshold;  // Used if the input is quantized
+  // If not null, the test outcome does not depend on the input, and the test can be replaced
+  // with this node. All other fields are then unused.
+  ast::ASTNode const* bypass;
+};
+
+/*!
+ * \brief Normalize a numerical test into the form (feature value < threshold)
+ *
+ *  * (x > t) and (x >= t) are negations of (x <= t) and (x < t), so the two children are
+ *    swapped.
+ *  * (x <= t) is identical to (x < t'), where t' is the smallest number greater than t. If
+ *    inclusive is set, (x <= t) is kept as is instead, so that the threshold is not altered.
+ *  * If the threshold is infinite, the outcome is identical for all non-missing values. If
+ *    missing values get the same outcome, the test is bypassed. Otherwise, the test is
+ *    replaced with one that sends only missing values to the left.
+ *
+ * \param node Test node
+ * \param quantized Whether the input is quantized
+ * \param inclusive Whether to keep (x <= t) as is. Not allowed if the input is quantized.
+ * \return Normalized test
+ */
+template <typename ThresholdType>
+inline NormalizedNumericalTest<ThresholdType> NormalizeNumericalTest(
+    ast::NumericalConditionNode const* node, bool quantized, bool inclusive = false) {
+  TL2CGEN_CHECK(!(quantized && inclusive));
+  auto const threshold = std::get<ThresholdType>(node->threshold_);
+  NormalizedNumericalTest<ThresholdType> test{node->children_[0], node->children_[1],
+      node->default_left_, false, false, threshold, 0, nullptr};
+  treelite::Operator const op = node->op_;
+
+  if (!node->quantized_threshold_ && std::isinf(threshold)) {
+    bool const outcome
+        = tl2cgen::detail::CompareWithOp(static_cast<ThresholdType>(0), op, threshold);
+    if (outcome == test.default_left) {
+      test.bypass = (outcome ? test.left_child : test.right_child);
+      return test;
+    }
+    // Only missing values go to the other child. No feature value can go under the threshold.
+    if (outcome) {
+      std::swap(test.left_child, test.right_child);
+    }
+    test.default_left = true;
+    test.threshold = -std::numeric_limits<ThresholdType>::infinity();
+    test.quantized_threshold = std::numeric_limits<int>::min();
+    return test;
+  }
+
+  bool const swap_children = (op == treelite::Operator::kGT || op == treelite::Operator::kGE);
+  bool const round_up = (op == treelite::Operator::kLE || op == treelite::Operator::kGT);
+  if (swap_children) {
+    std::swap(test.left_child, test.right_child);
+    test.default_left = !test.default_left;
+  }
+  test.equality_test = (op == treelite::Operator::kEQ);
+  if (quantized) {
+    TL2CGEN_CHECK(node->quantized_threshold_);
+    test.quantized_threshold
+        = round_up ? *node->quantized_threshold_ + 1 : *node->quantized_threshold_;
+  } else if (round_up && inclusive) {
+    test.inclusive = true;
+  } else if (round_up) {
+    test.threshold = std::nextafter(threshold, std::numeric_limits<ThresholdType>::infinity());
+  }
+  return test;
+}
+
+/*!
+ * \brief Render the threshold of a normalized test as a C expression
+ * \param test Normalized test
+ * \param quantized Whether the input is quantized
+ * \return Rendered threshold
+ */
+template <typename ThresholdType>
+inline std::string RenderThreshold(
+    NormalizedNumericalTest<ThresholdType> const& test, bool quantized) {
+  if (quantized) {
+    if (test.quantized_threshold == std::numeric_limits<int>::min()) {
+      return "INT32_MIN";
+    }
+    return std::to_string(test.quantized_threshold);
+  }
+  if (std::isinf(test.threshold)) {
+    return (test.threshold > 0) ? "INFINITY" : "-INFINITY";
+  }
+  return ToStringHighPrecision(test.threshold);
+}
+
+/*!
+ * \brief C type of the elements of a table holding leaf outputs
+ * \param meta Model metadata
+ * \param leaf_output_ctype C type of leaf outputs
+ * \return leaf_output_ctype if the leaf outputs are stored with native precision. Otherwise, the
+ *         16-bit integer type holding the encoded leaf outputs.
+ */
+inline std::string GetLeafStorageCType(
+    ast::ModelMeta const& meta, std::string const& leaf_output_ctype) {
+  if (meta.leaf_output_precision_ == "native") {
+    return leaf_output_ctype;
+  }
+  return (meta.leaf_output_precision_ == "int16") ? "int16_t" : "uint16_t";
+}
+
+/*!
+ * \brief Render the content of a C array initializer holding leaf outputs, encoded in the storage
+ *        format given by GetLeafStorageCType()
+ * \param vec Leaf outputs, already rounded by ReduceLeafOutputPrecision()
+ * \param meta Model metadata
+ * \return Rendered elements
+ */
+template <typename LeafOutputType>
+inline std::string RenderLeafOutputArray(
+    std::vector<LeafOutputType> const& vec, ast::ModelMeta const& meta) {
+  if (meta.leaf_output_precision_ == "native") {
+    return RenderArray(vec);
+  }
+  std::vector<std::int32_t> encoded;
+  encoded.reserve(vec.size());
+  for (LeafOutputType e : vec) {
+    encoded.push_back(EncodeLeafOutput(
+        static_cast<double>(e), meta.leaf_output_precision_, meta.leaf_output_scale_exponent_));
+  }
+  return RenderArray(encoded);
+}
+
+/*!
+ * \brief Render a C expression that reads a leaf output from a table
+ * \param element_expr C expression giving the table element
+ * \param meta Model metadata
+ * \return Rendered expression. If the leaf outputs are stored with reduced precision, the
+ *         expression converts the element back to float.
+ */
+inline std::string RenderLeafOutputDecode(
+    std::string const& element_expr, ast::ModelMeta const& meta) {
+  std::string const& precision = meta.leaf_output_precision_;
+  if (precision == "native") {
+    return element_expr;
+  } else if (precision == "int16") {
+    // Multiplying by a power of two is exact
+    float const scale = std::ldexp(1.0f, meta.leaf_output_scale_exponent_);
+    return fmt::format("(float){} * {}f", element_expr, ToStringHighPrecision(scale));
+  }
+  return fmt::format("decode_{}({})", precision, element_expr);
+}
+
+/*!
+ * \brief Table of leaf outputs for a group of trees. Each leaf occupies leaf_len_ elements of
+ *        leaf_value_; the k-th element is added to result[out_offset_[t] + k * leaf_stride_],
+ *        where t is the tree containing the leaf.
+ */
+template <typename LeafOutputType>
+class LeafOutputTable {
+ public:
+  explicit LeafOutputTable(ast::ModelMeta const& meta)
+      : num_target_(meta.num_target_),
+        num_class_(meta.num_class_),
+        max_num_class_(*std::max_element(meta.num_class_.begin(), meta.num_class_.end())),
+        leaf_len_(meta.leaf_vector_shape_[0] * meta.leaf_vector_shape_[1]),
+        leaf_stride_(1),
+        meta_(meta) {}
+
+  /*! \brief Start a new tree. All subsequent leaves are assigned to the new tree. */
+  void AddTree() {
+    out_offset_.push_back(-1);
+  }
+
+  /*!
+   * \brief Add a leaf to the current tree
+   * \param node Leaf node
+   * \return ID of the leaf. Leaf IDs are assigned sequentially, starting from 0.
+   */
+  std::int32_t AddLeaf(ast::OutputNode const* node) {
+    TL2CGEN_CHECK(!out_offset_.empty()) << "AddTree() must be called first";
+    auto const leaf_id = static_cast<std::int32_t>(leaf_value_.size() / leaf_len_);
+    auto const& leaf_output = std::get<std::vector<LeafOutputType>>(node->leaf_output_);
+    std::int32_t const target_id = node->target_id_;
+    std::int32_t const class_id = node->class_id_;
+    std::int32_t out_offset;
+    if (target_id < 0 && class_id < 0) {
+      // Output to all targets and all classes. Fill zeros into the unused slots.
+      TL2CGEN_CHECK_EQ(leaf_output.size(), leaf_len_);
+      out_offset = 0;
+      for (std::int32_t i = 0; i < num_target_; ++i) {
+        for (std::int32_t j = 0; j < max_num_class_; ++j) {
+          leaf_value_.push_back(
+              (j < num_class_[i]) ? leaf_output[i * max_num_class_ + j] : LeafOutputType(0));
+        }
+      }
+    } else if (target_id < 0) {
+      // Output to all targets and a single class
+      TL2CGEN_CHECK_EQ(leaf_output.size(), leaf_len_);
+      out_offset = class_id;
+      leaf_stride_ = max_num_class_;
+      leaf_value_.insert(leaf_value_.end(), leaf_output.begin(), leaf_output.end());
+    } else if (class_id < 0) {
+      // Output to all classes and a single target. Fill zeros into the unused slots.
+      TL2CGEN_CHECK_EQ(leaf_output.size(), leaf_len_);
+      out_offset = target_id * max_num_class_;
+      for (std::int32_t j = 0; j < max_num_class_; ++j) {
+        leaf_value_.push_back((j < num_class_[target_id]) ? leaf_output[j] : LeafOutputType(0));
+      }
+    } else {
+      TL2CGEN_CHECK_EQ(leaf_output.size(), 1);
+      out_offset = target_id * max_num_class_ + class_id;
+      leaf_value_.push_back(leaf_output[0]);
+    }
+    TL2CGEN_CHECK(out_offset_.back() < 0 || out_offset_.back() == out_offset)
+        << "All leaves in a tree must produce output for the same target and class";
+    out_offset_.back() = out_offset;
+    return leaf_id;
+  }
+
+  /*!
+   * \brief Render the static arrays out_offset[] and leaf_value[]. If all trees output to the
+   *        same slot in result[], out_offset[] is omitted and the slot is hard-coded instead.
+   * \param leaf_output_ctype C type of leaf outputs. If the leaf outputs are stored with reduced
+   *                          precision, leaf_value[] holds 16-bit integers instead.
+   * \return Rendered arrays
+   */
+  std::string RenderArrays(std::string const& leaf_output_ctype) const {
+    std::string out_offset_array;
+    if (!HasUniformOutOffset()) {
+      out_offset_array = fmt::format(
+          "/* out_offset[t]: index of result[] that receives the output of tree t */\n"
+          "static const int32_t out_offset[] = {{\n{}\n}};\n\n",
+          RenderArray(out_offset_));
+    }
+    return fmt::format("{}static const {} leaf_value[] = {{\n{}\n}};\n", out_offset_array,
+        GetLeafStorageCType(meta_, leaf_output_ctype), RenderLeafOutputArray(leaf_value_, meta_));
+  }
+
+  /*!
+   * \brief Render statements to add the output of a leaf into result[]. The generated code
+   *        expects the ID of the current tree to be stored in the variable tree_id.
+   * \param leaf_id_expr C expression giving the leaf ID
+   * \param indent Indentation level
+   * \return Rendered statements
+   */
+  std::string RenderAccumulation(std::string const& leaf_id_expr, int indent) const {
+    std::string const out_offset_expr
+        = HasUniformOutOffset() ? std::to_string(out_offset_.at(0)) : "out_offset[tree_id]";
+    std::string code;
+    if (leaf_len_ == 1) {
+      code = fmt::format("result[{}] += {};", out_offset_expr,
+          RenderLeafOutputDecode(fmt::format("leaf_value[{}]", leaf_id_expr), meta_));
+    } else {
+      code = fmt::format(
+          "for (int k = 0; k < {leaf_len}; ++k) {{\n"
+          "  result[{out_offset} + k * {leaf_stride}] += {leaf_value};\n"
+          "}}",
+          fmt::arg("out_offset", out_offset_expr), fmt::arg("leaf_len", leaf_len_),
+          fmt::arg("leaf_stride", leaf_stride_),
+          fmt::arg("leaf_value",
+              RenderLeafOutputDecode(
+                  fmt::format("leaf_value[{} * {} + k]", leaf_id_expr, leaf_len_), meta_)));
+    }
+    return IndentMultiLineString(code, indent);
+  }
+
+  std::int32_t num_target_;
+  std::vector<std::int32_t> num_class_;
+  std::int32_t max_num_class_;
+  std::int32_t leaf_len_;  // Number of values in each leaf
+  std::int32_t leaf_stride_;  // Distance between result[] slots that receive a leaf's values
+  std::vector<std::int32_t> out_offset_;  // out_offset_[t]: first result[] slot for tree t
+  std::vector<LeafOutputType> leaf_value_;
+  ast::ModelMeta const& meta_;
+
+  /*! \brief Whether all trees output to the same slot in result[] */
+  bool HasUniformOutOffset() const {
+    return !out_offset_.empty()
+           && std::all_of(out_offset_.begin(), out_offset_.end(),
+               [&](std::int32_t e) { return e == out_offset_[0]; });
+  }
+};
+
+}  // namespace tl2cgen::compiler::detail::codegen
+
+#endif  // TL2CGEN_DETAIL_COMPILER_CODEGEN_TABLE_UTIL_H_
@@ -0,0 +1,115 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file leaf_precision.h
+ * \brief Rounding and encoding of leaf outputs stored with reduced precision
+ * \author Hyunsu Cho
+ */
+#ifndef TL2CGEN_DETAIL_COMPILER_LEAF_PRECISION_H_
+#define TL2CGEN_DETAIL_COMPILER_LEAF_PRECISION_H_
+
+#include <tl2cgen/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace tl2cgen::compiler::detail {
+
+/*!
+ * \brief Get the scale of the leaf outputs stored as int16. Each leaf output is stored as an
+ *        integer multiple of 2^e, where e is the smallest exponent for which the largest leaf
+ *        output fits into int16. A power of two is used, so that multiplying by the scale is
+ *        exact.
+ * \param max_abs_leaf_output Largest magnitude of the leaf outputs in the model
+ * \return Exponent e
+ */
+inline int GetInt16LeafScaleExponent(double max_abs_leaf_output) {
+  if (max_abs_leaf_output == 0.0) {
+    return 0;
+  }
+  TL2CGEN_CHECK(std::isfinite(max_abs_leaf_output))
+      << "Leaf outputs must be finite to be stored as int16";
+  int exponent = std::ilogb(max_abs_leaf_output) - 14;
+  if (std::nearbyint(std::ldexp(max_abs_leaf_output, -exponent)) > 32767.0) {
+    ++exponent;
+  }
+  // The scale 2^e must be a normal float32
+  TL2CGEN_CHECK(exponent >= -126 && exponent <= 127)
+      << "Leaf outputs are too small or too large to be stored as int16";
+  return exponent;
+}
+
+/*!
+ * \brief Round a leaf output to the nearest value that can be stored in a given format. Ties are
+ *        rounded to even.
+ * \param value Leaf output
+ * \param precision Storage format: "native", "float16", "bfloat16" or "int16"
+ * \param scale_exponent Exponent of the scale, if the format is "int16"
+ * \return Rounded leaf output
+ */
+inline double RoundLeafOutput(double value, std::string const& precision, int scale_exponent) {
+  if (precision == "native" || value == 0.0) {
+    return value;
+  }
+  TL2CGEN_CHECK(std::isfinite(value))
+      << "Leaf outputs must be finite to be stored as " << precision;
+  double ulp;
+  double max_value;
+  if (precision == "float16") {
+    // 11 significant bits; subnormal below 2^-14
+    ulp = std::ldexp(1.0, std::max(std::ilogb(value), -14) - 10);
+    max_value = 65504.0;
+  } else if (precision == "bfloat16") {
+    // 8 significant bits; subnormal below 2^-126
+    ulp = std::ldexp(1.0, std::max(std::ilogb(value), -126) - 7);
+    max_value = std::ldexp(255.0, 120);
+  } else {
+    TL2CGEN_CHECK_EQ(precision, "int16");
+    ulp = std::ldexp(1.0, scale_exponent);
+    max_value = std::ldexp(32767.0, scale_exponent);
+  }
+  double const rounded = std::nearbyint(value / ulp) * ulp;
+  TL2CGEN_CHECK_LE(std::fabs(rounded), max_value)
+      << "Leaf output " << value << " is out of the range of " << precision;
+  return rounded;
+}
+
+/*!
+ * \brief Encode a leaf output into its 16-bit representation. The leaf output must already be
+ *        rounded with RoundLeafOutput().
+ * \param value Rounded leaf output
+ * \param precision Storage format: "float16", "bfloat16" or "int16"
+ * \param scale_exponent Exponent of the scale, if the format is "int16"
+ * \return Bit pattern (float16, bfloat16) or integer (int16)
+ */
+inline std::int32_t EncodeLeafOutput(
+    double value, std::string const& precision, int scale_exponent) {
+  if (precision == "int16") {
+    return static_cast<std::int32_t>(std::ldexp(value, -scale_exponent));
+  }
+  std::uint32_t bits;
+  if (precision == "bfloat16") {
+    float const f = static_cast<float>(value);
+    std::memcpy(&bits, &f, sizeof(bits));
+    bits >>= 16;
+  } else {
+    TL2CGEN_CHECK_EQ(precision, "float16");
+    std::uint32_t const sign = std::signbit(value) ? 0x8000U : 0U;
+    double const magnitude = std::fabs(value);
+    if (magnitude < std::ldexp(1.0, -14)) {
+      // Subnormal: the mantissa counts multiples of 2^-24
+      bits = sign | static_cast<std::uint32_t>(std::ldexp(magnitude, 24));
+    } else {
+      int const exponent = std::ilogb(magnitude);
+      auto const mantissa = static_cast<std::uint32_t>(std::ldexp(magnitude, 10 - exponent));
+      bits = sign | (static_cast<std::uint32_t>(exponent + 15) << 10) | (mantissa - 1024U);
+    }
+  }
+  return static_cast<std::int32_t>(bits);
+}
+
+}  // namespace tl2cgen::compiler::detail
+
+#endif  // TL2CGEN_DETAIL_COMPILER_LEAF_PRECISION_H_
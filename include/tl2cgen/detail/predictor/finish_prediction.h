@@ -0,0 +1,188 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file finish_prediction.h
+ * \author Hyunsu Cho
+ * \brief Steps that turn the sum of the tree outputs into the prediction, for predictors that do
+ *        not run generated C code
+ */
+#ifndef TL2CGEN_DETAIL_PREDICTOR_FINISH_PREDICTION_H_
+#define TL2CGEN_DETAIL_PREDICTOR_FINISH_PREDICTION_H_
+
+#include <tl2cgen/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tl2cgen::predictor::detail {
+
+/*!
+ * \brief Apply tree averaging, base scores and the postprocessor to the sum of the tree outputs
+ *        for a single row. The steps and the order of floating-point operations are the same as
+ *        at the end of predict() in the generated C code, without fast_math_postprocess.
+ */
+class PredictionFinisher {
+ public:
+  /*!
+   * \param num_class num_class[i]: Number of classes in the i-th target
+   * \param average_factor Divisor for each output[target_id, class_id]; empty if the tree
+   *                       outputs are not averaged
+   * \param base_scores Value to add to each output[target_id, class_id]
+   * \param postprocessor Name of the postprocessor
+   * \param sigmoid_alpha Parameter of the "sigmoid" and "multiclass_ova" postprocessors
+   * \param ratio_c Parameter of the "exponential_standard_ratio" postprocessor
+   */
+  PredictionFinisher(std::vector<std::int32_t> num_class, std::vector<std::int32_t> average_factor,
+      std::vector<double> base_scores, std::string const& postprocessor, float sigmoid_alpha,
+      float ratio_c)
+      : num_class_(std::move(num_class)),
+        average_factor_(std::move(average_factor)),
+        base_scores_(std::move(base_scores)),
+        sigmoid_alpha_(sigmoid_alpha),
+        ratio_c_(ratio_c) {
+    TL2CGEN_CHECK(!num_class_.empty());
+    num_target_ = static_cast<std::int32_t>(num_class_.size());
+    max_num_class_ = *std::max_element(num_class_.begin(), num_class_.end());
+    std::size_t const num_slot = static_cast<std::size_t>(num_target_) * max_num_class_;
+    TL2CGEN_CHECK(average_factor_.empty() || average_factor_.size() == num_slot);
+    TL2CGEN_CHECK_EQ(base_scores_.size(), num_slot);
+    if (postprocessor == "identity") {
+      postprocessor_ = Postprocessor::kIdentity;
+    } else if (postprocessor == "signed_square") {
+      postprocessor_ = Postprocessor::kSignedSquare;
+    } else if (postprocessor == "hinge") {
+      postprocessor_ = Postprocessor::kHinge;
+    } else if (postprocessor == "sigmoid") {
+      TL2CGEN_CHECK_GT(sigmoid_alpha, 0.0f) << "sigmoid: alpha must be strictly positive";
+      postprocessor_ = Postprocessor::kSigmoid;
+    } else if (postprocessor == "exponential") {
+      postprocessor_ = Postprocessor::kExponential;
+    } else if (postprocessor == "exponential_standard_ratio") {
+      postprocessor_ = Postprocessor::kExponentialStandardRatio;
+    } else if (postprocessor == "logarithm_one_plus_exp") {
+      postprocessor_ = Postprocessor::kLogarithmOnePlusExp;
+    } else if (postprocessor == "softmax") {
+      postprocessor_ = Postprocessor::kSoftmax;
+    } else if (postprocessor == "multiclass_ova") {
+      TL2CGEN_CHECK_GT(sigmoid_alpha, 0.0f) << "multiclass_ova: alpha must be strictly positive";
+      postprocessor_ = Postprocessor::kMulticlassOva;
+    } else {
+      TL2CGEN_LOG(FATAL) << "Unknown postprocessor: " << postprocessor;
+    }
+  }
+
+  /*!
+   * \brief Finish the prediction for a single row
+   * \param pred_margin Whether to skip the postprocessor
+   * \param result Sum of the tree outputs, of length num_target * max(num_class)
+   */
+  template <typename LeafOutputType>
+  void Apply(int pred_margin, LeafOutputType* result) const {
+    for (std::int32_t target_id = 0; target_id < num_target_; ++target_id) {
+      for (std::int32_t class_id = 0; class_id < num_class_[target_id]; ++class_id) {
+        std::int32_t const offset = target_id * max_num_class_ + class_id;
+        if (!average_factor_.empty()) {
+          result[offset] /= static_cast<LeafOutputType>(average_factor_[offset]);
+        }
+        result[offset] = static_cast<LeafOutputType>(result[offset] + base_scores_[offset]);
+      }
+    }
+    if (!pred_margin) {
+      Postprocess(result);
+    }
+  }
+
+ private:
+  enum class Postprocessor : std::int8_t {
+    kIdentity,
+    kSignedSquare,
+    kHinge,
+    kSigmoid,
+    kExponential,
+    kExponentialStandardRatio,
+    kLogarithmOnePlusExp,
+    kSoftmax,
+    kMulticlassOva
+  };
+
+  template <typename LeafOutputType>
+  void Postprocess(LeafOutputType* result) const {
+    using T = LeafOutputType;
+    std::int32_t const num_slot = num_target_ * max_num_class_;
+    switch (postprocessor_) {
+    case Postprocessor::kIdentity:
+      break;
+    case Postprocessor::kSignedSquare:
+      for (std::int32_t i = 0; i < num_slot; ++i) {
+        T const margin = result[i];
+        result[i] = std::copysign(margin * margin, margin);
+      }
+      break;
+    case Postprocessor::kHinge:
+      for (std::int32_t i = 0; i < num_slot; ++i) {
+        result[i] = (result[i] > 0) ? T(1) : T(0);
+      }
+      break;
+    case Postprocessor::kSigmoid:
+      for (std::int32_t i = 0; i < num_slot; ++i) {
+        result[i] = T(1) / (T(1) + std::exp(-static_cast<T>(sigmoid_alpha_) * result[i]));
+      }
+      break;
+    case Postprocessor::kExponential:
+      for (std::int32_t i = 0; i < num_slot; ++i) {
+        result[i] = std::exp(result[i]);
+      }
+      break;
+    case Postprocessor::kExponentialStandardRatio:
+      for (std::int32_t i = 0; i < num_slot; ++i) {
+        result[i] = std::exp2(-result[i] / static_cast<T>(ratio_c_));
+      }
+      break;
+    case Postprocessor::kLogarithmOnePlusExp:
+      for (std::int32_t i = 0; i < num_slot; ++i) {
+        result[i] = std::log1p(std::exp(result[i]));
+      }
+      break;
+    case Postprocessor::kSoftmax:
+      for (std::int32_t target_id = 0; target_id < num_target_; ++target_id) {
+        T* target_result = &result[target_id * max_num_class_];
+        std::int32_t const num_class = num_class_[target_id];
+        T const max_margin = *std::max_element(target_result, target_result + num_class);
+        double norm_const = 0.0;
+        for (std::int32_t k = 0; k < num_class; ++k) {
+          target_result[k] = std::exp(target_result[k] - max_margin);
+          norm_const += target_result[k];
+        }
+        for (std::int32_t k = 0; k < num_class; ++k) {
+          target_result[k] /= static_cast<T>(norm_const);
+        }
+      }
+      break;
+    case Postprocessor::kMulticlassOva:
+      for (std::int32_t target_id = 0; target_id < num_target_; ++target_id) {
+        T* target_result = &result[target_id * max_num_class_];
+        for (std::int32_t k = 0; k < num_class_[target_id]; ++k) {
+          target_result[k]
+              = T(1) / (T(1) + std::exp(-static_cast<T>(sigmoid_alpha_) * target_result[k]));
+        }
+      }
+      break;
+    }
+  }
+
+  std::int32_t num_target_;
+  std::vector<std::int32_t> num_class_;
+  std::int32_t max_num_class_;
+  std::vector<std::int32_t> average_factor_;
+  std::vector<double> base_scores_;
+  Postprocessor postprocessor_;
+  float sigmoid_alpha_;
+  float ratio_c_;
+};
+
+}  // namespace tl2cgen::predictor::detail
+
+#endif  // TL2CGEN_DETAIL_PREDICTOR_FINISH_PREDICTION_H_
@@ -0,0 +1,124 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file interpreter.h
+ * \author Hyunsu Cho
+ * \brief Evaluate a tree model directly, without generating and compiling C code
+ */
+#ifndef TL2CGEN_DETAIL_PREDICTOR_INTERPRETER_H_
+#define TL2CGEN_DETAIL_PREDICTOR_INTERPRETER_H_
+
+#include <tl2cgen/detail/predictor/finish_prediction.h>
+#include <tl2cgen/predictor.h>
+#include <treelite/enum/operator.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace treelite {
+
+class Model;
+
+}  // namespace treelite
+
+namespace tl2cgen::predictor::detail {
+
+/*!
+ * \brief Copy of a tree model, with the nodes of all trees stored in flat arrays (structure of
+ *        arrays). The nodes of each tree are laid out in pre-order, so that the left child
+ *        follows its parent. Node IDs are indices into the arrays.
+ */
+template <typename ThresholdType, typename LeafOutputType>
+class InterpreterPreset {
+ public:
+  using threshold_type = ThresholdType;
+  using leaf_output_type = LeafOutputType;
+
+  explicit InterpreterPreset(PredictionFinisher finisher) : finisher_(std::move(finisher)) {}
+
+  /*!
+   * \brief Make prediction for a single row. Same as predict() in the generated C code: the
+   *        tree outputs are added to result, which must be initialized with zeros.
+   * \param data Feature values of the row
+   * \param pred_margin Whether to skip the postprocessor
+   * \param result Output buffer of length num_target * max(num_class)
+   */
+  void Predict(Entry<ThresholdType> const* data, int pred_margin, LeafOutputType* result) const;
+
+  /*! \brief tree_root_[i]: ID of the root node of the i-th tree */
+  std::vector<std::int32_t> tree_root_;
+  /*!
+   * \brief Output slots that receive the leaf outputs of the i-th tree are given by
+   *        output_slot_[output_slot_begin_[i]:output_slot_begin_[i+1]]
+   */
+  std::vector<std::int32_t> output_slot_begin_;
+  std::vector<std::int32_t> output_slot_;
+
+  /* Nodes. A leaf node has left_child_ set to -1. */
+  std::vector<std::int32_t> left_child_;
+  std::vector<std::int32_t> right_child_;
+  std::vector<std::int32_t> default_child_;
+  std::vector<std::uint32_t> split_index_;
+  std::vector<ThresholdType> threshold_;
+  std::vector<treelite::Operator> op_;
+  /*! \brief Index of the category list for a categorical test; -1 for a numerical test */
+  std::vector<std::int32_t> category_test_;
+  /*! \brief Offset into leaf_output_ for a leaf node */
+  std::vector<std::int32_t> leaf_output_begin_;
+
+  /*!
+   * \brief Categories of the j-th categorical test are given by
+   *        category_list_[category_list_begin_[j]:category_list_begin_[j+1]], in ascending order
+   */
+  std::vector<std::int32_t> category_list_begin_;
+  std::vector<std::uint32_t> category_list_;
+  std::vector<std::uint8_t> category_list_right_child_;
+
+  /*! \brief Leaf outputs, one per output slot of the tree */
+  std::vector<LeafOutputType> leaf_output_;
+
+  PredictionFinisher finisher_;
+};
+
+/** Variant definitions **/
+using InterpreterVariant
+    = std::variant<InterpreterPreset<float, float>, InterpreterPreset<double, double>>;
+
+/*!
+ * \brief Engine that predicts by walking the trees of a model, with no code generation or
+ *        compilation. Use it when a model has to serve right after it is trained, or as a
+ *        baseline for the compiled prediction function.
+ */
+class Interpreter {
+ public:
+  /*!
+   * \brief Copy the trees of a model into flat arrays
+   * \param model Model to evaluate. The interpreter keeps no reference to it.
+   */
+  explicit Interpreter(treelite::Model const& model);
+
+  std::int32_t GetNumFeature() const {
+    return num_feature_;
+  }
+  std::int32_t GetNumTarget() const {
+    return num_target_;
+  }
+  std::vector<std::int32_t> GetNumClass() const {
+    return num_class_;
+  }
+  /*! \brief Type of the split thresholds and the leaf outputs, e.g. "float32" */
+  std::string GetThresholdType() const;
+
+  InterpreterVariant variant_;
+
+ private:
+  std::int32_t num_feature_;
+  std::int32_t num_target_;
+  std::vector<std::int32_t> num_class_;
+};
+
+}  // namespace tl2cgen::predictor::detail
+
+#endif  // TL2CGEN_DETAIL_PREDICTOR_INTERPRETER_H_
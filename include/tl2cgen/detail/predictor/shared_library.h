@@ -13,7 +13,10 @@
 
 namespace tl2cgen::predictor::detail {
 
-/*! \brief Abstraction for a shared library */
+/*!
+ * \brief Abstraction for a shared library. Subclasses may provide the functions from other
+ *        sources, e.g. from machine code compiled in memory.
+ */
 class SharedLibrary {
  public:
   using LibraryHandle = void*;
@@ -23,9 +26,11 @@ class SharedLibrary {
 
   /*! \brief Load a shared library from a given path */
   explicit SharedLibrary(char const* libpath);
-  ~SharedLibrary();
+  virtual ~SharedLibrary();
   /*! \brief Load a function with a given name */
-  FunctionHandle LoadFunction(char const* name) const;
+  virtual FunctionHandle LoadFunction(char const* name) const;
+  /*! \brief Check whether the library contains a function with a given name */
+  virtual bool HasFunction(char const* name) const;
   /*! \brief Same as LoadFunction(), but with additional check to ensure that the loaded
    *         function can be represented as a given type of function pointer. */
   template <typename FuncPtrT>
@@ -37,9 +42,9 @@ class SharedLibrary {
     return func_handle;
   }
 
- private:
+ protected:
   LibraryHandle handle_;
-  std::string libpath_;
+  std::string libpath_;  // Path of the library, used in error messages
 };
 
 }  // namespace tl2cgen::predictor::detail
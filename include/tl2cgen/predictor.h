@@ -27,6 +27,9 @@ namespace tl2cgen::predictor {
 namespace detail {
 
 class SharedLibrary;
+class Interpreter;
+template <typename ThresholdType, typename LeafOutputType>
+class InterpreterPreset;
 
 /*!
  * \brief Data layout. The value -1 signifies the missing value.
@@ -41,7 +44,8 @@ union Entry {
 };
 
 /*!
- * \brief Container for the prediction function, with handle to the native library.
+ * \brief Container for the prediction function, with handle to the native library or to the
+ *        interpreter.
  *        This class has template parameters to indicate the type of thresholds and leaf outputs
  *        in the tree model. For most uses, use the type-erased version, PredictFunction, so that
  *        you don't need to specify the template parameters.
@@ -52,19 +56,77 @@ class PredictFunctionPreset {
   using threshold_type = ThresholdType;
   using leaf_output_type = LeafOutputType;
 
-  PredictFunctionPreset() : handle_(nullptr), num_feature_(0), num_target_(1), max_num_class_(1) {}
+  PredictFunctionPreset()
+      : handle_(nullptr),
+        batch_handle_(nullptr),
+        range_handle_(nullptr),
+        decision_handle_(nullptr),
+        interpreter_(nullptr),
+        num_feature_(0),
+        num_target_(1),
+        max_num_class_(1) {}
   PredictFunctionPreset(SharedLibrary const& shared_lib, int num_feature, std::int32_t num_target,
       std::int32_t max_num_class)
-      : num_feature_(num_feature), num_target_(num_target), max_num_class_(max_num_class) {
+      : batch_handle_(nullptr),
+        range_handle_(nullptr),
+        decision_handle_(nullptr),
+        interpreter_(nullptr),
+        num_feature_(num_feature),
+        num_target_(num_target),
+        max_num_class_(max_num_class) {
     handle_ = shared_lib.LoadFunction("predict");
+    // Libraries generated by older versions of TL2cgen do not have predict_batch()
+    if (shared_lib.HasFunction("predict_batch")) {
+      batch_handle_ = shared_lib.LoadFunction("predict_batch");
+    }
+    // predict_range() is only generated with the compiler parameter tree_functions
+    if (shared_lib.HasFunction("predict_range")) {
+      range_handle_ = shared_lib.LoadFunction("predict_range");
+    }
+    // predict_decision() is only generated for some models with tree_functions
+    if (shared_lib.HasFunction("predict_decision")) {
+      decision_handle_ = shared_lib.LoadFunction("predict_decision");
+    }
   }
+  PredictFunctionPreset(InterpreterPreset<ThresholdType, LeafOutputType> const& interpreter,
+      int num_feature, std::int32_t num_target, std::int32_t max_num_class)
+      : handle_(nullptr),
+        batch_handle_(nullptr),
+        range_handle_(nullptr),
+        decision_handle_(nullptr),
+        interpreter_(&interpreter),
+        num_feature_(num_feature),
+        num_target_(num_target),
+        max_num_class_(max_num_class) {}
 
   void PredictBatch(DMatrix const* dmat, std::uint64_t rbegin, std::uint64_t rend, bool pred_margin,
       LeafOutputType* out_pred) const;
+  void PredictBatch(DMatrix const* dmat, std::uint64_t rbegin, std::uint64_t rend, bool pred_margin,
+      std::int32_t tree_begin, std::int32_t tree_end, LeafOutputType* out_pred) const;
+  void PredictDecision(DMatrix const* dmat, std::uint64_t rbegin, std::uint64_t rend,
+      double threshold, LeafOutputType* out_pred) const;
+  void PredictTopK(DMatrix const* dmat, std::uint64_t rbegin, std::uint64_t rend,
+      std::vector<std::int32_t> const& num_class, std::int32_t k, std::int32_t* out_index,
+      LeafOutputType* out_score) const;
 
  private:
+  /*!
+   * \brief Make prediction for a slice [rbegin:rend] in the data matrix. Unlike PredictBatch(),
+   *        the output for row rbegin is stored at the beginning of out_rows.
+   */
+  void PredictRows(DMatrix const* dmat, std::uint64_t rbegin, std::uint64_t rend,
+      bool pred_margin, LeafOutputType* out_rows) const;
+
   /*! \brief Pointer to the underlying native function */
   SharedLibrary::FunctionHandle handle_;
+  /*! \brief Pointer to the native function that loops over dense rows. May be null. */
+  SharedLibrary::FunctionHandle batch_handle_;
+  /*! \brief Pointer to the native function that evaluates a range of trees. May be null. */
+  SharedLibrary::FunctionHandle range_handle_;
+  /*! \brief Pointer to the native function that decides against a threshold. May be null. */
+  SharedLibrary::FunctionHandle decision_handle_;
+  /*! \brief Interpreter to run instead of the native functions. May be null. */
+  InterpreterPreset<ThresholdType, LeafOutputType> const* interpreter_;
   std::int32_t num_feature_;
   std::int32_t num_target_;
   std::int32_t max_num_class_;
@@ -112,6 +174,8 @@ class PredictFunction {
     variant_ = detail::SetPredictFunctionVariant<0>(
         target_variant_index, shared_lib, num_feature, num_target, max_num_class);
   }
+  PredictFunction(detail::Interpreter const& interpreter, std::int32_t num_feature,
+      std::int32_t num_target, std::int32_t max_num_class);
 
   /*!
    * \brief Make prediction for a slice [rbegin:rend] in the data matrix
@@ -134,6 +198,75 @@ class PredictFunction {
         variant_);
   }
 
+  /*!
+   * \brief Make prediction for a slice [rbegin:rend] in the data matrix, using only the trees in
+   *        the range [tree_begin, tree_end)
+   * \param dmat Data matrix
+   * \param rbegin Beginning of the slice
+   * \param rend End of the slice
+   * \param pred_margin Whether to produce raw margin scores instead of
+   *                    transformed probabilities
+   * \param tree_begin Beginning of the range of trees
+   * \param tree_end End of the range of trees
+   * \param out_pred Output buffer to store prediction result
+   */
+  void PredictBatch(DMatrix const* dmat, std::uint64_t rbegin, std::uint64_t rend, bool pred_margin,
+      std::int32_t tree_begin, std::int32_t tree_end, void* out_pred) const {
+    std::visit(
+        [&](auto&& pred_func_concrete) {
+          using LeafOutputType =
+              typename std::remove_reference_t<decltype(pred_func_concrete)>::leaf_output_type;
+          pred_func_concrete.PredictBatch(dmat, rbegin, rend, pred_margin, tree_begin, tree_end,
+              static_cast<LeafOutputType*>(out_pred));
+        },
+        variant_);
+  }
+
+  /*!
+   * \brief Decide for a slice [rbegin:rend] in the data matrix whether the margin score is
+   *        greater than a threshold
+   * \param dmat Data matrix
+   * \param rbegin Beginning of the slice
+   * \param rend End of the slice
+   * \param threshold Threshold for the margin score
+   * \param out_pred Output buffer to store the decisions (1 or 0)
+   */
+  void PredictDecision(DMatrix const* dmat, std::uint64_t rbegin, std::uint64_t rend,
+      double threshold, void* out_pred) const {
+    std::visit(
+        [&](auto&& pred_func_concrete) {
+          using LeafOutputType =
+              typename std::remove_reference_t<decltype(pred_func_concrete)>::leaf_output_type;
+          pred_func_concrete.PredictDecision(
+              dmat, rbegin, rend, threshold, static_cast<LeafOutputType*>(out_pred));
+        },
+        variant_);
+  }
+
+  /*!
+   * \brief Find the k classes with the highest margin scores, for each row in a slice
+   *        [rbegin:rend] in the data matrix
+   * \param dmat Data matrix
+   * \param rbegin Beginning of the slice
+   * \param rend End of the slice
+   * \param num_class Number of classes per output target
+   * \param k Number of classes to select per output target
+   * \param out_index Output buffer to store the class IDs
+   * \param out_score Output buffer to store the margin scores of the selected classes
+   */
+  void PredictTopK(DMatrix const* dmat, std::uint64_t rbegin, std::uint64_t rend,
+      std::vector<std::int32_t> const& num_class, std::int32_t k, std::int32_t* out_index,
+      void* out_score) const {
+    std::visit(
+        [&](auto&& pred_func_concrete) {
+          using LeafOutputType =
+              typename std::remove_reference_t<decltype(pred_func_concrete)>::leaf_output_type;
+          pred_func_concrete.PredictTopK(dmat, rbegin, rend, num_class, k, out_index,
+              static_cast<LeafOutputType*>(out_score));
+        },
+        variant_);
+  }
+
   detail::PredictFunctionVariant variant_;
 };
 
@@ -148,7 +281,20 @@ class Predictor {
    * \param libpath path of dynamic shared library (.so/.dll/.dylib).
    */
   explicit Predictor(char const* libpath, int num_worker_thread = -1);
-  ~Predictor() = default;
+  /*!
+   * \brief Use the prediction function from a library that has already been loaded, e.g. one
+   *        compiled in memory with \ref tl2cgen::compiler::CompileModelJIT.
+   * \param lib Library providing the same functions as the generated shared library
+   */
+  explicit Predictor(std::unique_ptr<detail::SharedLibrary> lib, int num_worker_thread = -1);
+  /*!
+   * \brief Predict by walking the trees of a model directly, with no code generation or
+   *        compilation. Prediction with a range of trees and PredictDecision() are not
+   *        supported.
+   * \param interpreter Interpreter holding a copy of the model
+   */
+  explicit Predictor(std::unique_ptr<detail::Interpreter> interpreter, int num_worker_thread = -1);
+  ~Predictor();
 
   /*!
    * \brief Make predictions on a batch of data rows (synchronously). This
@@ -163,6 +309,55 @@ class Predictor {
    *                   respectively.
    */
   void PredictBatch(DMatrix const* dmat, int verbose, bool pred_margin, void* out_result) const;
+  /*!
+   * \brief Make predictions on a batch of data rows (synchronously), using only the trees in the
+   *        range [tree_begin, tree_end). The shared library must be generated with the compiler
+   *        parameter ``tree_functions``.
+   * \param dmat A batch of rows
+   * \param verbose Whether to produce extra messages
+   * \param pred_margin Whether to produce raw margin scores instead of
+   *                    transformed probabilities
+   * \param tree_begin Beginning of the range of trees
+   * \param tree_end End of the range of trees. Must be at most \ref GetNumTree.
+   * \param out_result Output buffer to store prediction result, with the same shape as in the
+   *                   other overload.
+   */
+  void PredictBatch(DMatrix const* dmat, int verbose, bool pred_margin, std::int32_t tree_begin,
+      std::int32_t tree_end, void* out_result) const;
+  /*!
+   * \brief For each data row, decide whether the margin score (the prediction with
+   *        pred_margin=true) is greater than a threshold. Trees are evaluated only until the
+   *        decision is certain. The shared library must be generated with the compiler parameter
+   *        ``tree_functions``, and the model must have a single output and must not average
+   *        the tree outputs.
+   * \param dmat A batch of rows
+   * \param verbose Whether to produce extra messages
+   * \param threshold Threshold for the margin score
+   * \param out_result Output buffer to store the decisions (1 or 0), with the same shape and
+   *                   type as the prediction result.
+   */
+  void PredictDecision(
+      DMatrix const* dmat, int verbose, double threshold, void* out_result) const;
+  /*!
+   * \brief For each data row, find the k classes with the highest margin scores
+   *        (synchronously). The classes are ranked by their margin scores, and no postprocessor
+   *        is evaluated. For most postprocessors (e.g. softmax), this is the same ranking as that
+   *        of the transformed outputs; a decreasing postprocessor such as
+   *        exponential_standard_ratio reverses it.
+   * \param dmat A batch of rows
+   * \param verbose Whether to produce extra messages
+   * \param k Number of classes to select per output target. Must be between 1 and
+   *          max(num_class). Use k=1 to get the argmax.
+   * \param out_index Output buffer of shape (num_row, num_target, k), to store the class IDs in
+   *                  descending order of margin score. Ties are broken in favor of the lower
+   *                  class ID, and classes with a NaN score come last. For targets with fewer
+   *                  than k classes, the excess entries are set to -1.
+   * \param out_score Output buffer of shape (num_row, num_target, k) and of type
+   *                  leaf_output_type, to store the margin scores of the selected classes. The
+   *                  excess entries are set to NaN.
+   */
+  void PredictTopK(DMatrix const* dmat, int verbose, std::int32_t k, std::int32_t* out_index,
+      void* out_score) const;
   /*!
    * \brief Given a batch of data rows, query the necessary shape of array to
    *        hold predictions for all data points.
@@ -230,13 +425,27 @@ class Predictor {
     return num_class_;
   }
 
+  /*!
+   * \brief Get the number of trees that can be selected with a range of trees
+   * \return Number of trees, or -1 if the shared library does not support prediction with a
+   *         range of trees
+   */
+  std::int32_t GetNumTree() const {
+    return num_tree_;
+  }
+
  private:
+  template <typename PredictSliceFunc>
+  void PredictBatchImpl(DMatrix const* dmat, int verbose, PredictSliceFunc predict_slice) const;
+
   std::unique_ptr<detail::SharedLibrary> lib_;
+  std::unique_ptr<detail::Interpreter> interpreter_;
   std::unique_ptr<PredictFunction> pred_func_;
   std::int32_t num_feature_;
   std::int32_t num_target_;
   std::vector<std::int32_t> num_class_;
   std::int32_t max_num_class_;
+  std::int32_t num_tree_;
   std::string threshold_type_;
   std::string leaf_output_type_;
   tl2cgen::detail::threading_utils::ThreadConfig thread_config_;
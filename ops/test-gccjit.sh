@@ -0,0 +1,21 @@
+#!/bin/bash
+
+set -euo pipefail
+
+GCC_MAJOR_VERSION=$(gcc -dumpversion | cut -d. -f1)
+
+echo "##[section]Installing libgccjit and Ninja..."
+sudo apt-get update
+sudo apt-get install ninja-build libgccjit-${GCC_MAJOR_VERSION}-dev
+
+echo "##[section]Building TL2cgen with libgccjit..."
+mkdir build/
+cd build/
+cmake .. -DUSE_GCCJIT=ON -DCMAKE_C_COMPILER=gcc -DCMAKE_CXX_COMPILER=g++ -GNinja
+ninja
+cd ..
+
+echo "##[section]Running Python integration tests for the JIT backend..."
+export PYTHONPATH='./python'
+export TL2CGEN_REQUIRE_GCCJIT=1
+python -m pytest -v -rxXs --fulltrace --durations=0 tests/python/test_basic.py -k "jit_compile"
@@ -3,7 +3,15 @@
 TL2cgen (TreeLite 2 C GENerator):
 Model compiler for decision tree ensembles
 """
-from .core import _dump_compiler_ast, _py_version, annotate_branch, generate_c_code
+from .core import (
+    _dump_compiler_ast,
+    _py_version,
+    annotate_branch,
+    compute_leaf_output_deviation,
+    generate_c_code,
+    interpret,
+    jit_compile,
+)
 from .create_shared import create_shared
 from .data import DMatrix
 from .exception import TL2cgenError
@@ -15,12 +23,15 @@ __version__ = _py_version()
 
 __all__ = [
     "annotate_branch",
+    "compute_leaf_output_deviation",
     "create_shared",
     "export_lib",
     "export_srcpkg",
     "generate_c_code",
     "generate_cmakelists",
     "generate_makefile",
+    "interpret",
+    "jit_compile",
     "_dump_compiler_ast",
     "DMatrix",
     "Predictor",
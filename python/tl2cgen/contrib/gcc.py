@@ -3,8 +3,13 @@ Tools to interact with toolchains GCC, Clang, and other UNIX compilers
 """
 
 import pathlib
+import re
+import shutil
+import subprocess
+from sys import platform as _platform
 from typing import Any, Dict, List
 
+from ..exception import TL2cgenError
 from .create_shared import _create_shared_base
 from .util import _libext
 
@@ -68,3 +73,57 @@ def _create_shared_gcc(
     recipe["create_library_cmd"] = _lib_cmd_wrapped
     recipe["initial_cmd"] = ""
     return _create_shared_base(dirpath, recipe, nthread=nthread, verbose=verbose)
+
+
+def _is_clang(toolchain: str) -> bool:
+    out = subprocess.run(
+        [toolchain, "--version"],
+        stdin=subprocess.DEVNULL,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.STDOUT,
+        check=False,
+    ).stdout.decode("utf-8", errors="replace")
+    return "clang" in out
+
+
+def _pgo_generate_options(toolchain: str, profile_dir: pathlib.Path) -> List[str]:
+    """Options to build a library that records an execution profile into profile_dir"""
+    if _is_clang(toolchain):
+        return [f"-fprofile-generate={profile_dir}"]
+    # Counters are not updated atomically, so the profiling run must be single-threaded
+    return [f"-fprofile-generate={profile_dir}", "-fprofile-update=single"]
+
+
+def _find_llvm_profdata(toolchain: str) -> List[str]:
+    # Use the version of llvm-profdata that matches the Clang toolchain (e.g. clang-15)
+    version_suffix = re.sub(r"^.*clang", "", pathlib.Path(toolchain).name)
+    for candidate in [f"llvm-profdata{version_suffix}", "llvm-profdata"]:
+        if shutil.which(candidate):
+            return [candidate]
+    if _platform == "darwin" and shutil.which("xcrun"):
+        return ["xcrun", "llvm-profdata"]
+    raise TL2cgenError(
+        "Profile-guided optimization with Clang requires llvm-profdata. "
+        "Ensure that it is installed and available in PATH."
+    )
+
+
+def _pgo_use_options(
+    toolchain: str, profile_dir: pathlib.Path, *, verbose: bool
+) -> List[str]:
+    """Options to build a library optimized with the profile recorded in profile_dir"""
+    if _is_clang(toolchain):
+        # Clang writes raw profiles, which must be merged into a single file first
+        profdata = profile_dir / "default.profdata"
+        raw_profiles = [str(e) for e in profile_dir.glob("*.profraw")]
+        if not raw_profiles:
+            raise TL2cgenError(f"No profile was recorded in {profile_dir}")
+        subprocess.run(
+            _find_llvm_profdata(toolchain)
+            + ["merge", f"-output={profdata}"]
+            + raw_profiles,
+            stdout=(None if verbose else subprocess.DEVNULL),
+            check=True,
+        )
+        return [f"-fprofile-use={profdata}"]
+    return [f"-fprofile-use={profile_dir}", "-Wno-missing-profile"]
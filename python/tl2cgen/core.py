@@ -10,6 +10,7 @@ import treelite
 from .data import DMatrix
 from .handle_class import _Annotator, _TreeliteModel
 from .libloader import _LIB, _check_call
+from .predictor import Predictor
 from .util import c_str
 
 
@@ -145,3 +146,162 @@ def annotate_branch(
     nthread = nthread if nthread is not None else 0
     annotator = _Annotator(_model, dmat, nthread, verbose)
     annotator.save(path)
+
+
+def jit_compile(
+    model: treelite.Model,
+    params: Optional[Dict[str, Any]] = None,
+    *,
+    nthread: Optional[int] = None,
+    verbose: bool = False,
+) -> Predictor:
+    """
+    Compile a tree ensemble model into machine code in memory and return a
+    :py:class:`Predictor`. Unlike :py:meth:`export_lib`, no file is written and no
+    external compiler is run. Requires TL2cgen to be built with the CMake option
+    ``USE_GCCJIT``, which uses libgccjit.
+
+    Parameters
+    ----------
+    model :
+        Model to compile
+    params :
+        Parameters for compiler. See :py:doc:`this page </compiler_param>`
+        for the list of compiler parameters. Only the parameters that change the
+        predictions (e.g. ``leaf_output_precision``) apply; the parameters that choose
+        the layout of the C code are ignored.
+    nthread :
+        Number of worker threads to use for prediction; if unspecified, use maximum
+        number of hardware threads
+    verbose :
+        Whether to print extra messages during compilation
+
+    Returns
+    -------
+    predictor :
+        Predictor that runs the compiled model. Prediction with ``tree_range`` is not
+        supported.
+
+    Example
+    -------
+
+    .. code-block:: python
+
+       predictor = tl2cgen.jit_compile(model, params={})
+       out_pred = predictor.predict(tl2cgen.DMatrix(X))
+    """
+    _model = _TreeliteModel(model)
+    if params is None:
+        params = {}
+    if verbose:
+        params["verbose"] = 1
+    params_json_str = json.dumps(params)
+    nthread = nthread if nthread is not None else -1
+    handle = ctypes.c_void_p()
+    _check_call(
+        _LIB.TL2cgenPredictorLoadJIT(
+            _model.handle,
+            c_str(params_json_str),
+            ctypes.c_int(nthread),
+            ctypes.byref(handle),
+        )
+    )
+    return Predictor._from_handle(handle)  # pylint: disable=protected-access
+
+
+def interpret(
+    model: treelite.Model,
+    *,
+    nthread: Optional[int] = None,
+) -> Predictor:
+    """
+    Return a :py:class:`Predictor` that walks the trees of a model directly, without
+    generating or compiling any code. The predictor is ready within a fraction of a second,
+    so it can serve a model right after it is trained, e.g. for canary deployments. It is
+    also a baseline for the speed of the compiled predictor.
+
+    Parameters
+    ----------
+    model :
+        Model to evaluate. The predictor holds a copy of the model.
+    nthread :
+        Number of worker threads to use for prediction; if unspecified, use maximum
+        number of hardware threads
+
+    Returns
+    -------
+    predictor :
+        Predictor that evaluates the model. Prediction with ``tree_range`` and
+        :py:meth:`Predictor.predict_decision` are not supported.
+
+    Example
+    -------
+
+    .. code-block:: python
+
+       predictor = tl2cgen.interpret(model)
+       out_pred = predictor.predict(tl2cgen.DMatrix(X))
+    """
+    _model = _TreeliteModel(model)
+    nthread = nthread if nthread is not None else -1
+    handle = ctypes.c_void_p()
+    _check_call(
+        _LIB.TL2cgenPredictorLoadInterpreter(
+            _model.handle,
+            ctypes.c_int(nthread),
+            ctypes.byref(handle),
+        )
+    )
+    return Predictor._from_handle(handle)  # pylint: disable=protected-access
+
+
+def compute_leaf_output_deviation(
+    model: treelite.Model,
+    dmat: DMatrix,
+    params: Optional[Dict[str, Any]],
+    *,
+    nthread: Optional[int] = None,
+) -> float:
+    """
+    Compute the largest change in the margin scores caused by storing the leaf outputs with
+    reduced precision (compiler parameter ``leaf_output_precision``), over the rows of a
+    validation data. Use it to decide whether the reduced precision is acceptable, before
+    generating the code.
+
+    Parameters
+    ----------
+    model :
+        Model to convert to C code
+    dmat :
+        Data matrix representing the validation data
+    params :
+        Parameters for compiler. See :py:doc:`this page </compiler_param>`
+        for the list of compiler parameters.
+    nthread :
+        Number of threads to use. If missing, use all physical cores in the system.
+
+    Returns
+    -------
+    deviation :
+        Largest absolute difference between the margin scores computed with the rounded leaf
+        outputs and those computed with the original leaf outputs. 0 if
+        ``leaf_output_precision`` is ``"native"``.
+    """
+    _model = _TreeliteModel(model)
+    if params is None:
+        params = {}
+    if isinstance(params.get("annotate_in"), pathlib.Path):
+        params["annotate_in"] = str(params["annotate_in"])
+    params_json_str = json.dumps(params)
+    nthread = nthread if nthread is not None else 0
+    out = ctypes.c_double()
+    _check_call(
+        _LIB.TL2cgenComputeLeafOutputDeviation(
+            _model.handle,
+            c_str(params_json_str),
+            dmat.handle,
+            ctypes.c_int(nthread),
+            ctypes.byref(out),
+        )
+    )
+    return out.value
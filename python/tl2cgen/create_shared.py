@@ -1,15 +1,18 @@
 """Launcher for C compiler to build shared libs"""
 
 import pathlib
+import shutil
 import time
 import warnings
 from multiprocessing import cpu_count
 from typing import List, Optional, Union
 
-from .contrib.gcc import _create_shared_gcc
+from .contrib.gcc import _create_shared_gcc, _pgo_generate_options, _pgo_use_options
 from .contrib.msvc import _create_shared_msvc
 from .contrib.util import _toolchain_exist_check
+from .data import DMatrix
 from .exception import TL2cgenError
+from .predictor import Predictor
 from .util import _open_and_validate_recipe, _process_options
 
 
@@ -21,6 +24,7 @@ def create_shared(
     verbose: bool = False,
     options: Optional[List[str]] = None,
     long_build_time_warning: bool = True,
+    profile_data: Optional[DMatrix] = None,
 ):  # pylint: disable=R0914,too-many-arguments
     """Create shared library.
 
@@ -42,6 +46,12 @@ def create_shared(
         Additional options to pass to toolchain
     long_build_time_warning :
         If set to False, suppress the warning about potentially long build time
+    profile_data :
+        If given, build the library with profile-guided optimization (PGO). The library is
+        first built with instrumentation and used to predict ``profile_data``, and then rebuilt
+        using the recorded execution profile. ``profile_data`` should be representative of the
+        data that the library will be used with in production. Only supported for GCC and
+        Clang; Clang additionally requires ``llvm-profdata``.
 
     Returns
     -------
@@ -103,6 +113,29 @@ def create_shared(
         _create_shared = _create_shared_msvc
     else:
         _create_shared = _create_shared_gcc
+    if profile_data is not None:
+        if toolchain == "msvc":
+            raise TL2cgenError(
+                "Profile-guided optimization is only supported for GCC and Clang"
+            )
+        profile_dir = dirpath / "pgo_profile"
+        if profile_dir.exists():
+            shutil.rmtree(profile_dir)
+        profile_dir.mkdir()
+        libpath = _create_shared(
+            dirpath,
+            toolchain,
+            recipe,
+            nthread=nthread,
+            options=options + _pgo_generate_options(toolchain, profile_dir),
+            verbose=verbose,
+        )
+        # Run the instrumented library single-threaded, as the profile counters are not
+        # thread-safe. The profile is written to disk when the library is unloaded.
+        predictor = Predictor(libpath, nthread=1, verbose=verbose)
+        predictor.predict(profile_data)
+        del predictor
+        options = options + _pgo_use_options(toolchain, profile_dir, verbose=verbose)
     libpath = _create_shared(
         dirpath, toolchain, recipe, nthread=nthread, options=options, verbose=verbose
     )
@@ -4,7 +4,7 @@ Predictor module
 
 import ctypes
 import pathlib
-from typing import Optional, Union
+from typing import Optional, Tuple, Union
 
 import numpy as np
 
@@ -78,6 +78,14 @@ class Predictor:
                 "loaded into memory"
             )
 
+    @classmethod
+    def _from_handle(cls, handle: ctypes.c_void_p) -> "Predictor":
+        """Wrap a predictor handle that has already been created"""
+        predictor = cls.__new__(cls)
+        predictor.handle = handle
+        predictor._load_metadata(handle)  # pylint: disable=protected-access
+        return predictor
+
     def __del__(self):
         if self.handle:
             _check_call(_LIB.TL2cgenPredictorFree(self.handle))
@@ -98,6 +106,12 @@ class Predictor:
         """Query number of class for each output target"""
         return self.num_class_
 
+    @property
+    def num_tree(self):
+        """Query number of trees that can be selected with ``tree_range``. None if the library
+        was generated without the compiler parameter ``tree_functions``."""
+        return self.num_tree_
+
     @property
     def threshold_type(self):
         """Query threshold type of the model"""
@@ -114,6 +128,7 @@ class Predictor:
         *,
         verbose: bool = False,
         pred_margin: bool = False,
+        tree_range: Optional[Tuple[int, int]] = None,
     ):
         """
         Perform batch prediction with a 2D sparse data matrix. Worker threads will
@@ -128,7 +143,124 @@ class Predictor:
             Whether to print extra messages during prediction
         pred_margin:
             Whether to produce raw margins rather than transformed probabilities
+        tree_range:
+            If given as ``(tree_begin, tree_end)``, only use the trees in the range
+            ``[tree_begin, tree_end)``. Requires the library to be generated with the
+            compiler parameter ``tree_functions``.
+        """
+        output_array, output_array_cptr_type = self._alloc_output(dmat)
+        if tree_range is None:
+            _check_call(
+                _LIB.TL2cgenPredictorPredictBatch(
+                    self.handle,
+                    dmat.handle,
+                    ctypes.c_int(1 if verbose else 0),
+                    ctypes.c_int(1 if pred_margin else 0),
+                    output_array.ctypes.data_as(output_array_cptr_type),
+                )
+            )
+        else:
+            tree_begin, tree_end = tree_range
+            _check_call(
+                _LIB.TL2cgenPredictorPredictBatchWithTreeRange(
+                    self.handle,
+                    dmat.handle,
+                    ctypes.c_int(1 if verbose else 0),
+                    ctypes.c_int(1 if pred_margin else 0),
+                    ctypes.c_int32(tree_begin),
+                    ctypes.c_int32(tree_end),
+                    output_array.ctypes.data_as(output_array_cptr_type),
+                )
+            )
+        return output_array
+
+    def predict_decision(
+        self, dmat: DMatrix, threshold: float, *, verbose: bool = False
+    ):
+        """
+        For each row, decide whether the margin score (the output of
+        ``predict(dmat, pred_margin=True)``) is greater than ``threshold``. Trees are
+        evaluated only until the decision is certain. Requires the library to be
+        generated with the compiler parameter ``tree_functions``, from a model with a
+        single output that does not average tree outputs.
+
+        Parameters
+        ----------
+        dmat:
+            Batch of rows for which decisions will be made
+        threshold:
+            Threshold for the margin score
+        verbose :
+            Whether to print extra messages during prediction
+
+        Returns
+        -------
+        Array with 1 for rows whose margin score is greater than ``threshold`` and 0
+        otherwise, with the same shape as the output of :py:meth:`predict`.
+        """
+        output_array, output_array_cptr_type = self._alloc_output(dmat)
+        _check_call(
+            _LIB.TL2cgenPredictorPredictDecision(
+                self.handle,
+                dmat.handle,
+                ctypes.c_int(1 if verbose else 0),
+                ctypes.c_double(threshold),
+                output_array.ctypes.data_as(output_array_cptr_type),
+            )
+        )
+        return output_array
+
+    def predict_topk(self, dmat: DMatrix, k: int = 1, *, verbose: bool = False):
         """
+        For each row, find the ``k`` classes with the highest margin scores. The
+        postprocessor (e.g. softmax) is not evaluated. For most postprocessors, the
+        classes are the same as the top ``k`` classes in the output of
+        :py:meth:`predict`. A decreasing postprocessor, such as
+        ``exponential_standard_ratio``, ranks the classes in the opposite order.
+
+        Parameters
+        ----------
+        dmat:
+            Batch of rows for which predictions will be made
+        k:
+            Number of classes to select for each output target. Set ``k=1`` to get the
+            argmax.
+        verbose :
+            Whether to print extra messages during prediction
+
+        Returns
+        -------
+        Tuple ``(index, score)`` of arrays with shape ``(num_row, num_target, k)``.
+        ``index`` holds the class IDs in descending order of margin score, with ties
+        broken in favor of the lower class ID and NaN scores placed last, as with
+        ``numpy.argsort`` of the negated scores. ``score`` holds the margin scores of
+        the selected classes. For targets with fewer than ``k`` classes, the excess
+        entries are set to -1 in ``index`` and NaN in ``score``.
+        """
+        # Replace the class axis of the usual output shape with k
+        output_shape = tuple(self._get_output_shape(dmat)[:-1]) + (k,)
+        output_array_dtype, output_array_cptr_type = self._get_output_type()
+        index_array = np.zeros(shape=output_shape, dtype=np.int32, order="C")
+        score_array = np.zeros(shape=output_shape, dtype=output_array_dtype, order="C")
+        _check_call(
+            _LIB.TL2cgenPredictorPredictTopK(
+                self.handle,
+                dmat.handle,
+                ctypes.c_int(1 if verbose else 0),
+                ctypes.c_int32(k),
+                index_array.ctypes.data_as(ctypes.POINTER(ctypes.c_int32)),
+                score_array.ctypes.data_as(output_array_cptr_type),
+            )
+        )
+        return index_array, score_array
+
+    def _alloc_output(self, dmat: DMatrix):
+        output_shape = self._get_output_shape(dmat)
+        output_array_dtype, output_array_cptr_type = self._get_output_type()
+        output_array = np.zeros(shape=output_shape, dtype=output_array_dtype, order="C")
+        return output_array, output_array_cptr_type
+
+    def _get_output_shape(self, dmat: DMatrix):
         if not isinstance(dmat, DMatrix):
             raise TL2cgenError("dmat must be of type DMatrix")
         out_shape = ctypes.POINTER(ctypes.c_uint64)()
@@ -141,9 +273,11 @@ class Predictor:
                 ctypes.byref(out_ndim),
             )
         )
-        output_shape = np.copy(
+        return np.copy(
             np.ctypeslib.as_array(out_shape, shape=(out_ndim.value,)), order="C"
         )
+
+    def _get_output_type(self):
         if self.leaf_output_type == "float32":
             output_array_dtype = np.float32
             output_array_cptr_type = ctypes.POINTER(ctypes.c_float)
@@ -152,18 +286,7 @@ class Predictor:
             output_array_cptr_type = ctypes.POINTER(ctypes.c_double)  # type: ignore
         else:
             raise TL2cgenError(f"Unknown leaf_output_type {self.leaf_output_type}")
-
-        output_array = np.zeros(shape=output_shape, dtype=output_array_dtype, order="C")
-        _check_call(
-            _LIB.TL2cgenPredictorPredictBatch(
-                self.handle,
-                dmat.handle,
-                ctypes.c_int(1 if verbose else 0),
-                ctypes.c_int(1 if pred_margin else 0),
-                output_array.ctypes.data_as(output_array_cptr_type),
-            )
-        )
-        return output_array
+        return output_array_dtype, output_array_cptr_type
 
     def _load_metadata(self, handle: ctypes.c_void_p) -> None:
         num_feature = ctypes.c_int32()
@@ -184,6 +307,10 @@ class Predictor:
         )
         self.num_class_ = num_class
 
+        num_tree = ctypes.c_int32()
+        _check_call(_LIB.TL2cgenPredictorGetNumTree(handle, ctypes.byref(num_tree)))
+        self.num_tree_ = num_tree.value if num_tree.value >= 0 else None
+
         threshold_type = ctypes.c_char_p()
         _check_call(
             _LIB.TL2cgenPredictorGetThresholdType(handle, ctypes.byref(threshold_type))
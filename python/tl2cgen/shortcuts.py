@@ -10,6 +10,7 @@ import treelite
 from .contrib.util import _toolchain_exist_check
 from .core import generate_c_code
 from .create_shared import create_shared
+from .data import DMatrix
 from .generate_makefile import generate_cmakelists, generate_makefile
 
 
@@ -22,6 +23,7 @@ def export_lib(
     nthread: Optional[int] = None,
     verbose: bool = False,
     options: Optional[List[str]] = None,
+    profile_data: Optional[DMatrix] = None,
 ):  # pylint: disable=too-many-arguments
     """
     Convenience function: Generate prediction code and immediately turn it
@@ -48,6 +50,9 @@ def export_lib(
         Whether to produce extra messages
     options :
         Additional options to pass to toolchain
+    profile_data :
+        If given, build the library with profile-guided optimization, using
+        ``profile_data`` as representative input. See :py:meth:`create_shared`.
 
     Example
     -------
@@ -83,6 +88,7 @@ def export_lib(
             verbose=verbose,
             options=options,
             long_build_time_warning=long_build_time_warning,
+            profile_data=profile_data,
         )
         if libpath.is_file():
             libpath.unlink()
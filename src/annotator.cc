@@ -139,7 +139,9 @@ class ComputeBranchLooper<CSRDMatrix<ElementType>> {
           const std::uint64_t ibegin = dmat.row_ptr_[rid];
           const std::uint64_t iend = dmat.row_ptr_[rid + 1];
           for (std::uint64_t i = ibegin; i < iend; ++i) {
-            inst[off + dmat.col_ind_[i]].fvalue = dmat.data_[i];
+            if (!tl2cgen::detail::math::CheckNAN(dmat.data_[i])) {
+              inst[off + dmat.col_ind_[i]].fvalue = dmat.data_[i];
+            }
           }
           for (std::uint64_t tree_id = 0; tree_id < ntree; ++tree_id) {
             Traverse(model_preset.trees[tree_id], &inst[off],
@@ -12,6 +12,7 @@
 #include <tl2cgen/compiler_param.h>
 #include <tl2cgen/data_matrix.h>
 #include <tl2cgen/detail/filesystem.h>
+#include <tl2cgen/detail/predictor/interpreter.h>
 #include <tl2cgen/logging.h>
 #include <tl2cgen/predictor.h>
 #include <tl2cgen/predictor_types.h>
@@ -110,6 +111,19 @@ TL2CGEN_DLL int TL2cgenDumpAST(
   API_END();
 }
 
+int TL2cgenComputeLeafOutputDeviation(TL2cgenModelHandle model,
+    char const* compiler_params_json_str, TL2cgenDMatrixHandle dmat, int nthread,
+    double* out_deviation) {
+  API_BEGIN();
+  treelite::Model const* model_ = static_cast<treelite::Model*>(model);
+  TL2CGEN_CHECK(model_);
+  auto const* dmat_ = static_cast<DMatrix const*>(dmat);
+  TL2CGEN_CHECK(dmat_) << "Found a dangling reference to DMatrix";
+  auto param = compiler::CompilerParam::ParseFromJSON(compiler_params_json_str);
+  *out_deviation = compiler::ComputeLeafOutputDeviation(*model_, param, dmat_, nthread);
+  API_END();
+}
+
 int TL2cgenDMatrixCreateFromCSR(void const* data, char const* data_type_str,
     std::uint32_t const* col_ind, std::uint64_t const* row_ptr, std::uint64_t num_row,
     std::uint64_t num_col, TL2cgenDMatrixHandle* out) {
@@ -153,6 +167,29 @@ int TL2cgenPredictorLoad(
   API_END();
 }
 
+int TL2cgenPredictorLoadJIT(TL2cgenModelHandle model, char const* compiler_params_json_str,
+    int num_worker_thread, TL2cgenPredictorHandle* out) {
+  API_BEGIN();
+  treelite::Model const* model_ = static_cast<treelite::Model*>(model);
+  TL2CGEN_CHECK(model_);
+  auto param = compiler::CompilerParam::ParseFromJSON(compiler_params_json_str);
+  auto predictor = std::make_unique<predictor::Predictor>(
+      compiler::CompileModelJIT(*model_, param), num_worker_thread);
+  *out = static_cast<TL2cgenPredictorHandle>(predictor.release());
+  API_END();
+}
+
+int TL2cgenPredictorLoadInterpreter(
+    TL2cgenModelHandle model, int num_worker_thread, TL2cgenPredictorHandle* out) {
+  API_BEGIN();
+  treelite::Model const* model_ = static_cast<treelite::Model*>(model);
+  TL2CGEN_CHECK(model_);
+  auto predictor = std::make_unique<predictor::Predictor>(
+      std::make_unique<predictor::detail::Interpreter>(*model_), num_worker_thread);
+  *out = static_cast<TL2cgenPredictorHandle>(predictor.release());
+  API_END();
+}
+
 int TL2cgenPredictorPredictBatch(TL2cgenPredictorHandle predictor, TL2cgenDMatrixHandle dmat,
     int verbose, int pred_margin, void* out_result) {
   API_BEGIN();
@@ -168,6 +205,53 @@ int TL2cgenPredictorPredictBatch(TL2cgenPredictorHandle predictor, TL2cgenDMatri
   API_END();
 }
 
+int TL2cgenPredictorPredictBatchWithTreeRange(TL2cgenPredictorHandle predictor,
+    TL2cgenDMatrixHandle dmat, int verbose, int pred_margin, int32_t tree_begin,
+    int32_t tree_end, void* out_result) {
+  API_BEGIN();
+  auto const* predictor_ = static_cast<predictor::Predictor const*>(predictor);
+  auto const* dmat_ = static_cast<DMatrix const*>(dmat);
+  std::size_t const num_feature = predictor_->GetNumFeature();
+  std::string const err_msg = std::string(
+                                  "Too many columns (features) in the data matrix. "
+                                  "Number of features must not exceed ")
+                              + std::to_string(num_feature);
+  TL2CGEN_CHECK_LE(dmat_->GetNumCol(), num_feature) << err_msg;
+  predictor_->PredictBatch(
+      dmat_, verbose, (pred_margin != 0), tree_begin, tree_end, out_result);
+  API_END();
+}
+
+int TL2cgenPredictorPredictDecision(TL2cgenPredictorHandle predictor, TL2cgenDMatrixHandle dmat,
+    int verbose, double threshold, void* out_result) {
+  API_BEGIN();
+  auto const* predictor_ = static_cast<predictor::Predictor const*>(predictor);
+  auto const* dmat_ = static_cast<DMatrix const*>(dmat);
+  std::size_t const num_feature = predictor_->GetNumFeature();
+  std::string const err_msg = std::string(
+                                  "Too many columns (features) in the data matrix. "
+                                  "Number of features must not exceed ")
+                              + std::to_string(num_feature);
+  TL2CGEN_CHECK_LE(dmat_->GetNumCol(), num_feature) << err_msg;
+  predictor_->PredictDecision(dmat_, verbose, threshold, out_result);
+  API_END();
+}
+
+int TL2cgenPredictorPredictTopK(TL2cgenPredictorHandle predictor, TL2cgenDMatrixHandle dmat,
+    int verbose, int32_t k, int32_t* out_index, void* out_score) {
+  API_BEGIN();
+  auto const* predictor_ = static_cast<predictor::Predictor const*>(predictor);
+  auto const* dmat_ = static_cast<DMatrix const*>(dmat);
+  std::size_t const num_feature = predictor_->GetNumFeature();
+  std::string const err_msg = std::string(
+                                  "Too many columns (features) in the data matrix. "
+                                  "Number of features must not exceed ")
+                              + std::to_string(num_feature);
+  TL2CGEN_CHECK_LE(dmat_->GetNumCol(), num_feature) << err_msg;
+  predictor_->PredictTopK(dmat_, verbose, k, out_index, out_score);
+  API_END();
+}
+
 int TL2cgenPredictorGetOutputShape(TL2cgenPredictorHandle predictor, TL2cgenDMatrixHandle dmat,
     std::uint64_t const** out_shape, std::uint64_t* out_ndim) {
   API_BEGIN();
@@ -220,6 +304,13 @@ int TL2cgenPredictorGetNumClass(TL2cgenPredictorHandle predictor, int32_t* out)
   API_END();
 }
 
+int TL2cgenPredictorGetNumTree(TL2cgenPredictorHandle predictor, int32_t* out) {
+  API_BEGIN();
+  auto const* predictor_ = static_cast<predictor::Predictor const*>(predictor);
+  *out = predictor_->GetNumTree();
+  API_END();
+}
+
 int TL2cgenPredictorFree(TL2cgenPredictorHandle predictor) {
   API_BEGIN();
   delete static_cast<predictor::Predictor*>(predictor);
@@ -0,0 +1,167 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file array_layout.cc
+ * \brief AST manipulation logic to render trees as static tables
+ * \author Hyunsu Cho
+ */
+#include <tl2cgen/detail/compiler/ast/builder.h>
+#include <tl2cgen/logging.h>
+#include <treelite/enum/operator.h>
+
+#include <cstddef>
+#include <variant>
+#include <vector>
+
+namespace {
+
+namespace ast = tl2cgen::compiler::detail::ast;
+
+// Maximum number of leaves in a tree evaluated by QuickScorer. The reachable leaves of each tree
+// are tracked with a bitvector of (at most 4) 64-bit words.
+constexpr std::size_t kQuickScorerMaxNumLeaf = 256;
+// Maximum number of trees in a single QuickScorerNode. Larger groups are split into blocks, so
+// that the bitvectors of a block stay small enough to be kept in the stack and in the L1 cache.
+constexpr std::size_t kQuickScorerBlockSize = 1024;
+
+bool IsTreeHead(ast::ASTNode* node) {
+  return dynamic_cast<ast::ConditionNode*>(node) || dynamic_cast<ast::OutputNode*>(node);
+}
+
+// Find all function nodes whose children are tree heads
+void FindTreeFunctions(ast::ASTNode* node, std::vector<ast::FunctionNode*>& func_list) {
+  TL2CGEN_CHECK(!dynamic_cast<ast::ArrayLayoutNode*>(node)
+                && !dynamic_cast<ast::QuickScorerNode*>(node))
+      << "Trees should not be converted to a table layout twice";
+  auto* func = dynamic_cast<ast::FunctionNode*>(node);
+  if (func && !func->children_.empty() && IsTreeHead(func->children_[0])) {
+    func_list.push_back(func);
+    return;
+  }
+  for (ast::ASTNode* child : node->children_) {
+    FindTreeFunctions(child, func_list);
+  }
+}
+
+// Count leaves in a tree. Returns false if the tree contains a test not supported by QuickScorer.
+bool CountLeavesForQuickScorer(ast::ASTNode* node, std::size_t& num_leaf) {
+  if (dynamic_cast<ast::OutputNode*>(node)) {
+    ++num_leaf;
+    return true;
+  }
+  auto* cond = dynamic_cast<ast::NumericalConditionNode*>(node);
+  if (!cond || cond->op_ == treelite::Operator::kEQ) {
+    return false;
+  }
+  return CountLeavesForQuickScorer(cond->children_[0], num_leaf)
+         && CountLeavesForQuickScorer(cond->children_[1], num_leaf);
+}
+
+bool IsQuickScorerEligible(ast::ASTNode* tree_head) {
+  std::size_t num_leaf = 0;
+  return CountLeavesForQuickScorer(tree_head, num_leaf) && num_leaf <= kQuickScorerMaxNumLeaf;
+}
+
+// Find all array layouts
+void FindArrayLayouts(ast::ASTNode* node, std::vector<ast::ArrayLayoutNode*>& layout_list) {
+  if (auto* layout = dynamic_cast<ast::ArrayLayoutNode*>(node)) {
+    layout_list.push_back(layout);
+    return;
+  }
+  for (ast::ASTNode* child : node->children_) {
+    FindArrayLayouts(child, layout_list);
+  }
+}
+
+// SIMD kernels compare raw feature values against thresholds, so they support neither
+// quantized thresholds nor categorical and equality tests.
+bool IsSIMDEligible(ast::ASTNode* node) {
+  if (dynamic_cast<ast::CategoricalConditionNode*>(node)) {
+    return false;
+  }
+  if (auto* num_cond = dynamic_cast<ast::NumericalConditionNode*>(node)) {
+    if (num_cond->op_ == treelite::Operator::kEQ || num_cond->quantized_threshold_) {
+      return false;
+    }
+  }
+  for (ast::ASTNode* child : node->children_) {
+    if (!IsSIMDEligible(child)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // anonymous namespace
+
+namespace tl2cgen::compiler::detail::ast {
+
+void ASTBuilder::ConvertToArrayLayout(int num_interleaved_tree) {
+  TL2CGEN_CHECK_GE(num_interleaved_tree, 1);
+  std::vector<FunctionNode*> func_list;
+  FindTreeFunctions(main_node_, func_list);
+  int layout_id = 0;
+  for (FunctionNode* func : func_list) {
+    ArrayLayoutNode* layout = AddNode<ArrayLayoutNode>(func, layout_id++);
+    layout->num_interleaved_tree_ = num_interleaved_tree;
+    for (ASTNode* tree_head : func->children_) {
+      TL2CGEN_CHECK(IsTreeHead(tree_head));
+      tree_head->parent_ = layout;
+      layout->children_.push_back(tree_head);
+    }
+    func->children_ = {layout};
+  }
+}
+
+void ASTBuilder::ConvertToQuickScorer() {
+  std::vector<FunctionNode*> func_list;
+  FindTreeFunctions(main_node_, func_list);
+  int layout_id = 0;
+  for (FunctionNode* func : func_list) {
+    std::vector<ASTNode*> eligible_trees, other_trees;
+    for (ASTNode* tree_head : func->children_) {
+      TL2CGEN_CHECK(IsTreeHead(tree_head));
+      if (IsQuickScorerEligible(tree_head)) {
+        eligible_trees.push_back(tree_head);
+      } else {
+        other_trees.push_back(tree_head);
+      }
+    }
+    if (eligible_trees.empty()) {
+      continue;
+    }
+    // Trees not supported by QuickScorer are kept as they are and rendered as if/else blocks.
+    func->children_.clear();
+    QuickScorerNode* layout = nullptr;
+    for (ASTNode* tree_head : eligible_trees) {
+      if (!layout || layout->children_.size() == kQuickScorerBlockSize) {
+        layout = AddNode<QuickScorerNode>(func, layout_id++);
+        func->children_.push_back(layout);
+      }
+      tree_head->parent_ = layout;
+      layout->children_.push_back(tree_head);
+    }
+    func->children_.insert(func->children_.end(), other_trees.begin(), other_trees.end());
+  }
+}
+
+void ASTBuilder::EnableSIMDKernels() {
+  std::vector<ArrayLayoutNode*> layout_list;
+  FindArrayLayouts(main_node_, layout_list);
+  TL2CGEN_CHECK(!layout_list.empty()) << "SIMD kernels require the array layout";
+  // SIMD kernels are only available for float32 models, since they read float32 feature values
+  // directly from the input matrix.
+  bool eligible = std::holds_alternative<ModelMeta::TypeMeta<float, float>>(meta_.type_meta_);
+  for (ArrayLayoutNode* layout : layout_list) {
+    eligible = eligible && IsSIMDEligible(layout);
+  }
+  if (!eligible) {
+    TL2CGEN_LOG(INFO) << "SIMD kernels disabled: they require float32 thresholds and leaf "
+                      << "outputs, no quantization, and no categorical or equality test";
+    return;
+  }
+  for (ArrayLayoutNode* layout : layout_list) {
+    layout->simd_ = true;
+  }
+}
+
+}  // namespace tl2cgen::compiler::detail::ast
@@ -0,0 +1,60 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file branchless.cc
+ * \brief AST manipulation logic to evaluate the bottom levels of trees without branches
+ * \author Hyunsu Cho
+ */
+#include <tl2cgen/detail/compiler/ast/builder.h>
+#include <tl2cgen/logging.h>
+#include <treelite/enum/operator.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace {
+
+namespace ast = tl2cgen::compiler::detail::ast;
+
+// Find the largest subtrees with at most max_depth levels of tests, in which every test is a
+// numerical comparison. Returns the number of test levels in the subtree rooted at node, or -1 if
+// the subtree is not eligible for branchless evaluation.
+int FindBranchlessSubtrees(ast::ASTNode* node, int max_depth,
+    std::vector<std::pair<ast::ASTNode*, int>>& subtree_list) {
+  if (dynamic_cast<ast::OutputNode*>(node)) {
+    return 0;
+  }
+  std::vector<int> child_depth;
+  for (ast::ASTNode* child : node->children_) {
+    child_depth.push_back(FindBranchlessSubtrees(child, max_depth, subtree_list));
+  }
+  auto* cond = dynamic_cast<ast::NumericalConditionNode*>(node);
+  if (cond && cond->op_ != treelite::Operator::kEQ && child_depth[0] >= 0 && child_depth[1] >= 0
+      && std::max(child_depth[0], child_depth[1]) < max_depth) {
+    return std::max(child_depth[0], child_depth[1]) + 1;
+  }
+  // The node itself cannot be converted, so convert each eligible child instead. Leaves are
+  // left as they are, since they contain no branch.
+  for (std::size_t i = 0; i < node->children_.size(); ++i) {
+    if (child_depth[i] > 0) {
+      subtree_list.emplace_back(node->children_[i], child_depth[i]);
+    }
+  }
+  return -1;
+}
+
+}  // anonymous namespace
+
+namespace tl2cgen::compiler::detail::ast {
+
+void ASTBuilder::ConvertToBranchlessSubtrees(int max_depth) {
+  TL2CGEN_CHECK_GT(max_depth, 0);
+  std::vector<std::pair<ASTNode*, int>> subtree_list;
+  FindBranchlessSubtrees(main_node_, max_depth, subtree_list);
+  for (auto [subtree, depth] : subtree_list) {
+    InsertParent<BranchlessSubtreeNode>(subtree, depth);
+  }
+}
+
+}  // namespace tl2cgen::compiler::detail::ast
@@ -65,6 +65,10 @@ void ASTBuilder::BuildAST(treelite::Model const& model) {
   meta_.num_feature_ = model.num_feature;
   meta_.sigmoid_alpha_ = model.sigmoid_alpha;
   meta_.ratio_c_ = model.ratio_c;
+  meta_.fast_math_postprocess_ = false;
+  meta_.leaf_output_precision_ = "native";
+  meta_.leaf_output_scale_exponent_ = 0;
+  meta_.narrow_thresholds_ = false;
 
   ASTNode* func = AddNode<FunctionNode>(main_node_);
   main_node_->children_.push_back(func);
@@ -82,6 +86,14 @@ void ASTBuilder::BuildAST(treelite::Model const& model) {
       model.variant_);
 }
 
+void ASTBuilder::EnableFastMathPostprocessor() {
+  meta_.fast_math_postprocess_ = true;
+}
+
+void ASTBuilder::NarrowThresholds() {
+  meta_.narrow_thresholds_ = true;
+}
+
 /*!
  * \brief Generate AST from a single decision tree
  * \param parent The parent node to which the generated AST subtree is to be attached
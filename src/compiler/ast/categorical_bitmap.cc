@@ -0,0 +1,56 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file categorical_bitmap.cc
+ * \brief AST manipulation logic to collect category bitmaps into a shared lookup table
+ * \author Hyunsu Cho
+ */
+#include <tl2cgen/detail/compiler/ast/builder.h>
+#include <tl2cgen/detail/compiler/codegen/codegen.h>
+#include <tl2cgen/logging.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+namespace ast = tl2cgen::compiler::detail::ast;
+
+void ScanCategoricalTests(ast::ASTNode* node, std::vector<std::uint64_t>& table,
+    std::map<std::vector<std::uint64_t>, std::size_t>& offset_of_bitmap) {
+  if (dynamic_cast<ast::ArrayLayoutNode*>(node) || dynamic_cast<ast::QuickScorerNode*>(node)) {
+    return;  // These layouts store the categorical tests in their own arrays
+  }
+  auto* cat_cond = dynamic_cast<ast::CategoricalConditionNode*>(node);
+  if (cat_cond) {
+    std::vector<std::uint64_t> bitmap
+        = tl2cgen::compiler::detail::codegen::GetCategoricalBitmap(cat_cond->category_list_);
+    // A bitmap with a single word is embedded in the test as a constant
+    if (bitmap.size() > 1) {
+      auto itr = offset_of_bitmap.find(bitmap);
+      if (itr == offset_of_bitmap.end()) {
+        itr = offset_of_bitmap.emplace(bitmap, table.size()).first;
+        table.insert(table.end(), bitmap.begin(), bitmap.end());
+      }
+      cat_cond->bitmap_offset_ = itr->second;
+    }
+  }
+  for (ast::ASTNode* child : node->children_) {
+    ScanCategoricalTests(child, table, offset_of_bitmap);
+  }
+}
+
+}  // anonymous namespace
+
+namespace tl2cgen::compiler::detail::ast {
+
+void ASTBuilder::GenerateCategoricalBitmapTable() {
+  std::vector<std::uint64_t> table;
+  std::map<std::vector<std::uint64_t>, std::size_t> offset_of_bitmap;
+  ScanCategoricalTests(main_node_, table, offset_of_bitmap);
+  meta_.categorical_bitmap_ = std::move(table);
+}
+
+}  // namespace tl2cgen::compiler::detail::ast
@@ -0,0 +1,218 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file dedup.cc
+ * \brief AST manipulation logic to remove redundancy from the model structure, by folding
+ *        constant trees into the base scores and by sharing the code of repeated subtrees
+ * \author Hyunsu Cho
+ */
+#include <fmt/format.h>
+#include <tl2cgen/detail/compiler/ast/builder.h>
+#include <tl2cgen/logging.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace {
+
+namespace ast = tl2cgen::compiler::detail::ast;
+
+// Add the output of a leaf to base_scores, which has shape (num_target, max_num_class)
+void FoldLeafOutput(ast::OutputNode const* leaf, ast::ModelMeta const& meta,
+    std::int32_t max_num_class, std::vector<double>& base_scores) {
+  std::int32_t const num_target = meta.num_target_;
+  std::vector<std::int32_t> const& num_class = meta.num_class_;
+  std::visit(
+      [&](auto&& leaf_output) {
+        if (leaf->target_id_ < 0 && leaf->class_id_ < 0) {
+          // The leaf produces output for all targets and all classes
+          for (std::int32_t target_id = 0; target_id < num_target; ++target_id) {
+            for (std::int32_t class_id = 0; class_id < num_class[target_id]; ++class_id) {
+              base_scores[target_id * max_num_class + class_id]
+                  += leaf_output[target_id * max_num_class + class_id];
+            }
+          }
+        } else if (leaf->target_id_ < 0) {
+          // The leaf produces output for all targets and a single class
+          for (std::int32_t target_id = 0; target_id < num_target; ++target_id) {
+            base_scores[target_id * max_num_class + leaf->class_id_] += leaf_output[target_id];
+          }
+        } else if (leaf->class_id_ < 0) {
+          // The leaf produces output for all classes and a single target
+          std::int32_t const target_id = leaf->target_id_;
+          for (std::int32_t class_id = 0; class_id < num_class[target_id]; ++class_id) {
+            base_scores[target_id * max_num_class + class_id] += leaf_output[class_id];
+          }
+        } else {
+          // The leaf produces output for a single target and a single class
+          base_scores[leaf->target_id_ * max_num_class + leaf->class_id_] += leaf_output[0];
+        }
+      },
+      leaf->leaf_output_);
+}
+
+// Assigns the same ID to structurally identical subtrees, by looking up a key made of the
+// fields of each node and the IDs of its children.
+class SubtreeIndex {
+ public:
+  // Returns the ID of the subtree rooted at node, or -1 if the subtree cannot be shared
+  int Index(ast::ASTNode const* node) {
+    std::vector<int> child_id;
+    for (ast::ASTNode const* child : node->children_) {
+      child_id.push_back(Index(child));
+    }
+    std::string key;
+    if (auto const* num_cond = dynamic_cast<ast::NumericalConditionNode const*>(node)) {
+      key = fmt::format("N {} {} {} {}", num_cond->split_index_, num_cond->default_left_,
+          static_cast<int>(num_cond->op_),
+          std::visit([](auto&& e) { return fmt::format("{}", e); }, num_cond->threshold_));
+    } else if (auto const* cat_cond = dynamic_cast<ast::CategoricalConditionNode const*>(node)) {
+      key = fmt::format("C {} {} {}", cat_cond->split_index_, cat_cond->default_left_,
+          cat_cond->category_list_right_child_);
+      for (std::uint32_t e : cat_cond->category_list_) {
+        key += fmt::format(" {}", e);
+      }
+    } else if (auto const* leaf = dynamic_cast<ast::OutputNode const*>(node)) {
+      key = fmt::format("O {} {}", leaf->target_id_, leaf->class_id_);
+      std::visit(
+          [&key](auto&& leaf_output) {
+            for (auto e : leaf_output) {
+              key += fmt::format(" {}", e);
+            }
+          },
+          leaf->leaf_output_);
+    } else {
+      return -1;
+    }
+    key += " |";
+    for (int e : child_id) {
+      if (e < 0) {
+        return -1;
+      }
+      key += fmt::format(" {}", e);
+    }
+    auto [itr, inserted] = id_of_key_.emplace(key, static_cast<int>(count_.size()));
+    if (inserted) {
+      count_.push_back(0);
+    }
+    int const id = itr->second;
+    ++count_[id];
+    id_of_node_[node] = id;
+    return id;
+  }
+
+  // Returns the ID of a subtree if it occurs more than once, or -1 otherwise
+  int GetRepeatedSubtreeID(ast::ASTNode const* node) const {
+    auto itr = id_of_node_.find(node);
+    if (itr == id_of_node_.end() || count_[itr->second] < 2) {
+      return -1;
+    }
+    return itr->second;
+  }
+
+ private:
+  std::unordered_map<std::string, int> id_of_key_;
+  std::unordered_map<ast::ASTNode const*, int> id_of_node_;
+  std::vector<int> count_;
+};
+
+// Find the largest repeated subtrees with at least one test, and group them by their IDs
+void FindRepeatedSubtrees(ast::ASTNode* node, SubtreeIndex const& index,
+    std::map<int, std::vector<ast::ASTNode*>>& groups) {
+  if (dynamic_cast<ast::ConditionNode*>(node)) {
+    int const id = index.GetRepeatedSubtreeID(node);
+    if (id >= 0) {
+      groups[id].push_back(node);
+      return;
+    }
+  }
+  for (ast::ASTNode* child : node->children_) {
+    FindRepeatedSubtrees(child, index, groups);
+  }
+}
+
+}  // anonymous namespace
+
+namespace tl2cgen::compiler::detail::ast {
+
+void ASTBuilder::FoldConstantTrees() {
+  auto* main_node = dynamic_cast<MainNode*>(main_node_);
+  TL2CGEN_CHECK(main_node);
+  if (main_node->average_factor_) {
+    // Removing a tree would change the number of trees to average over
+    TL2CGEN_LOG(INFO) << "Constant trees are not folded, since the model averages tree outputs";
+    return;
+  }
+  std::int32_t const max_num_class
+      = *std::max_element(meta_.num_class_.begin(), meta_.num_class_.end());
+  std::vector<double>& base_scores = main_node->base_scores_;
+  TL2CGEN_CHECK_EQ(base_scores.size(), static_cast<std::size_t>(meta_.num_target_) * max_num_class);
+  TL2CGEN_CHECK_EQ(main_node_->children_.size(), 1);
+  ASTNode* func_node = main_node_->children_[0];
+  TL2CGEN_CHECK(dynamic_cast<FunctionNode*>(func_node));
+  std::vector<ASTNode*> remaining_trees;
+  std::size_t num_folded = 0;
+  for (ASTNode* tree_head : func_node->children_) {
+    if (auto const* leaf = dynamic_cast<OutputNode*>(tree_head)) {
+      FoldLeafOutput(leaf, meta_, max_num_class, base_scores);
+      ++num_folded;
+    } else {
+      remaining_trees.push_back(tree_head);
+    }
+  }
+  func_node->children_ = std::move(remaining_trees);
+  TL2CGEN_LOG(INFO) << "Folded " << num_folded << " constant tree(s) into the base scores";
+}
+
+void ASTBuilder::ShareDuplicateSubtrees() {
+  SubtreeIndex index;
+  index.Index(main_node_);
+  std::map<int, std::vector<ASTNode*>> groups;
+  FindRepeatedSubtrees(main_node_, index, groups);
+  // A subtree may have been counted inside other repeated subtrees, which are now shared
+  // as a whole. Look inside the subtrees that turn out to occur only once.
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (auto itr = groups.begin(); itr != groups.end();) {
+      if (itr->second.size() == 1) {
+        ASTNode* node = itr->second[0];
+        itr = groups.erase(itr);
+        for (ASTNode* child : node->children_) {
+          FindRepeatedSubtrees(child, index, groups);
+        }
+        changed = true;
+      } else {
+        ++itr;
+      }
+    }
+  }
+
+  int func_id = 0;
+  std::size_t num_occurrence = 0;
+  for (auto const& [id, subtree_list] : groups) {
+    auto* definition = InsertParent<SharedSubtreeNode>(subtree_list[0], func_id);
+    for (std::size_t i = 1; i < subtree_list.size(); ++i) {
+      ASTNode* subtree = subtree_list[i];
+      ASTNode* parent = subtree->parent_;
+      auto* ref = AddNode<SharedSubtreeNode>(parent, func_id);
+      ref->definition_ = definition;
+      ref->data_count_ = subtree->data_count_;
+      ref->sum_hess_ = subtree->sum_hess_;
+      ref->tree_id_ = subtree->tree_id_;
+      ref->node_id_ = subtree->node_id_;
+      auto it = std::find(parent->children_.begin(), parent->children_.end(), subtree);
+      *it = ref;
+    }
+    num_occurrence += subtree_list.size();
+    ++func_id;
+  }
+  TL2CGEN_LOG(INFO) << "Rendered " << func_id << " repeated subtree(s), occurring "
+                    << num_occurrence << " times in total, as shared functions";
+}
+
+}  // namespace tl2cgen::compiler::detail::ast
@@ -70,7 +70,7 @@ std::string TranslationUnitNode::GetDump() const {
 
 std::string QuantizerNode::GetDump() const {
   return std::visit(
-      [](auto&& threshold_list_concrete) {
+      [this](auto&& threshold_list_concrete) {
         using ThresholdListT
             = std::remove_const_t<std::remove_reference_t<decltype(threshold_list_concrete)>>;
         using ThresholdT = typename ThresholdListT::value_type::value_type;
@@ -84,12 +84,42 @@ std::string QuantizerNode::GetDump() const {
           oss << "], ";
         }
         oss << "]";
-        return fmt::format(
-            "QuantizerNode {{ threshold_list: {}{} }}", GetDumpFromType<ThresholdT>(), oss.str());
+        return fmt::format("QuantizerNode {{ threshold_list: {}{}, bin_width: {} }}",
+            GetDumpFromType<ThresholdT>(), oss.str(), bin_width_);
       },
       threshold_list_);
 }
 
+std::string ArrayLayoutNode::GetDump() const {
+  return fmt::format("ArrayLayoutNode {{ layout_id: {}, simd: {}, num_interleaved_tree: {} }}",
+      layout_id_, simd_, num_interleaved_tree_);
+}
+
+std::string QuickScorerNode::GetDump() const {
+  return fmt::format("QuickScorerNode {{ layout_id: {} }}", layout_id_);
+}
+
+std::string BranchlessSubtreeNode::GetDump() const {
+  return fmt::format("BranchlessSubtreeNode {{ depth: {} }}", depth_);
+}
+
+std::string OutlinedSubtreeNode::GetDump() const {
+  return fmt::format("OutlinedSubtreeNode {{ func_id: {} }}", func_id_);
+}
+
+std::string SharedSubtreeNode::GetDump() const {
+  return fmt::format("SharedSubtreeNode {{ func_id: {}, is_definition: {} }}", func_id_,
+      (definition_ == nullptr));
+}
+
+std::string TreeFunctionNode::GetDump() const {
+  return fmt::format("TreeFunctionNode {{ tree_id: {} }}", tree_id_);
+}
+
+std::string MissingFastPathNode::GetDump() const {
+  return fmt::format("MissingFastPathNode {{ num_feature_used: {} }}", feature_list_.size());
+}
+
 std::string FunctionNode::GetDump() const {
   return fmt::format("FunctionNode {{}}");
 }
@@ -113,11 +143,11 @@ std::string NumericalConditionNode::GetDump() const {
       threshold_);
   return fmt::format(
       "NumericalConditionNode {{ {}, op: {}, threshold: {}, {}"
-      "zero_quantized: {} }}",
+      "zero_quantized: {}, integer_compare: {} }}",
       ConditionNode::GetDump(), treelite::OperatorToString(op_), threshold_str,
       (quantized_threshold_ ? fmt::format("quantized_threshold_: int({}), ", *quantized_threshold_)
                             : std::string("")),
-      zero_quantized_);
+      zero_quantized_, integer_compare_);
 }
 
 std::string CategoricalConditionNode::GetDump() const {
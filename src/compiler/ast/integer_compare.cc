@@ -0,0 +1,56 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file integer_compare.cc
+ * \brief AST manipulation logic to compare feature values with thresholds as integers
+ * \author Hyunsu Cho
+ */
+#include <tl2cgen/detail/compiler/ast/builder.h>
+#include <tl2cgen/logging.h>
+
+#include <cmath>
+#include <cstddef>
+#include <variant>
+
+namespace {
+
+namespace ast = tl2cgen::compiler::detail::ast;
+
+// The bit pattern of a float32 value, read as a signed integer, is ordered the same way as the
+// value itself for non-negative values, and is negative for all negative values (including -0.0).
+// So comparing the bit patterns gives the same result as comparing the values, as long as the
+// threshold is positive and finite. The Predictor treats NaN as missing, in both dense and sparse
+// matrices, so NaN does not reach the test. A caller of the generated predict() that passes NaN
+// as a non-missing value gets a different result, however: every floating-point comparison with
+// NaN fails, whereas the bit pattern of NaN compares as greater than any finite threshold (or as
+// negative, if the sign bit is set).
+std::size_t MarkIntegerComparisons(ast::ASTNode* node) {
+  std::size_t count = 0;
+  auto* num_cond = dynamic_cast<ast::NumericalConditionNode*>(node);
+  if (num_cond && !num_cond->quantized_threshold_
+      && std::holds_alternative<float>(num_cond->threshold_)) {
+    float const threshold = std::get<float>(num_cond->threshold_);
+    if (threshold > 0.0f && std::isfinite(threshold)) {
+      num_cond->integer_compare_ = true;
+      ++count;
+    }
+  }
+  for (ast::ASTNode* child : node->children_) {
+    count += MarkIntegerComparisons(child);
+  }
+  return count;
+}
+
+}  // anonymous namespace
+
+namespace tl2cgen::compiler::detail::ast {
+
+void ASTBuilder::EnableIntegerComparisons() {
+  if (!std::holds_alternative<ModelMeta::TypeMeta<float, float>>(meta_.type_meta_)) {
+    TL2CGEN_LOG(INFO) << "Integer comparisons disabled: they require float32 thresholds";
+    return;
+  }
+  std::size_t const count = MarkIntegerComparisons(main_node_);
+  TL2CGEN_LOG(INFO) << "Converted " << count << " test(s) into integer comparisons";
+}
+
+}  // namespace tl2cgen::compiler::detail::ast
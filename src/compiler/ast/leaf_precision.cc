@@ -0,0 +1,81 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file leaf_precision.cc
+ * \brief AST manipulation logic to round leaf outputs, so that they can be stored with reduced
+ *        precision
+ * \author Hyunsu Cho
+ */
+#include <tl2cgen/detail/compiler/ast/builder.h>
+#include <tl2cgen/detail/compiler/leaf_precision.h>
+#include <tl2cgen/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <variant>
+
+namespace {
+
+namespace ast = tl2cgen::compiler::detail::ast;
+using tl2cgen::compiler::detail::RoundLeafOutput;
+
+double GetMaxAbsLeafOutput(ast::ASTNode const* node) {
+  double result = 0.0;
+  if (auto const* output_node = dynamic_cast<ast::OutputNode const*>(node)) {
+    std::visit(
+        [&](auto&& leaf_output) {
+          for (auto e : leaf_output) {
+            result = std::max(result, std::fabs(static_cast<double>(e)));
+          }
+        },
+        output_node->leaf_output_);
+  }
+  for (ast::ASTNode const* child : node->children_) {
+    result = std::max(result, GetMaxAbsLeafOutput(child));
+  }
+  return result;
+}
+
+std::size_t RoundLeafOutputs(
+    ast::ASTNode* node, std::string const& precision, int scale_exponent) {
+  std::size_t count = 0;
+  if (auto* output_node = dynamic_cast<ast::OutputNode*>(node)) {
+    std::visit(
+        [&](auto&& leaf_output) {
+          using LeafOutputType
+              = typename std::remove_reference_t<decltype(leaf_output)>::value_type;
+          for (auto& e : leaf_output) {
+            auto const rounded = static_cast<LeafOutputType>(
+                RoundLeafOutput(static_cast<double>(e), precision, scale_exponent));
+            if (rounded != e) {
+              e = rounded;
+              ++count;
+            }
+          }
+        },
+        output_node->leaf_output_);
+  }
+  for (ast::ASTNode* child : node->children_) {
+    count += RoundLeafOutputs(child, precision, scale_exponent);
+  }
+  return count;
+}
+
+}  // anonymous namespace
+
+namespace tl2cgen::compiler::detail::ast {
+
+void ASTBuilder::ReduceLeafOutputPrecision(std::string const& precision) {
+  int scale_exponent = 0;
+  if (precision == "int16") {
+    scale_exponent = GetInt16LeafScaleExponent(GetMaxAbsLeafOutput(main_node_));
+  }
+  std::size_t const count = RoundLeafOutputs(main_node_, precision, scale_exponent);
+  meta_.leaf_output_precision_ = precision;
+  meta_.leaf_output_scale_exponent_ = scale_exponent;
+  TL2CGEN_LOG(INFO) << "Rounded " << count << " leaf output(s) to " << precision;
+}
+
+}  // namespace tl2cgen::compiler::detail::ast
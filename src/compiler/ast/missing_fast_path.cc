@@ -0,0 +1,54 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file missing_fast_path.cc
+ * \brief AST manipulation logic to specialize the prediction function for rows without missing
+ *        values
+ * \author Hyunsu Cho
+ */
+#include <tl2cgen/detail/compiler/ast/builder.h>
+#include <tl2cgen/logging.h>
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace {
+
+namespace ast = tl2cgen::compiler::detail::ast;
+
+// Collect the features tested anywhere in the subtree rooted at node
+void FindUsedFeatures(ast::ASTNode const* node, std::set<std::uint32_t>& used_features) {
+  if (auto const* cond = dynamic_cast<ast::ConditionNode const*>(node)) {
+    used_features.insert(cond->split_index_);
+  }
+  for (ast::ASTNode const* child : node->children_) {
+    FindUsedFeatures(child, used_features);
+  }
+}
+
+}  // anonymous namespace
+
+namespace tl2cgen::compiler::detail::ast {
+
+void ASTBuilder::GenerateMissingFastPath() {
+  std::set<std::uint32_t> used_features;
+  FindUsedFeatures(main_node_, used_features);
+  if (used_features.empty()) {
+    TL2CGEN_LOG(INFO) << "The model tests no feature, so the fast path for rows without missing "
+                         "values is not generated";
+    return;
+  }
+  // The trees live under the top-level function node, which is the first function node found by
+  // following the only child of the main node.
+  ASTNode* node = main_node_;
+  while (!dynamic_cast<FunctionNode*>(node)) {
+    TL2CGEN_CHECK_EQ(node->children_.size(), 1);
+    node = node->children_[0];
+  }
+  InsertParent<MissingFastPathNode>(
+      node, std::vector<std::uint32_t>(used_features.begin(), used_features.end()));
+  TL2CGEN_LOG(INFO) << "Generated the fast path for rows without missing values in "
+                    << used_features.size() << " feature(s)";
+}
+
+}  // namespace tl2cgen::compiler::detail::ast
@@ -0,0 +1,87 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file outline.cc
+ * \brief AST manipulation logic to move rarely visited subtrees into separate functions
+ * \author Hyunsu Cho
+ */
+#include <tl2cgen/detail/compiler/ast/builder.h>
+#include <tl2cgen/logging.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+namespace ast = tl2cgen::compiler::detail::ast;
+
+// A subtree is cold if it is visited by at most 1/kColdRatio of the rows visiting the tree
+constexpr std::uint64_t kColdRatio = 100;
+// Outlining a subtree replaces it with a function call, which only pays off for subtrees that
+// contain enough code.
+constexpr std::size_t kMinNumTestForOutlining = 4;
+
+std::size_t CountTests(ast::ASTNode* node) {
+  std::size_t count = (dynamic_cast<ast::ConditionNode*>(node) ? 1 : 0);
+  for (ast::ASTNode* child : node->children_) {
+    count += CountTests(child);
+  }
+  return count;
+}
+
+// Find the largest cold subtrees under the given tree node
+void FindColdSubtrees(
+    ast::ASTNode* node, std::uint64_t threshold, std::vector<ast::ASTNode*>& subtree_list) {
+  if (!dynamic_cast<ast::ConditionNode*>(node)) {
+    return;
+  }
+  if (node->data_count_ && *node->data_count_ <= threshold
+      && CountTests(node) >= kMinNumTestForOutlining) {
+    subtree_list.push_back(node);
+    return;
+  }
+  for (ast::ASTNode* child : node->children_) {
+    FindColdSubtrees(child, threshold, subtree_list);
+  }
+}
+
+// Find all tree heads, i.e. tests and outputs that are children of a function node
+void FindTreeHeads(ast::ASTNode* node, std::vector<ast::ASTNode*>& tree_list) {
+  if (dynamic_cast<ast::FunctionNode*>(node)) {
+    for (ast::ASTNode* child : node->children_) {
+      if (dynamic_cast<ast::ConditionNode*>(child) || dynamic_cast<ast::OutputNode*>(child)) {
+        tree_list.push_back(child);
+      }
+    }
+  }
+  for (ast::ASTNode* child : node->children_) {
+    FindTreeHeads(child, tree_list);
+  }
+}
+
+}  // anonymous namespace
+
+namespace tl2cgen::compiler::detail::ast {
+
+void ASTBuilder::OutlineColdSubtrees() {
+  std::vector<ASTNode*> tree_list;
+  FindTreeHeads(main_node_, tree_list);
+  std::vector<ASTNode*> subtree_list;
+  for (ASTNode* tree_head : tree_list) {
+    if (!tree_head->data_count_) {
+      continue;
+    }
+    std::uint64_t const threshold = *tree_head->data_count_ / kColdRatio;
+    for (ASTNode* child : tree_head->children_) {
+      FindColdSubtrees(child, threshold, subtree_list);
+    }
+  }
+  int func_id = 0;
+  for (ASTNode* subtree : subtree_list) {
+    InsertParent<OutlinedSubtreeNode>(subtree, func_id++);
+  }
+  TL2CGEN_LOG(INFO) << "Moved " << subtree_list.size()
+                    << " rarely visited subtree(s) into separate functions";
+}
+
+}  // namespace tl2cgen::compiler::detail::ast
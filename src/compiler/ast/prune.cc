@@ -0,0 +1,169 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file prune.cc
+ * \brief AST manipulation logic to remove tests whose outcome is already decided by the tests
+ *        above them
+ * \author Hyunsu Cho
+ */
+#include <tl2cgen/detail/compiler/ast/builder.h>
+#include <tl2cgen/logging.h>
+#include <treelite/enum/operator.h>
+
+#include <cstddef>
+#include <limits>
+#include <variant>
+#include <vector>
+
+namespace {
+
+namespace ast = tl2cgen::compiler::detail::ast;
+
+// Possible values of a feature at a node, given the outcomes of the tests on the path from the
+// root. Non-missing values lie in the interval between lower and upper; each bound may be
+// inclusive or exclusive. Like the generated code, which evaluates tests against infinite
+// thresholds as constants, assume that non-missing values are finite.
+struct FeatureRange {
+  double lower{-std::numeric_limits<double>::infinity()};
+  double upper{std::numeric_limits<double>::infinity()};
+  bool lower_inclusive{false};
+  bool upper_inclusive{false};
+  bool may_be_missing{true};
+
+  bool IsEmpty() const {
+    return lower > upper || (lower == upper && !(lower_inclusive && upper_inclusive));
+  }
+  void IntersectLower(double value, bool inclusive) {
+    if (value > lower) {
+      lower = value;
+      lower_inclusive = inclusive;
+    } else if (value == lower) {
+      lower_inclusive = lower_inclusive && inclusive;
+    }
+  }
+  void IntersectUpper(double value, bool inclusive) {
+    if (value < upper) {
+      upper = value;
+      upper_inclusive = inclusive;
+    } else if (value == upper) {
+      upper_inclusive = upper_inclusive && inclusive;
+    }
+  }
+  // Whether (x op threshold) holds for every value x in the interval
+  bool AlwaysTrue(treelite::Operator op, double threshold) const {
+    switch (op) {
+      case treelite::Operator::kLT:
+        return upper < threshold || (upper == threshold && !upper_inclusive);
+      case treelite::Operator::kLE:
+        return upper <= threshold;
+      case treelite::Operator::kGT:
+        return lower > threshold || (lower == threshold && !lower_inclusive);
+      case treelite::Operator::kGE:
+        return lower >= threshold;
+      case treelite::Operator::kEQ:
+        return lower == threshold && upper == threshold;
+      default:
+        return false;
+    }
+  }
+  // Whether (x op threshold) fails for every value x in the interval
+  bool AlwaysFalse(treelite::Operator op, double threshold) const {
+    switch (op) {
+      case treelite::Operator::kLT:
+        return lower >= threshold;
+      case treelite::Operator::kLE:
+        return lower > threshold || (lower == threshold && !lower_inclusive);
+      case treelite::Operator::kGT:
+        return upper <= threshold;
+      case treelite::Operator::kGE:
+        return upper < threshold || (upper == threshold && !upper_inclusive);
+      case treelite::Operator::kEQ:
+        return threshold < lower || threshold > upper
+               || (threshold == lower && !lower_inclusive)
+               || (threshold == upper && !upper_inclusive);
+      default:
+        return false;
+    }
+  }
+  // Keep only the values x for which (x op threshold) has the given outcome
+  void Restrict(treelite::Operator op, double threshold, bool outcome) {
+    switch (op) {
+      case treelite::Operator::kLT:
+        outcome ? IntersectUpper(threshold, false) : IntersectLower(threshold, true);
+        break;
+      case treelite::Operator::kLE:
+        outcome ? IntersectUpper(threshold, true) : IntersectLower(threshold, false);
+        break;
+      case treelite::Operator::kGT:
+        outcome ? IntersectLower(threshold, false) : IntersectUpper(threshold, true);
+        break;
+      case treelite::Operator::kGE:
+        outcome ? IntersectLower(threshold, true) : IntersectUpper(threshold, false);
+        break;
+      case treelite::Operator::kEQ:
+        if (outcome) {
+          IntersectLower(threshold, true);
+          IntersectUpper(threshold, true);
+        } else if (lower == threshold && upper == threshold) {
+          lower_inclusive = false;  // No value is left
+        }
+        break;
+      default:
+        break;
+    }
+  }
+};
+
+// Remove the tests in the subtree rooted at node whose outcome is decided, and return the node
+// that takes the place of the subtree root
+ast::ASTNode* PruneTests(
+    ast::ASTNode* node, std::vector<FeatureRange>& feature_range, std::size_t& num_pruned) {
+  auto* cond = dynamic_cast<ast::NumericalConditionNode*>(node);
+  if (!cond) {
+    for (ast::ASTNode*& child : node->children_) {
+      child = PruneTests(child, feature_range, num_pruned);
+      child->parent_ = node;
+    }
+    return node;
+  }
+  TL2CGEN_CHECK_EQ(node->children_.size(), 2);
+  TL2CGEN_CHECK_LT(cond->split_index_, feature_range.size());
+  FeatureRange& range = feature_range[cond->split_index_];
+  double const threshold
+      = std::visit([](auto&& e) { return static_cast<double>(e); }, cond->threshold_);
+  bool const empty = range.IsEmpty();
+  // Missing values follow the default direction; other values follow the outcome of the test
+  bool const left_reachable = (range.may_be_missing && cond->default_left_)
+                              || (!empty && !range.AlwaysFalse(cond->op_, threshold));
+  bool const right_reachable = (range.may_be_missing && !cond->default_left_)
+                               || (!empty && !range.AlwaysTrue(cond->op_, threshold));
+  if (!left_reachable || !right_reachable) {
+    // If neither child is reachable, the whole subtree is dead code and either child will do
+    ast::ASTNode* kept = node->children_[left_reachable ? 0 : 1];
+    kept->parent_ = node->parent_;
+    ++num_pruned;
+    return PruneTests(kept, feature_range, num_pruned);
+  }
+  for (int i = 0; i < 2; ++i) {
+    bool const is_left = (i == 0);
+    FeatureRange const saved = range;
+    range.Restrict(cond->op_, threshold, is_left);
+    range.may_be_missing = saved.may_be_missing && (cond->default_left_ == is_left);
+    node->children_[i] = PruneTests(node->children_[i], feature_range, num_pruned);
+    node->children_[i]->parent_ = node;
+    range = saved;
+  }
+  return node;
+}
+
+}  // anonymous namespace
+
+namespace tl2cgen::compiler::detail::ast {
+
+void ASTBuilder::PruneRedundantTests() {
+  std::vector<FeatureRange> feature_range(meta_.num_feature_);
+  std::size_t num_pruned = 0;
+  PruneTests(main_node_, feature_range, num_pruned);
+  TL2CGEN_LOG(INFO) << "Removed " << num_pruned << " test(s) whose outcome is already decided";
+}
+
+}  // namespace tl2cgen::compiler::detail::ast
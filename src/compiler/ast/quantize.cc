@@ -8,8 +8,11 @@
 #include <tl2cgen/detail/math_funcs.h>
 #include <tl2cgen/logging.h>
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <set>
 #include <type_traits>
 #include <variant>
@@ -44,14 +47,14 @@ void RewriteThresholds(ast::ASTNode* node, std::vector<std::vector<ThresholdType
       {
         auto loc = tl2cgen::detail::math::BinarySearch(v.begin(), v.end(), threshold);
         TL2CGEN_CHECK(loc != v.end());
-        num_cond->quantized_threshold_ = static_cast<int>(loc - v.begin()) * 2;
+        num_cond->quantized_threshold_ = static_cast<int>(loc - v.begin()) * 2 + 1;
       }
       {
         auto zero = static_cast<ThresholdType>(0);
         auto loc = std::lower_bound(v.begin(), v.end(), zero);
         num_cond->zero_quantized_ = static_cast<int>(loc - v.begin()) * 2;
-        if (loc != v.end() && zero != *loc) {
-          --num_cond->zero_quantized_;
+        if (loc != v.end() && zero == *loc) {
+          ++num_cond->zero_quantized_;
         }
       }
     }  // Splits with infinite thresholds will not be quantized
@@ -61,6 +64,39 @@ void RewriteThresholds(ast::ASTNode* node, std::vector<std::vector<ThresholdType
   }
 }
 
+// Whether the trees under node are rendered as tables (array layout or QuickScorer), which read
+// the quantized feature values from data[].qvalue
+bool HasTableLayout(ast::ASTNode const* node) {
+  if (dynamic_cast<ast::ArrayLayoutNode const*>(node)
+      || dynamic_cast<ast::QuickScorerNode const*>(node)) {
+    return true;
+  }
+  for (ast::ASTNode const* child : node->children_) {
+    if (HasTableLayout(child)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Choose the narrowest integer type that holds every quantized value of every feature, as well
+// as the marker for missing values. quantize() returns 0 for values below all thresholds of a
+// feature and 2 * (number of thresholds) for values above them, while the minimum value of the
+// type marks missing values. Returns 0 if the quantized values need a full int.
+template <typename ThresholdType>
+int ChooseBinWidth(std::vector<std::vector<ThresholdType>> const& cut_pts) {
+  std::size_t max_num_threshold = 0;
+  for (auto const& e : cut_pts) {
+    max_num_threshold = std::max(max_num_threshold, e.size());
+  }
+  if (2 * max_num_threshold <= std::numeric_limits<std::int8_t>::max()) {
+    return 8;
+  } else if (2 * max_num_threshold <= std::numeric_limits<std::int16_t>::max()) {
+    return 16;
+  }
+  return 0;
+}
+
 }  // anonymous namespace
 
 namespace tl2cgen::compiler::detail::ast {
@@ -89,7 +125,14 @@ void ASTBuilder::QuantizeThresholds() {
         /* dynamic_cast<> is used here to check node types. This is to ensure
           that we don't accidentally call QuantizeThresholds() twice. */
 
-        ASTNode* quantizer_node = AddNode<QuantizerNode>(main_node_, std::move(cut_pts_vec));
+        // Trees rendered as nested if/else blocks read the quantized values from a compact
+        // buffer of narrow integers instead, to shrink the working set per row
+        int const bin_width = HasTableLayout(top_func_node) ? 0 : ChooseBinWidth(cut_pts_vec);
+        auto* quantizer_node = AddNode<QuantizerNode>(main_node_, std::move(cut_pts_vec));
+        quantizer_node->bin_width_ = bin_width;
+        if (bin_width > 0) {
+          TL2CGEN_LOG(INFO) << "Quantized feature values are stored as int" << bin_width << "_t";
+        }
         quantizer_node->children_.push_back(top_func_node);
         top_func_node->parent_ = quantizer_node;
         main_node_->children_[0] = quantizer_node;
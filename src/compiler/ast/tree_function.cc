@@ -0,0 +1,45 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file tree_function.cc
+ * \brief AST manipulation logic to render each tree as a separate function
+ * \author Hyunsu Cho
+ */
+#include <tl2cgen/detail/compiler/ast/builder.h>
+#include <tl2cgen/logging.h>
+
+#include <vector>
+
+namespace {
+
+namespace ast = tl2cgen::compiler::detail::ast;
+
+// Find all tree heads, i.e. tests, outputs and shared subtrees that are children of a function
+// node
+void FindTreeHeads(ast::ASTNode* node, std::vector<ast::ASTNode*>& tree_list) {
+  if (dynamic_cast<ast::FunctionNode*>(node)) {
+    for (ast::ASTNode* child : node->children_) {
+      if (dynamic_cast<ast::ConditionNode*>(child) || dynamic_cast<ast::OutputNode*>(child)
+          || dynamic_cast<ast::SharedSubtreeNode*>(child)) {
+        tree_list.push_back(child);
+      }
+    }
+  }
+  for (ast::ASTNode* child : node->children_) {
+    FindTreeHeads(child, tree_list);
+  }
+}
+
+}  // anonymous namespace
+
+namespace tl2cgen::compiler::detail::ast {
+
+void ASTBuilder::GenerateTreeFunctions() {
+  std::vector<ASTNode*> tree_list;
+  FindTreeHeads(main_node_, tree_list);
+  for (ASTNode* tree_head : tree_list) {
+    TL2CGEN_CHECK_GE(tree_head->tree_id_, 0);
+    InsertParent<TreeFunctionNode>(tree_head);
+  }
+}
+
+}  // namespace tl2cgen::compiler::detail::ast
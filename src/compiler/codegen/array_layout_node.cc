@@ -0,0 +1,564 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file array_layout_node.cc
+ * \brief Convert ArrayLayoutNode in AST into C code
+ * \author Hyunsu Cho
+ */
+
+#include <fmt/format.h>
+#include <tl2cgen/detail/compiler/ast/ast.h>
+#include <tl2cgen/detail/compiler/codegen/codegen.h>
+#include <tl2cgen/detail/compiler/codegen/table_util.h>
+#include <tl2cgen/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+using namespace fmt::literals;
+
+namespace {
+
+namespace ast = tl2cgen::compiler::detail::ast;
+namespace codegen = tl2cgen::compiler::detail::codegen;
+
+// Bits in node_flags[]
+constexpr unsigned kDefaultLeft = 1;
+constexpr unsigned kCategorical = 2;
+constexpr unsigned kCategoryListRightChild = 4;
+constexpr unsigned kEqualityTest = 8;
+
+char const* const array_function_name_template = "predict_array{layout_id}";
+char const* const array_function_signature_template
+    = "void {array_function_name}(union Entry* data, {leaf_output_ctype}* RESTRICT result)";
+
+char const* const array_source_template =
+    R"TL2CGENTEMPLATE(
+#include "header.h"
+
+/*
+ * Internal test nodes, laid out in depth-first order. For node i:
+ *   split_index[i]: feature to test
+ *   threshold[i]: go to left child if feature value {compare_op} threshold[i]
+ *   child[2*i], child[2*i+1]: left and right children. Negative value ~k refers to leaf k.
+ *   node_flags[i]: 1 = missing values go left, 2 = categorical test,
+ *                  4 = category list designates the right child, 8 = equality test
+ */
+static const int32_t split_index[] = {{
+{array_split_index}
+}};
+
+static const {threshold_array_ctype} threshold[] = {{
+{array_threshold}
+}};
+
+static const int32_t child[] = {{
+{array_child}
+}};
+
+static const {node_flags_ctype} node_flags[] = {{
+{array_node_flags}
+}};
+{categorical_arrays}
+/* tree_root[t]: first node of tree t (negative if tree t consists of a single leaf) */
+static const int32_t tree_root[] = {{
+{array_tree_root}
+}};
+
+{leaf_arrays}
+/* Evaluate the test at node nid and return the next node */
+static inline int next_node(const union Entry* data, int nid) {{
+  const union Entry* x = &data[split_index[nid]];
+  const unsigned char flags = node_flags[nid];
+  int go_left;
+  if (x->missing == -1) {{
+    go_left = flags & 1;
+  }}{categorical_test}{equality_test} else {{
+    go_left = x->{value_field} {compare_op} threshold[nid];
+  }}
+  return child[2 * nid + !go_left];
+}}
+
+{array_function_signature} {{{interleaved_loop}
+  for (int tree_id = {remainder_begin}; tree_id < {num_tree}; ++tree_id) {{
+    int nid = tree_root[tree_id];
+    while (nid >= 0) {{
+      nid = next_node(data, nid);
+    }}
+{accumulate_leaf}
+  }}
+}}
+)TL2CGENTEMPLATE";
+
+// Walk a group of trees in lockstep, with one independent node cursor per tree, so that the CPU
+// can overlap the memory accesses of different trees. The loop ends once every cursor reached a
+// leaf, i.e. once all cursors are negative.
+char const* const interleaved_loop_template =
+    R"TL2CGENTEMPLATE(
+  int t = 0;
+  for (; t + {num_interleaved} <= {num_tree}; t += {num_interleaved}) {{
+{init_cursors}
+    while (({all_cursors}) >= 0) {{
+{advance_cursors}
+    }}
+{accumulate_leaves}
+  }})TL2CGENTEMPLATE";
+
+char const* const categorical_arrays_template =
+    R"TL2CGENTEMPLATE(
+/* Categorical test at node i: the category list is given as a bitmap, stored in
+   cat_bitmap[cat_begin[i]:(cat_begin[i] + cat_len[i])] */
+static const int32_t cat_begin[] = {{
+{array_cat_begin}
+}};
+
+static const int32_t cat_len[] = {{
+{array_cat_len}
+}};
+
+static const uint64_t cat_bitmap[] = {{
+{array_cat_bitmap}
+}};
+)TL2CGENTEMPLATE";
+
+char const* const categorical_test_template =
+    R"TL2CGENTEMPLATE( else if (flags & 2) {{
+    const {threshold_ctype} fvalue = x->fvalue;
+    int in_list = 0;
+    if (fvalue >= 0 && {fabs}(fvalue) <= ({threshold_ctype})(1U << FLT_MANT_DIG)) {{
+      const unsigned int cat = (unsigned int)fvalue;
+      in_list = cat < 64U * (unsigned int)cat_len[nid]
+                && ((cat_bitmap[cat_begin[nid] + cat / 64] >> (cat % 64)) & 1);
+    }}
+    go_left = (flags & 4) ? !in_list : in_list;
+  }})TL2CGENTEMPLATE";
+
+char const* const equality_test_template =
+    R"TL2CGENTEMPLATE( else if (flags & 8) {{
+    go_left = x->{value_field} == threshold[nid];
+  }})TL2CGENTEMPLATE";
+
+char const* const simd_function_signature_template
+    = "void {array_function_name}_{isa}(const float* X, size_t stride, float missing, float* out)";
+
+// SIMD kernels evaluate each tree on a block of rows at once, one row per vector lane.
+// Rows are read directly from a dense matrix: row r of the block is X[(r * stride):].
+// Lanes whose rows reached a leaf keep their (negative) node ID.
+char const* const simd_source_template =
+    R"TL2CGENTEMPLATE(
+#ifdef USE_SIMD_KERNELS
+#include <immintrin.h>
+
+__attribute__((target("avx2")))
+{avx2_function_signature} {{
+  const __m256i row_offset = _mm256_mullo_epi32(
+      _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32((int)stride));
+  const __m256 missing_v = _mm256_set1_ps(missing);
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i minus_one = _mm256_set1_epi32(-1);
+{avx2_init_acc}  for (int tree_id = 0; tree_id < {num_tree}; ++tree_id) {{
+    __m256i nid = _mm256_set1_epi32(tree_root[tree_id]);
+    __m256i active = _mm256_cmpgt_epi32(nid, minus_one);
+    while (!_mm256_testz_si256(active, active)) {{
+      /* Inactive lanes read node 0, and their results are discarded */
+      const __m256i node = _mm256_and_si256(nid, active);
+      const __m256i fid = _mm256_i32gather_epi32(split_index, node, 4);
+      const __m256 x = _mm256_i32gather_ps(X, _mm256_add_epi32(row_offset, fid), 4);
+      const __m256 threshold_v = _mm256_i32gather_ps(threshold, node, 4);
+      const __m256i flags = _mm256_i32gather_epi32(node_flags, node, 4);
+      const __m256 is_missing = _mm256_or_ps(
+          _mm256_cmp_ps(x, x, _CMP_UNORD_Q), _mm256_cmp_ps(x, missing_v, _CMP_EQ_OQ));
+      const __m256 default_left
+          = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(flags, one), one));
+      const __m256 go_left = _mm256_blendv_ps(
+          _mm256_cmp_ps(x, threshold_v, _CMP_LT_OQ), default_left, is_missing);
+      /* go_left is -1 (all bits set) for the left child at child[2 * node] */
+      const __m256i child_pos = _mm256_add_epi32(
+          _mm256_add_epi32(_mm256_add_epi32(node, node), one), _mm256_castps_si256(go_left));
+      const __m256i next = _mm256_i32gather_epi32(child, child_pos, 4);
+      nid = _mm256_blendv_epi8(nid, next, active);
+      active = _mm256_cmpgt_epi32(nid, minus_one);
+    }}
+{avx2_accumulate}
+  }}
+{avx2_store_acc}}}
+
+__attribute__((target("avx512f")))
+{avx512_function_signature} {{
+  const __m512i row_offset = _mm512_mullo_epi32(
+      _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+      _mm512_set1_epi32((int)stride));
+  const __m512 missing_v = _mm512_set1_ps(missing);
+  const __m512i zero = _mm512_setzero_si512();
+  const __m512i one = _mm512_set1_epi32(1);
+{avx512_init_acc}  for (int tree_id = 0; tree_id < {num_tree}; ++tree_id) {{
+    __m512i nid = _mm512_set1_epi32(tree_root[tree_id]);
+    __mmask16 active = _mm512_cmpge_epi32_mask(nid, zero);
+    while (active) {{
+      const __m512i fid = _mm512_mask_i32gather_epi32(zero, active, nid, split_index, 4);
+      const __m512 x = _mm512_mask_i32gather_ps(
+          _mm512_setzero_ps(), active, _mm512_add_epi32(row_offset, fid), X, 4);
+      const __m512 threshold_v
+          = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), active, nid, threshold, 4);
+      const __m512i flags = _mm512_mask_i32gather_epi32(zero, active, nid, node_flags, 4);
+      const __mmask16 is_missing = _mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q)
+                                   | _mm512_cmp_ps_mask(x, missing_v, _CMP_EQ_OQ);
+      const __mmask16 go_left
+          = (_mm512_cmp_ps_mask(x, threshold_v, _CMP_LT_OQ) & ~is_missing)
+            | (_mm512_test_epi32_mask(flags, one) & is_missing);
+      /* Left child is at child[2 * node], right child at child[2 * node + 1] */
+      __m512i child_pos = _mm512_add_epi32(_mm512_add_epi32(nid, nid), one);
+      child_pos = _mm512_mask_sub_epi32(child_pos, go_left, child_pos, one);
+      nid = _mm512_mask_i32gather_epi32(nid, active, child_pos, child, 4);
+      active = _mm512_cmpge_epi32_mask(nid, zero);
+    }}
+{avx512_accumulate}
+  }}
+{avx512_store_acc}}}
+#endif  /* USE_SIMD_KERNELS */
+)TL2CGENTEMPLATE";
+
+// Render statements for SIMD kernels that add the leaf outputs to the result slots of the rows.
+// If every leaf holds a single float32 value and all trees output to the same slot of result[],
+// the leaf values are summed in a vector register instead.
+template <typename LeafOutputType>
+void RenderSIMDAccumulation(codegen::LeafOutputTable<LeafOutputType> const& leaf, bool avx512,
+    std::string& init_acc, std::string& accumulate, std::string& store_acc) {
+  int const num_lane = avx512 ? 16 : 8;
+  std::string const prefix = avx512 ? "_mm512" : "_mm256";
+  if (leaf.leaf_len_ == 1 && leaf.HasUniformOutOffset()
+      && leaf.meta_.leaf_output_precision_ == "native") {
+    if (avx512) {
+      init_acc = "  __m512 acc = _mm512_setzero_ps();\n";
+      accumulate
+          = "    acc = _mm512_add_ps(acc, _mm512_i32gather_ps(\n"
+            "        _mm512_xor_si512(nid, _mm512_set1_epi32(-1)), leaf_value, 4));";
+    } else {
+      init_acc = "  __m256 acc = _mm256_setzero_ps();\n";
+      accumulate
+          = "    acc = _mm256_add_ps(acc, _mm256_i32gather_ps(\n"
+            "        leaf_value, _mm256_xor_si256(nid, _mm256_set1_epi32(-1)), 4));";
+    }
+    store_acc = fmt::format(
+        "  {{\n"
+        "    float acc_lane[{num_lane}];\n"
+        "    {prefix}_storeu_ps(acc_lane, acc);\n"
+        "    for (int r = 0; r < {num_lane}; ++r) {{\n"
+        "      out[r * N_TARGET * MAX_N_CLASS + {out_offset}] += acc_lane[r];\n"
+        "    }}\n"
+        "  }}\n",
+        "num_lane"_a = num_lane, "prefix"_a = prefix, "out_offset"_a = leaf.out_offset_.at(0));
+  } else {
+    init_acc.clear();
+    store_acc.clear();
+    accumulate = fmt::format(
+        "    {{\n"
+        "      int32_t leaf_nid[{num_lane}];\n"
+        "      {prefix}_storeu_si{width}(({prefix_type}i*)leaf_nid, nid);\n"
+        "      for (int r = 0; r < {num_lane}; ++r) {{\n"
+        "        float* result = &out[r * N_TARGET * MAX_N_CLASS];\n"
+        "{accumulate_leaf}\n"
+        "      }}\n"
+        "    }}",
+        "num_lane"_a = num_lane, "prefix"_a = prefix, "width"_a = num_lane * 32,
+        "prefix_type"_a = avx512 ? "__m512" : "__m256",
+        "accumulate_leaf"_a = leaf.RenderAccumulation("~leaf_nid[r]", 8));
+  }
+}
+
+// Flattened representation of a group of trees
+template <typename ThresholdType, typename LeafOutputType>
+class ArrayLayout {
+ public:
+  ArrayLayout(ast::ModelMeta const& meta, bool quantized)
+      : quantized_(quantized),
+        leaf_(meta),
+        narrowable_(
+            meta.narrow_thresholds_ && !quantized && std::is_same_v<ThresholdType, double>) {}
+
+  void AddTree(ast::ASTNode const* tree_head) {
+    leaf_.AddTree();
+    tree_root_.push_back(Flatten(tree_head));
+  }
+
+  // Content of threshold[], if it is stored as float32
+  std::vector<std::string> GetNarrowThresholds() const {
+    std::vector<std::string> result;
+    for (float threshold : narrow_threshold_) {
+      if (std::isinf(threshold)) {
+        // No feature value may satisfy the test. (x <= -INFINITY) holds for x = -INFINITY, but
+        // no comparison with NAN holds.
+        result.emplace_back(inclusive_ ? "NAN" : "-INFINITY");
+      } else {
+        result.push_back(codegen::ToStringHighPrecision(threshold));
+      }
+    }
+    return result;
+  }
+
+  bool quantized_;
+  codegen::LeafOutputTable<LeafOutputType> leaf_;
+
+  std::vector<std::int32_t> split_index_;
+  std::vector<std::string> threshold_;
+  std::vector<std::int32_t> child_;
+  std::vector<unsigned> node_flags_;
+  std::vector<std::int32_t> cat_begin_;
+  std::vector<std::int32_t> cat_len_;
+  std::vector<std::uint64_t> cat_bitmap_;
+  std::vector<std::int32_t> tree_root_;
+  bool has_categorical_{false};
+  bool has_equality_test_{false};
+  // Whether threshold[] can be stored as float32 instead. All thresholds must be exactly
+  // representable in float32, and all tests must use the same comparison (< or <=), since
+  // normalizing (x <= t) into (x < t') would make the threshold inexact.
+  bool narrowable_;
+  bool inclusive_{false};  // Whether the tests are (x <= threshold) when narrowed
+
+ private:
+  std::int32_t AddTestNode(std::uint32_t split_index, std::string threshold, unsigned flags) {
+    auto const nid = static_cast<std::int32_t>(split_index_.size());
+    split_index_.push_back(static_cast<std::int32_t>(split_index));
+    threshold_.push_back(std::move(threshold));
+    narrow_threshold_.push_back(0.0f);
+    child_.push_back(0);
+    child_.push_back(0);
+    node_flags_.push_back(flags);
+    cat_begin_.push_back(0);
+    cat_len_.push_back(0);
+    return nid;
+  }
+
+  // Add test node and its two children. Children are visited in the order of decreasing
+  // data count, so that the more frequent child is stored close to its parent.
+  std::int32_t AddSubtree(ast::ConditionNode const* node, std::string threshold, unsigned flags,
+      ast::ASTNode const* left_child, ast::ASTNode const* right_child) {
+    std::int32_t const nid = AddTestNode(node->split_index_, std::move(threshold), flags);
+    if (left_child->data_count_ && right_child->data_count_
+        && *right_child->data_count_ > *left_child->data_count_) {
+      child_[nid * 2 + 1] = Flatten(right_child);
+      child_[nid * 2] = Flatten(left_child);
+    } else {
+      child_[nid * 2] = Flatten(left_child);
+      child_[nid * 2 + 1] = Flatten(right_child);
+    }
+    return nid;
+  }
+
+  std::int32_t Flatten(ast::ASTNode const* node) {
+    if (auto const* output_node = dynamic_cast<ast::OutputNode const*>(node)) {
+      return ~leaf_.AddLeaf(output_node);
+    } else if (auto const* num_cond = dynamic_cast<ast::NumericalConditionNode const*>(node)) {
+      return FlattenNumericalTest(num_cond);
+    } else {
+      auto const* cat_cond = dynamic_cast<ast::CategoricalConditionNode const*>(node);
+      TL2CGEN_CHECK(cat_cond) << "Unexpected node type in tree";
+      return FlattenCategoricalTest(cat_cond);
+    }
+  }
+
+  std::int32_t FlattenNumericalTest(ast::NumericalConditionNode const* node) {
+    auto const test = codegen::NormalizeNumericalTest<ThresholdType>(node, quantized_);
+    if (test.bypass) {
+      return Flatten(test.bypass);
+    }
+    unsigned flags = (test.default_left ? kDefaultLeft : 0);
+    if (test.equality_test) {
+      flags |= kEqualityTest;
+      has_equality_test_ = true;
+    }
+    std::int32_t const nid = AddSubtree(node, codegen::RenderThreshold(test, quantized_), flags,
+        test.left_child, test.right_child);
+    if (narrowable_) {
+      AddNarrowThreshold(node, nid);
+    }
+    return nid;
+  }
+
+  void AddNarrowThreshold(ast::NumericalConditionNode const* node, std::int32_t nid) {
+    auto const test = codegen::NormalizeNumericalTest<ThresholdType>(node, false, true);
+    if (std::isinf(test.threshold)) {
+      // Test that sends only missing values to the left. Rendered at the end, once the
+      // comparison is known.
+      narrow_threshold_[nid] = -std::numeric_limits<float>::infinity();
+      return;
+    }
+    auto const threshold = static_cast<double>(test.threshold);
+    if (std::fabs(threshold) > std::numeric_limits<float>::max()
+        || static_cast<double>(static_cast<float>(threshold)) != threshold) {
+      narrowable_ = false;
+      return;
+    }
+    if (!test.equality_test) {
+      if (num_narrow_comparison_ > 0 && test.inclusive != inclusive_) {
+        narrowable_ = false;
+        return;
+      }
+      inclusive_ = test.inclusive;
+      ++num_narrow_comparison_;
+    }
+    narrow_threshold_[nid] = static_cast<float>(threshold);
+  }
+
+  std::int32_t FlattenCategoricalTest(ast::CategoricalConditionNode const* node) {
+    std::vector<std::uint64_t> const bitmap = codegen::GetCategoricalBitmap(node->category_list_);
+    bool const all_zeros
+        = std::all_of(bitmap.begin(), bitmap.end(), [](std::uint64_t e) { return e == 0; });
+    if (all_zeros) {
+      // Empty category list: always go to the right child
+      return Flatten(node->children_[1]);
+    }
+    has_categorical_ = true;
+    unsigned const flags = (node->default_left_ ? kDefaultLeft : 0) | kCategorical
+                           | (node->category_list_right_child_ ? kCategoryListRightChild : 0);
+    std::int32_t const nid
+        = AddSubtree(node, "0", flags, node->children_[0], node->children_[1]);
+    cat_begin_[nid] = static_cast<std::int32_t>(cat_bitmap_.size());
+    cat_len_[nid] = static_cast<std::int32_t>(bitmap.size());
+    cat_bitmap_.insert(cat_bitmap_.end(), bitmap.begin(), bitmap.end());
+    return nid;
+  }
+
+  std::vector<float> narrow_threshold_;  // Thresholds as float32; see GetNarrowThresholds()
+  std::size_t num_narrow_comparison_{0};  // Number of narrowed (x < t) or (x <= t) tests
+};
+
+}  // anonymous namespace
+
+namespace tl2cgen::compiler::detail::codegen {
+
+void HandleArrayLayoutNode(ast::ArrayLayoutNode const* node, CodeCollection& gencode) {
+  auto const threshold_ctype_str = GetThresholdCType(node);
+  auto const leaf_output_ctype_str = GetLeafOutputCType(node);
+  bool const quantized = IsInputQuantized(node);
+  std::string const array_function_name
+      = fmt::format(array_function_name_template, "layout_id"_a = node->layout_id_);
+  std::string const array_function_signature = fmt::format(array_function_signature_template,
+      "array_function_name"_a = array_function_name,
+      "leaf_output_ctype"_a = leaf_output_ctype_str);
+
+  std::string array_source = std::visit(
+      [&](auto&& meta) {
+        using TypeMetaT = std::remove_const_t<std::remove_reference_t<decltype(meta)>>;
+        using ThresholdT = typename TypeMetaT::threshold_type;
+        using LeafOutputT = typename TypeMetaT::leaf_output_type;
+        ArrayLayout<ThresholdT, LeafOutputT> layout(*node->meta_, quantized);
+        for (ast::ASTNode const* tree_head : node->children_) {
+          layout.AddTree(tree_head);
+        }
+
+        std::string const value_field = (quantized ? "qvalue" : "fvalue");
+        std::string categorical_arrays, categorical_test, equality_test;
+        if (layout.has_categorical_) {
+          categorical_arrays = fmt::format(categorical_arrays_template,
+              "array_cat_begin"_a = RenderArray(layout.cat_begin_),
+              "array_cat_len"_a = RenderArray(layout.cat_len_),
+              "array_cat_bitmap"_a = RenderArray(layout.cat_bitmap_));
+          categorical_test = fmt::format(categorical_test_template,
+              "threshold_ctype"_a = threshold_ctype_str,
+              "fabs"_a = (threshold_ctype_str == "float" ? "fabsf" : "fabs"));
+        }
+        if (layout.has_equality_test_) {
+          equality_test = fmt::format(equality_test_template, "value_field"_a = value_field);
+        }
+
+        std::string simd_source;
+        if (node->simd_) {
+          TL2CGEN_CHECK(!quantized && !layout.has_categorical_ && !layout.has_equality_test_);
+          std::string avx2_init_acc, avx2_accumulate, avx2_store_acc;
+          std::string avx512_init_acc, avx512_accumulate, avx512_store_acc;
+          RenderSIMDAccumulation(
+              layout.leaf_, false, avx2_init_acc, avx2_accumulate, avx2_store_acc);
+          RenderSIMDAccumulation(
+              layout.leaf_, true, avx512_init_acc, avx512_accumulate, avx512_store_acc);
+          simd_source = fmt::format(simd_source_template,
+              "avx2_function_signature"_a = fmt::format(simd_function_signature_template,
+                  "array_function_name"_a = array_function_name, "isa"_a = "avx2"),
+              "avx512_function_signature"_a = fmt::format(simd_function_signature_template,
+                  "array_function_name"_a = array_function_name, "isa"_a = "avx512"),
+              "num_tree"_a = node->children_.size(), "avx2_init_acc"_a = avx2_init_acc,
+              "avx2_accumulate"_a = avx2_accumulate, "avx2_store_acc"_a = avx2_store_acc,
+              "avx512_init_acc"_a = avx512_init_acc, "avx512_accumulate"_a = avx512_accumulate,
+              "avx512_store_acc"_a = avx512_store_acc);
+        }
+
+        std::string interleaved_loop;
+        int const num_interleaved = node->num_interleaved_tree_;
+        if (num_interleaved > 1) {
+          std::string init_cursors, all_cursors, advance_cursors, accumulate_leaves;
+          for (int j = 0; j < num_interleaved; ++j) {
+            std::string const separator = (j > 0 ? "\n" : "");
+            init_cursors += fmt::format("{}int nid{} = tree_root[t + {}];", separator, j, j);
+            all_cursors += fmt::format("{}nid{}", (j > 0 ? " & " : ""), j);
+            advance_cursors += fmt::format(
+                "{0}if (nid{1} >= 0) {{\n  nid{1} = next_node(data, nid{1});\n}}", separator, j);
+            if (layout.leaf_.HasUniformOutOffset()) {
+              accumulate_leaves += separator
+                                   + layout.leaf_.RenderAccumulation(fmt::format("~nid{}", j), 0);
+            } else {
+              // The accumulation looks up out_offset[] with the variable tree_id
+              accumulate_leaves += fmt::format("{}{{\n  const int tree_id = t + {};\n{}\n}}",
+                  separator, j, layout.leaf_.RenderAccumulation(fmt::format("~nid{}", j), 2));
+            }
+          }
+          interleaved_loop = fmt::format(interleaved_loop_template,
+              "num_interleaved"_a = num_interleaved, "num_tree"_a = node->children_.size(),
+              "init_cursors"_a = IndentMultiLineString(init_cursors, 4),
+              "all_cursors"_a = all_cursors,
+              "advance_cursors"_a = IndentMultiLineString(advance_cursors, 6),
+              "accumulate_leaves"_a = IndentMultiLineString(accumulate_leaves, 4));
+        }
+
+        bool const narrow = layout.narrowable_;
+        if (node->meta_->narrow_thresholds_) {
+          TL2CGEN_LOG(INFO) << "Thresholds of array layout " << node->layout_id_
+                            << (narrow ? " stored as float32"
+                                       : " kept: not all of them are exact in float32");
+        }
+        return fmt::format(array_source_template,
+            "array_split_index"_a = RenderArray(layout.split_index_),
+            "threshold_array_ctype"_a = (quantized ? "int"
+                                         : narrow  ? "float"
+                                                   : threshold_ctype_str),
+            "array_threshold"_a
+            = (narrow ? RenderArray(layout.GetNarrowThresholds()) : RenderArray(layout.threshold_)),
+            "compare_op"_a = (narrow && layout.inclusive_ ? "<=" : "<"),
+            "array_child"_a = RenderArray(layout.child_),
+            "node_flags_ctype"_a = (node->simd_ ? "int32_t" : "unsigned char"),
+            "array_node_flags"_a = RenderArray(layout.node_flags_),
+            "categorical_arrays"_a = categorical_arrays,
+            "array_tree_root"_a = RenderArray(layout.tree_root_),
+            "leaf_arrays"_a = layout.leaf_.RenderArrays(leaf_output_ctype_str),
+            "array_function_signature"_a = array_function_signature,
+            "interleaved_loop"_a = interleaved_loop,
+            "remainder_begin"_a = (num_interleaved > 1 ? "t" : "0"),
+            "num_tree"_a = node->children_.size(), "categorical_test"_a = categorical_test,
+            "equality_test"_a = equality_test, "value_field"_a = value_field,
+            "accumulate_leaf"_a = layout.leaf_.RenderAccumulation("~nid", 4))
+               + simd_source;
+      },
+      node->meta_->type_meta_);
+
+  auto current_file = gencode.GetCurrentSourceFile();
+  gencode.PushFragment(fmt::format(
+      "{array_function_name}(data, result);", "array_function_name"_a = array_function_name));
+  gencode.SwitchToSourceFile("header.h");
+  gencode.PushFragment(fmt::format("{};", array_function_signature));
+  if (node->simd_) {
+    for (char const* isa : {"avx2", "avx512"}) {
+      gencode.PushFragment(fmt::format("{};",
+          fmt::format(simd_function_signature_template,
+              "array_function_name"_a = array_function_name, "isa"_a = isa)));
+    }
+  }
+  gencode.SwitchToSourceFile(fmt::format("array{layout_id}.c", "layout_id"_a = node->layout_id_));
+  gencode.PushFragment(array_source);
+  gencode.SwitchToSourceFile(current_file);  // Switch back context
+}
+
+}  // namespace tl2cgen::compiler::detail::codegen
@@ -0,0 +1,151 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file branchless_subtree_node.cc
+ * \brief Convert BranchlessSubtreeNode in AST into C code
+ * \author Hyunsu Cho
+ */
+
+#include <fmt/format.h>
+#include <tl2cgen/detail/compiler/ast/ast.h>
+#include <tl2cgen/detail/compiler/codegen/codegen.h>
+#include <tl2cgen/detail/compiler/codegen/table_util.h>
+#include <tl2cgen/logging.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+using namespace fmt::literals;
+
+namespace {
+
+namespace ast = tl2cgen::compiler::detail::ast;
+namespace codegen = tl2cgen::compiler::detail::codegen;
+
+// The subtree is stored as a complete binary tree, with the tests in breadth-first order: the
+// children of test i are at 2*i+1 (left) and 2*i+2 (right). Each level moves to the right child
+// if the feature value is missing and default_right[i] is set, or if the feature value is not
+// less than threshold[i]. No branch is taken until a leaf is reached.
+char const* const branchless_subtree_template =
+    R"TL2CGENTEMPLATE({{
+  /* Subtree with {depth} level(s) of tests, evaluated without branches */
+  static const int32_t split_index[] = {{
+{array_split_index}
+  }};
+  static const {threshold_array_ctype} threshold[] = {{
+{array_threshold}
+  }};
+  static const unsigned char default_right[] = {{
+{array_default_right}
+  }};
+{leaf_arrays}
+  int idx = 0;
+  for (int depth = 0; depth < {depth}; ++depth) {{
+    const int32_t fid = split_index[idx];
+    const int is_missing = {is_missing};
+    const int go_right = (is_missing & default_right[idx])
+                         | (!is_missing & !({value} < threshold[idx]));
+    idx = 2 * idx + 1 + go_right;
+  }}
+{accumulate_leaf}
+}})TL2CGENTEMPLATE";
+
+// Complete binary tree holding a subtree. Leaves that sit above the bottom level are replicated,
+// so that all paths have the same length.
+template <typename ThresholdType, typename LeafOutputType>
+class CompleteTree {
+ public:
+  CompleteTree(ast::ModelMeta const& meta, int depth, bool quantized)
+      : depth_(depth),
+        quantized_(quantized),
+        leaf_(meta),
+        split_index_((std::size_t{1} << depth) - 1, 0),
+        threshold_((std::size_t{1} << depth) - 1, "0"),
+        default_right_((std::size_t{1} << depth) - 1, 0) {
+    leaf_.AddTree();
+  }
+
+  // Fill in the test at position pos, which lies at the given level. The leaves are visited from
+  // left to right, so leaf IDs in leaf_ coincide with positions in the bottom level.
+  void Fill(ast::ASTNode const* node, int level, std::size_t pos) {
+    if (level == depth_) {
+      auto const* output_node = dynamic_cast<ast::OutputNode const*>(node);
+      TL2CGEN_CHECK(output_node) << "Subtree is deeper than expected";
+      leaf_.AddLeaf(output_node);
+      return;
+    }
+    if (dynamic_cast<ast::OutputNode const*>(node)) {
+      // Both children of the placeholder test lead to the same leaf, so its outcome does not
+      // matter.
+      Fill(node, level + 1, 2 * pos + 1);
+      Fill(node, level + 1, 2 * pos + 2);
+      return;
+    }
+    auto const* num_cond = dynamic_cast<ast::NumericalConditionNode const*>(node);
+    TL2CGEN_CHECK(num_cond) << "Unexpected node type in branchless subtree";
+    auto const test = codegen::NormalizeNumericalTest<ThresholdType>(num_cond, quantized_);
+    TL2CGEN_CHECK(!test.equality_test);
+    if (test.bypass) {
+      Fill(test.bypass, level, pos);
+      return;
+    }
+    split_index_[pos] = static_cast<std::int32_t>(num_cond->split_index_);
+    threshold_[pos] = codegen::RenderThreshold(test, quantized_);
+    default_right_[pos] = (test.default_left ? 0 : 1);
+    Fill(test.left_child, level + 1, 2 * pos + 1);
+    Fill(test.right_child, level + 1, 2 * pos + 2);
+  }
+
+  int depth_;
+  bool quantized_;
+  codegen::LeafOutputTable<LeafOutputType> leaf_;
+  std::vector<std::int32_t> split_index_;
+  std::vector<std::string> threshold_;
+  std::vector<int> default_right_;
+};
+
+}  // anonymous namespace
+
+namespace tl2cgen::compiler::detail::codegen {
+
+void HandleBranchlessSubtreeNode(ast::BranchlessSubtreeNode const* node, CodeCollection& gencode) {
+  TL2CGEN_CHECK_EQ(node->children_.size(), 1);
+  TL2CGEN_CHECK_GT(node->depth_, 0);
+  bool const quantized = IsInputQuantized(node);
+  int const bin_width = GetQuantizedBinWidth(node);
+  std::string const threshold_ctype_str = GetThresholdCType(node);
+  std::string const leaf_output_ctype_str = GetLeafOutputCType(node);
+
+  std::string const code = std::visit(
+      [&](auto&& meta) {
+        using TypeMetaT = std::remove_const_t<std::remove_reference_t<decltype(meta)>>;
+        using ThresholdT = typename TypeMetaT::threshold_type;
+        using LeafOutputT = typename TypeMetaT::leaf_output_type;
+        CompleteTree<ThresholdT, LeafOutputT> tree(*node->meta_, node->depth_, quantized);
+        tree.Fill(node->children_[0], 0, 0);
+        std::size_t const num_test = tree.split_index_.size();
+        return fmt::format(branchless_subtree_template, "depth"_a = node->depth_,
+            "array_split_index"_a = IndentMultiLineString(RenderArray(tree.split_index_), 2),
+            "threshold_array_ctype"_a = (quantized ? "int" : threshold_ctype_str),
+            "array_threshold"_a = IndentMultiLineString(RenderArray(tree.threshold_), 2),
+            "array_default_right"_a = IndentMultiLineString(RenderArray(tree.default_right_), 2),
+            "leaf_arrays"_a
+            = IndentMultiLineString(tree.leaf_.RenderArrays(leaf_output_ctype_str), 2),
+            "value"_a = (bin_width > 0 ? "bin[fid]"
+                         : quantized   ? "data[fid].qvalue"
+                                       : "data[fid].fvalue"),
+            "is_missing"_a = (gencode.AssumeNoMissing() ? "0"
+                              : bin_width > 0
+                                  ? fmt::format("(bin[fid] == INT{}_MIN)", bin_width)
+                                  : "(data[fid].missing == -1)"),
+            "accumulate_leaf"_a
+            = tree.leaf_.RenderAccumulation(fmt::format("(idx - {})", num_test), 2));
+      },
+      node->meta_->type_meta_);
+  gencode.PushFragment(code);
+}
+
+}  // namespace tl2cgen::compiler::detail::codegen
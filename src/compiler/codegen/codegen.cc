@@ -5,11 +5,13 @@
  * \author Hyunsu Cho
  */
 
+#include <fmt/format.h>
 #include <rapidjson/ostreamwrapper.h>
 #include <rapidjson/prettywriter.h>
 #include <tl2cgen/detail/compiler/ast/ast.h>
 #include <tl2cgen/detail/compiler/codegen/codegen.h>
 #include <tl2cgen/detail/compiler/codegen/format_util.h>
+#include <tl2cgen/detail/compiler/codegen/table_util.h>
 #include <tl2cgen/detail/filesystem.h>
 #include <tl2cgen/logging.h>
 #include <tl2cgen/predictor_types.h>
@@ -19,6 +21,8 @@
 #include <type_traits>
 #include <variant>
 
+using namespace fmt::literals;
+
 namespace {
 
 template <typename T>
@@ -33,6 +37,24 @@ std::string GetCType() {
   }
 }
 
+// The local array result[] shadows the argument result[] of the enclosing function. Since the
+// address of the local array is not taken, the C compiler is free to keep it in registers, rather
+// than loading and storing an element of result[] at every leaf.
+char const* const local_accumulator_start_template =
+    R"TL2CGENTEMPLATE({leaf_output_type}* const out = result;
+{{
+  /* Accumulate the tree outputs in local variables, and write them to out[] at the end */
+  {leaf_output_type} result[N_TARGET * MAX_N_CLASS];
+  for (int i = 0; i < N_TARGET * MAX_N_CLASS; ++i) {{
+    result[i] = out[i];
+  }})TL2CGENTEMPLATE";
+
+char const* const local_accumulator_end_template =
+    R"TL2CGENTEMPLATE(  for (int i = 0; i < N_TARGET * MAX_N_CLASS; ++i) {
+    out[i] = result[i];
+  }
+})TL2CGENTEMPLATE";
+
 }  // anonymous namespace
 
 namespace tl2cgen::compiler::detail::codegen {
@@ -44,6 +66,13 @@ void GenerateCodeFromAST(ast::ASTNode const* node, CodeCollection& gencode) {
   ast::OutputNode const* t4;
   ast::TranslationUnitNode const* t5;
   ast::QuantizerNode const* t6;
+  ast::ArrayLayoutNode const* t7;
+  ast::QuickScorerNode const* t8;
+  ast::BranchlessSubtreeNode const* t9;
+  ast::OutlinedSubtreeNode const* t10;
+  ast::TreeFunctionNode const* t11;
+  ast::SharedSubtreeNode const* t12;
+  ast::MissingFastPathNode const* t13;
   if ((t1 = dynamic_cast<ast::MainNode const*>(node))) {
     HandleMainNode(t1, gencode);
   } else if ((t2 = dynamic_cast<ast::FunctionNode const*>(node))) {
@@ -56,6 +85,20 @@ void GenerateCodeFromAST(ast::ASTNode const* node, CodeCollection& gencode) {
     HandleTranslationUnitNode(t5, gencode);
   } else if ((t6 = dynamic_cast<ast::QuantizerNode const*>(node))) {
     HandleQuantizerNode(t6, gencode);
+  } else if ((t7 = dynamic_cast<ast::ArrayLayoutNode const*>(node))) {
+    HandleArrayLayoutNode(t7, gencode);
+  } else if ((t8 = dynamic_cast<ast::QuickScorerNode const*>(node))) {
+    HandleQuickScorerNode(t8, gencode);
+  } else if ((t9 = dynamic_cast<ast::BranchlessSubtreeNode const*>(node))) {
+    HandleBranchlessSubtreeNode(t9, gencode);
+  } else if ((t10 = dynamic_cast<ast::OutlinedSubtreeNode const*>(node))) {
+    HandleOutlinedSubtreeNode(t10, gencode);
+  } else if ((t11 = dynamic_cast<ast::TreeFunctionNode const*>(node))) {
+    HandleTreeFunctionNode(t11, gencode);
+  } else if ((t12 = dynamic_cast<ast::SharedSubtreeNode const*>(node))) {
+    HandleSharedSubtreeNode(t12, gencode);
+  } else if ((t13 = dynamic_cast<ast::MissingFastPathNode const*>(node))) {
+    HandleMissingFastPathNode(t13, gencode);
   } else {
     TL2CGEN_LOG(FATAL) << "Unrecognized AST node type";
   }
@@ -150,6 +193,51 @@ std::string GetLeafOutputCType(ast::ASTNode const* node) {
   return GetLeafOutputCType(*node->meta_);
 }
 
+std::string GetTreeFunctionParams(ast::ASTNode const* node) {
+  int const bin_width = GetQuantizedBinWidth(node);
+  if (bin_width > 0) {
+    return fmt::format(
+        "union Entry* data, const int{bin_width}_t* bin, {leaf_output_type}* RESTRICT result",
+        "bin_width"_a = bin_width, "leaf_output_type"_a = GetLeafOutputCType(node));
+  }
+  return fmt::format("union Entry* data, {leaf_output_type}* RESTRICT result",
+      "leaf_output_type"_a = GetLeafOutputCType(node));
+}
+
+std::string GetTreeFunctionArgs(ast::ASTNode const* node) {
+  return (GetQuantizedBinWidth(node) > 0) ? "data, bin, result" : "data, result";
+}
+
+bool HasInlineOutput(ast::ASTNode const* node) {
+  if (dynamic_cast<ast::OutputNode const*>(node)) {
+    return true;
+  }
+  // These nodes render their leaves in a separate function, and leave only a call behind
+  if (dynamic_cast<ast::TranslationUnitNode const*>(node)
+      || dynamic_cast<ast::TreeFunctionNode const*>(node)
+      || dynamic_cast<ast::OutlinedSubtreeNode const*>(node)
+      || dynamic_cast<ast::SharedSubtreeNode const*>(node)
+      || dynamic_cast<ast::ArrayLayoutNode const*>(node)
+      || dynamic_cast<ast::QuickScorerNode const*>(node)) {
+    return false;
+  }
+  for (ast::ASTNode const* child : node->children_) {
+    if (HasInlineOutput(child)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string RenderLocalAccumulatorStart(ast::ASTNode const* node) {
+  return fmt::format(local_accumulator_start_template,
+      "leaf_output_type"_a = GetLeafOutputCType(node));
+}
+
+std::string RenderLocalAccumulatorEnd() {
+  return local_accumulator_end_template;
+}
+
 void SourceFile::ChangeIndent(int n_tabs_delta) {
   current_indent_ += n_tabs_delta * 2;  // 1 tab = 2 spaces for now
   TL2CGEN_CHECK_GE(current_indent_, 0);
@@ -9,12 +9,15 @@
 #include <tl2cgen/detail/compiler/ast/ast.h>
 #include <tl2cgen/detail/compiler/codegen/codegen.h>
 #include <tl2cgen/detail/compiler/codegen/format_util.h>
+#include <tl2cgen/detail/compiler/codegen/table_util.h>
 #include <tl2cgen/detail/operator_comp.h>
 #include <tl2cgen/logging.h>
 #include <treelite/enum/operator.h>
 
 #include <cstdint>
+#include <cstring>
 #include <string>
+#include <utility>
 
 using namespace fmt::literals;
 
@@ -23,26 +26,27 @@ namespace {
 namespace ast = tl2cgen::compiler::detail::ast;
 namespace codegen = tl2cgen::compiler::detail::codegen;
 
-std::string GetFabsCFunc(std::string const& threshold_type) {
-  if (threshold_type == "float") {
-    return "fabsf";
-  } else if (threshold_type == "double") {
-    return "fabs";
-  } else {
-    TL2CGEN_LOG(FATAL) << "Unrecognized type: " << threshold_type;
-    return "";
-  }
-}
-
 inline std::string ExtractNumericalCondition(ast::NumericalConditionNode const* node) {
   std::string const threshold_type = codegen::GetThresholdCType(node);
   std::string result;
   if (node->quantized_threshold_) {  // Quantized threshold
-    std::string lhs
-        = fmt::format("data[{split_index}].qvalue", "split_index"_a = node->split_index_);
+    std::string lhs = fmt::format((codegen::GetQuantizedBinWidth(node) > 0)
+                                      ? "bin[{split_index}]"
+                                      : "data[{split_index}].qvalue",
+        "split_index"_a = node->split_index_);
     result = fmt::format("{lhs} {opname} {threshold}", "lhs"_a = lhs,
         "opname"_a = treelite::OperatorToString(node->op_),
         "threshold"_a = *node->quantized_threshold_);
+  } else if (node->integer_compare_) {  // Compare bit patterns of float32 values
+    // The missing field overlaps with fvalue, so it holds the bit pattern of the feature value
+    float const threshold = std::get<float>(node->threshold_);
+    std::int32_t threshold_bits;
+    static_assert(sizeof(threshold_bits) == sizeof(threshold));
+    std::memcpy(&threshold_bits, &threshold, sizeof(threshold));
+    result = fmt::format("data[{split_index}].missing {opname} {threshold_bits} /* {threshold} */",
+        "split_index"_a = node->split_index_, "opname"_a = treelite::OperatorToString(node->op_),
+        "threshold_bits"_a = threshold_bits,
+        "threshold"_a = codegen::ToStringHighPrecision(threshold));
   } else {
     result = std::visit(
         [&](auto&& threshold) -> std::string {
@@ -67,28 +71,12 @@ inline std::string ExtractNumericalCondition(ast::NumericalConditionNode const*
   return result;
 }
 
-inline std::vector<std::uint64_t> GetCategoricalBitmap(
-    std::vector<std::uint32_t> const& category_list) {
-  std::size_t const num_categories = category_list.size();
-  if (num_categories == 0) {
-    return std::vector<std::uint64_t>{0};
-  }
-  std::uint32_t const max_category = category_list[num_categories - 1];
-  std::vector<std::uint64_t> bitmap((max_category + 1 + 63) / 64, 0);
-  for (std::uint32_t cat : category_list) {
-    std::size_t const idx = cat / 64;
-    std::uint32_t const offset = cat % 64;
-    bitmap[idx] |= (static_cast<std::uint64_t>(1) << offset);
-  }
-  return bitmap;
-}
-
-inline std::string ExtractCategoricalCondition(ast::CategoricalConditionNode const* node) {
+inline std::string ExtractCategoricalCondition(
+    ast::CategoricalConditionNode const* node, bool assume_no_missing) {
   std::string const threshold_ctype_str = codegen::GetThresholdCType(node);
-  std::string const fabs = GetFabsCFunc(threshold_ctype_str);
 
   std::string result;
-  std::vector<std::uint64_t> bitmap = GetCategoricalBitmap(node->category_list_);
+  std::vector<std::uint64_t> bitmap = codegen::GetCategoricalBitmap(node->category_list_);
   TL2CGEN_CHECK_GE(bitmap.size(), 1);
   bool all_zeros = true;
   for (std::uint64_t e : bitmap) {
@@ -97,32 +85,31 @@ inline std::string ExtractCategoricalCondition(ast::CategoricalConditionNode con
   if (all_zeros) {
     result = "0";
   } else {
-    std::ostringstream oss;
-    std::string const right_categories_flag = (node->category_list_right_child_ ? "!" : "");
-    if (node->default_left_) {
-      oss << fmt::format(
-          "data[{split_index}].missing == -1 || {right_categories_flag}("
-          "(tmp = (unsigned int)(data[{split_index}].fvalue) ), ",
-          "split_index"_a = node->split_index_, "right_categories_flag"_a = right_categories_flag);
+    std::string lookup;
+    if (node->bitmap_offset_) {
+      lookup = fmt::format("(categorical_bitmap[{offset} + tmp / 64] >> (tmp % 64)) & 1",
+          "offset"_a = *node->bitmap_offset_);
     } else {
-      oss << fmt::format(
-          "data[{split_index}].missing != -1 && {right_categories_flag}("
-          "(tmp = (unsigned int)(data[{split_index}].fvalue) ), ",
-          "split_index"_a = node->split_index_, "right_categories_flag"_a = right_categories_flag);
-    }
-
-    oss << fmt::format(
-        "((data[{split_index}].fvalue >= 0) && "
-        "({fabs}(data[{split_index}].fvalue) <= ({threshold_ctype})(1U << FLT_MANT_DIG)) && (",
-        "split_index"_a = node->split_index_, "threshold_ctype"_a = threshold_ctype_str,
-        "fabs"_a = fabs);
-    oss << "(tmp >= 0 && tmp < 64 && (( (uint64_t)" << bitmap[0] << "U >> tmp) & 1) )";
-    for (std::size_t i = 1; i < bitmap.size(); ++i) {
-      oss << " || (tmp >= " << (i * 64) << " && tmp < " << ((i + 1) * 64) << " && (( (uint64_t)"
-          << bitmap[i] << "U >> (tmp - " << (i * 64) << ") ) & 1) )";
+      TL2CGEN_CHECK_EQ(bitmap.size(), 1);
+      lookup = fmt::format("((uint64_t){bitmap}U >> tmp) & 1", "bitmap"_a = bitmap[0]);
     }
-    oss << ")))";
-    result = oss.str();
+    // The bounds check rejects negative values and values past the end of the bitmap, so that
+    // the cast to unsigned int is always well-defined.
+    char const* const na_check_template
+        = assume_no_missing     ? ""
+          : node->default_left_ ? "data[{split_index}].missing == -1 || "
+                                : "data[{split_index}].missing != -1 && ";
+    char const* const categorical_condition_template
+        = "{na_check}{right_categories_flag}("
+          "data[{split_index}].fvalue >= 0 && "
+          "data[{split_index}].fvalue < ({threshold_ctype}){num_category_bound} && "
+          "(tmp = (unsigned int)(data[{split_index}].fvalue), {lookup}))";
+    result = fmt::format(categorical_condition_template,
+        "na_check"_a = fmt::format(na_check_template, "split_index"_a = node->split_index_),
+        "split_index"_a = node->split_index_,
+        "right_categories_flag"_a = (node->category_list_right_child_ ? "!" : ""),
+        "threshold_ctype"_a = threshold_ctype_str, "num_category_bound"_a = bitmap.size() * 64,
+        "lookup"_a = lookup);
   }
   return result;
 }
@@ -131,37 +118,72 @@ inline std::string ExtractCategoricalCondition(ast::CategoricalConditionNode con
 
 namespace tl2cgen::compiler::detail::codegen {
 
+std::vector<std::uint64_t> GetCategoricalBitmap(std::vector<std::uint32_t> const& category_list) {
+  std::size_t const num_categories = category_list.size();
+  if (num_categories == 0) {
+    return std::vector<std::uint64_t>{0};
+  }
+  std::uint32_t const max_category = category_list[num_categories - 1];
+  std::vector<std::uint64_t> bitmap((max_category + 1 + 63) / 64, 0);
+  for (std::uint32_t cat : category_list) {
+    std::size_t const idx = cat / 64;
+    std::uint32_t const offset = cat % 64;
+    bitmap[idx] |= (static_cast<std::uint64_t>(1) << offset);
+  }
+  return bitmap;
+}
+
 void HandleConditionNode(ast::ConditionNode const* node, CodeCollection& gencode) {
   ast::NumericalConditionNode const* t;
   std::string condition_with_na_check;
   if ((t = dynamic_cast<ast::NumericalConditionNode const*>(node))) {
     /* Numerical split */
     std::string condition = ExtractNumericalCondition(t);
+    // A quantized value held in the compact bin[] buffer is missing if it equals the minimum
+    // value of its type
+    int const bin_width = GetQuantizedBinWidth(node);
+    std::string const is_present
+        = (t->quantized_threshold_ && bin_width > 0)
+              ? fmt::format("bin[{split_index}] != INT{bin_width}_MIN",
+                  "split_index"_a = node->split_index_, "bin_width"_a = bin_width)
+              : fmt::format(
+                  "data[{split_index}].missing != -1", "split_index"_a = node->split_index_);
+    // On the fast path, no feature value is missing, so the test alone decides the direction
     char const* condition_with_na_check_template
-        = (node->default_left_) ? "!(data[{split_index}].missing != -1) || ({condition})"
-                                : " (data[{split_index}].missing != -1) && ({condition})";
+        = gencode.AssumeNoMissing() ? "{condition}"
+          : (node->default_left_)   ? "!({is_present}) || ({condition})"
+                                    : " ({is_present}) && ({condition})";
     condition_with_na_check = fmt::format(condition_with_na_check_template,
-        "split_index"_a = node->split_index_, "condition"_a = condition);
+        "is_present"_a = is_present, "condition"_a = condition);
   } else { /* Categorical split */
     auto const* t2 = dynamic_cast<ast::CategoricalConditionNode const*>(node);
     TL2CGEN_CHECK(t2);
-    condition_with_na_check = ExtractCategoricalCondition(t2);
+    condition_with_na_check = ExtractCategoricalCondition(t2, gencode.AssumeNoMissing());
   }
+  TL2CGEN_CHECK_EQ(node->children_.size(), 2);
+  ast::ASTNode const* then_child = node->children_[0];
+  ast::ASTNode const* else_child = node->children_[1];
   if (node->children_[0]->data_count_ && node->children_[1]->data_count_) {
     std::uint64_t const left_freq = *node->children_[0]->data_count_;
     std::uint64_t const right_freq = *node->children_[1]->data_count_;
-    condition_with_na_check = fmt::format(" {keyword}( {condition} ) ",
-        "keyword"_a = ((left_freq > right_freq) ? "LIKELY" : "UNLIKELY"),
-        "condition"_a = condition_with_na_check);
+    if (right_freq > left_freq) {
+      // Invert the test, so that the more frequently visited child becomes the fall-through
+      // path, i.e. the code placed right after the test.
+      condition_with_na_check = fmt::format("!({})", condition_with_na_check);
+      std::swap(then_child, else_child);
+    }
+    if (left_freq != right_freq) {
+      condition_with_na_check
+          = fmt::format(" LIKELY( {condition} ) ", "condition"_a = condition_with_na_check);
+    }
   }
   gencode.PushFragment(fmt::format("if ({}) {{\n", condition_with_na_check));
   gencode.ChangeIndent(1);
-  TL2CGEN_CHECK_EQ(node->children_.size(), 2);
-  GenerateCodeFromAST(node->children_[0], gencode);
+  GenerateCodeFromAST(then_child, gencode);
   gencode.ChangeIndent(-1);
   gencode.PushFragment("} else {");
   gencode.ChangeIndent(1);
-  GenerateCodeFromAST(node->children_[1], gencode);
+  GenerateCodeFromAST(else_child, gencode);
   gencode.ChangeIndent(-1);
   gencode.PushFragment("}");
 }
@@ -12,8 +12,11 @@
 #include <tl2cgen/logging.h>
 
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <string>
 #include <variant>
 #include <vector>
 
@@ -27,6 +30,8 @@ using namespace fmt::literals;
 
 namespace {
 
+namespace ast = tl2cgen::compiler::detail::ast;
+
 std::string RenderIsCategoricalArray(std::vector<bool> const& is_categorical) {
   if (is_categorical.empty()) {
     return "";
@@ -38,6 +43,52 @@ std::string RenderIsCategoricalArray(std::vector<bool> const& is_categorical) {
   return fmt::format("const unsigned char is_categorical[] = {{{}}};", formatter.str());
 }
 
+std::string RenderCategoricalBitmapArray(std::vector<std::uint64_t> const& categorical_bitmap) {
+  if (categorical_bitmap.empty()) {
+    return "";
+  }
+  tl2cgen::compiler::detail::codegen::ArrayFormatter formatter(80, 2);
+  for (std::uint64_t e : categorical_bitmap) {
+    formatter << fmt::format("{}U", e);
+  }
+  return fmt::format("const uint64_t categorical_bitmap[] = {{{}}};", formatter.str());
+}
+
+// Find the node that holds the fast path for rows without missing values, if any
+ast::MissingFastPathNode const* FindMissingFastPath(ast::ASTNode const* node) {
+  for (; node->children_.size() == 1; node = node->children_[0]) {
+    if (auto const* t = dynamic_cast<ast::MissingFastPathNode const*>(node->children_[0])) {
+      return t;
+    }
+  }
+  return nullptr;
+}
+
+char const* const missing_fast_path_template =
+    R"TL2CGENTEMPLATE(
+static const int32_t used_feature[] = {{{array_used_feature}}};
+
+static inline int row_has_missing(const union Entry* data) {{
+  for (size_t i = 0; i < sizeof(used_feature) / sizeof(used_feature[0]); ++i) {{
+    if (data[used_feature[i]].missing == -1) {{
+      return 1;
+    }}
+  }}
+  return 0;
+}}
+)TL2CGENTEMPLATE";
+
+std::string RenderMissingFastPath(ast::MissingFastPathNode const* node) {
+  if (!node) {
+    return "";
+  }
+  tl2cgen::compiler::detail::codegen::ArrayFormatter formatter(80, 2);
+  for (std::uint32_t e : node->feature_list_) {
+    formatter << e;
+  }
+  return fmt::format(missing_fast_path_template, "array_used_feature"_a = formatter.str());
+}
+
 std::string RenderNumClassArray(std::vector<std::int32_t> const& num_class) {
   tl2cgen::compiler::detail::codegen::ArrayFormatter formatter(80, 2);
   for (std::int32_t e : num_class) {
@@ -46,6 +97,133 @@ std::string RenderNumClassArray(std::vector<std::int32_t> const& num_class) {
   return fmt::format("static const int32_t num_class[] = {{{}}};", formatter.str());
 }
 
+// Find all array layouts for which SIMD kernels are generated
+void FindSIMDLayouts(ast::ASTNode const* node, std::vector<int>& layout_ids) {
+  if (auto const* layout = dynamic_cast<ast::ArrayLayoutNode const*>(node)) {
+    if (layout->simd_) {
+      layout_ids.push_back(layout->layout_id_);
+    }
+    return;
+  }
+  for (ast::ASTNode const* child : node->children_) {
+    FindSIMDLayouts(child, layout_ids);
+  }
+}
+
+// Find all trees that are rendered as separate functions
+void FindTreeFunctions(
+    ast::ASTNode const* node, std::vector<ast::TreeFunctionNode const*>& tree_list) {
+  if (auto const* tree = dynamic_cast<ast::TreeFunctionNode const*>(node)) {
+    tree_list.push_back(tree);
+    return;
+  }
+  for (ast::ASTNode const* child : node->children_) {
+    FindTreeFunctions(child, tree_list);
+  }
+}
+
+// Find the first leaf of a tree, to determine which output the tree contributes to
+ast::OutputNode const* FindFirstLeaf(ast::ASTNode const* node) {
+  if (auto const* leaf = dynamic_cast<ast::OutputNode const*>(node)) {
+    return leaf;
+  }
+  if (auto const* shared = dynamic_cast<ast::SharedSubtreeNode const*>(node);
+      shared && shared->definition_) {
+    return FindFirstLeaf(shared->definition_);
+  }
+  for (ast::ASTNode const* child : node->children_) {
+    if (auto const* leaf = FindFirstLeaf(child)) {
+      return leaf;
+    }
+  }
+  return nullptr;
+}
+
+// num_tree_before[t * num_output + i]: Number of trees among the first t trees that contribute
+// to output i. Used to average the outputs over a range of trees.
+std::string RenderNumTreeBeforeArray(ast::ModelMeta const& meta,
+    std::vector<ast::TreeFunctionNode const*> const& tree_list, std::int32_t max_num_class) {
+  std::size_t const num_output = static_cast<std::size_t>(meta.num_target_) * max_num_class;
+  std::vector<std::int32_t> count(num_output, 0);
+  tl2cgen::compiler::detail::codegen::ArrayFormatter formatter(80, 2);
+  for (std::size_t tree_id = 0; tree_id <= tree_list.size(); ++tree_id) {
+    for (std::int32_t e : count) {
+      formatter << e;
+    }
+    if (tree_id == tree_list.size()) {
+      break;
+    }
+    ast::OutputNode const* leaf = FindFirstLeaf(tree_list[tree_id]);
+    TL2CGEN_CHECK(leaf);
+    for (std::int32_t target_id = 0; target_id < meta.num_target_; ++target_id) {
+      for (std::int32_t class_id = 0; class_id < meta.num_class_[target_id]; ++class_id) {
+        if ((leaf->target_id_ < 0 || leaf->target_id_ == target_id)
+            && (leaf->class_id_ < 0 || leaf->class_id_ == class_id)) {
+          ++count[target_id * max_num_class + class_id];
+        }
+      }
+    }
+  }
+  return fmt::format("static const int32_t num_tree_before[] = {{\n{}\n}};\n", formatter.str());
+}
+
+// Find the smallest and the largest leaf output of a tree
+void FindLeafOutputRange(ast::ASTNode const* node, double& min_output, double& max_output) {
+  if (auto const* leaf = dynamic_cast<ast::OutputNode const*>(node)) {
+    std::visit(
+        [&](auto&& leaf_output_concrete) {
+          for (auto e : leaf_output_concrete) {
+            min_output = std::min(min_output, static_cast<double>(e));
+            max_output = std::max(max_output, static_cast<double>(e));
+          }
+        },
+        leaf->leaf_output_);
+    return;
+  }
+  if (auto const* shared = dynamic_cast<ast::SharedSubtreeNode const*>(node);
+      shared && shared->definition_) {
+    FindLeafOutputRange(shared->definition_, min_output, max_output);
+    return;
+  }
+  for (ast::ASTNode const* child : node->children_) {
+    FindLeafOutputRange(child, min_output, max_output);
+  }
+}
+
+// remaining_min[t], remaining_max[t]: Bounds on the total output of the trees t, t+1, ...
+// remaining_abs[t]: Bound on the magnitude of the partial sums of the outputs of these trees
+// Returns an empty string if any of the bounds is not finite.
+std::string RenderRemainingOutputArrays(
+    std::vector<ast::TreeFunctionNode const*> const& tree_list) {
+  std::size_t const num_tree = tree_list.size();
+  std::vector<double> remaining_min(num_tree + 1, 0.0);
+  std::vector<double> remaining_max(num_tree + 1, 0.0);
+  std::vector<double> remaining_abs(num_tree + 1, 0.0);
+  for (std::size_t i = num_tree; i-- > 0;) {
+    double min_output = std::numeric_limits<double>::infinity();
+    double max_output = -std::numeric_limits<double>::infinity();
+    FindLeafOutputRange(tree_list[i], min_output, max_output);
+    TL2CGEN_CHECK_LE(min_output, max_output) << "Tree " << i << " has no leaf output";
+    remaining_min[i] = remaining_min[i + 1] + min_output;
+    remaining_max[i] = remaining_max[i + 1] + max_output;
+    remaining_abs[i]
+        = remaining_abs[i + 1] + std::max(std::fabs(min_output), std::fabs(max_output));
+  }
+  if (!std::isfinite(remaining_abs[0])) {
+    return "";
+  }
+  auto render_array = [](char const* name, std::vector<double> const& values) {
+    tl2cgen::compiler::detail::codegen::ArrayFormatter formatter(80, 2);
+    for (double e : values) {
+      formatter << tl2cgen::compiler::detail::codegen::ToStringHighPrecision(e);
+    }
+    return fmt::format("static const double {}[] = {{\n{}\n}};\n", name, formatter.str());
+  };
+  return render_array("remaining_min", remaining_min)
+         + render_array("remaining_max", remaining_max)
+         + render_array("remaining_abs", remaining_abs);
+}
+
 }  // anonymous namespace
 
 namespace tl2cgen::compiler::detail::codegen {
@@ -62,9 +240,19 @@ char const* const header_template =
 #if defined(__clang__) || defined(__GNUC__)
 #define LIKELY(x)   __builtin_expect(!!(x), 1)
 #define UNLIKELY(x) __builtin_expect(!!(x), 0)
+#define COLD_FUNCTION __attribute__((cold, noinline))
 #else
 #define LIKELY(x)   (x)
 #define UNLIKELY(x) (x)
+#define COLD_FUNCTION
+#endif
+
+#if defined(__clang__) || defined(__GNUC__)
+#define RESTRICT __restrict__
+#elif defined(_MSC_VER)
+#define RESTRICT __restrict
+#else
+#define RESTRICT
 #endif
 
 #define N_TARGET {num_target}
@@ -82,7 +270,32 @@ union Entry {{
 {dllexport}const char* get_threshold_type(void);
 {dllexport}const char* get_leaf_output_type(void);
 {dllexport}void predict(union Entry* data, int pred_margin, {leaf_output_ctype}* result);
+{dllexport}void predict_batch(const {threshold_ctype}* X, size_t nrow, size_t stride,
+    {threshold_ctype} missing, int pred_margin, {leaf_output_ctype}* out);
 void postprocess({leaf_output_ctype}* result);
+void postprocess_batch({leaf_output_ctype}* result, size_t nrow);
+)TL2CGENTEMPLATE";
+
+// Conversion of leaf outputs stored with reduced precision back to float. Both functions are
+// exact. A float16 value is decoded by placing its exponent and mantissa into a float32 and then
+// correcting the exponent bias (2^112 = 2^(127 - 15)); subnormal values are converted separately,
+// so that the result does not depend on whether the CPU flushes subnormal float32 to zero.
+char const* const leaf_decode_template =
+    R"TL2CGENTEMPLATE(
+static inline float decode_float16(uint16_t h) {
+  const uint32_t bits = (uint32_t)(h & 0x7FFFU) << 13;
+  float magnitude;
+  memcpy(&magnitude, &bits, sizeof(magnitude));
+  magnitude = (h & 0x7C00U) ? magnitude * 5.192296858534828e+33f
+                            : (float)(h & 0x3FFU) * 5.96046448e-08f;
+  return (h & 0x8000U) ? -magnitude : magnitude;
+}
+static inline float decode_bfloat16(uint16_t h) {
+  const uint32_t bits = (uint32_t)h << 16;
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
 )TL2CGENTEMPLATE";
 
 char const* const main_start_template =
@@ -90,6 +303,7 @@ char const* const main_start_template =
 #include "header.h"
 
 {array_is_categorical}
+{array_categorical_bitmap}
 {array_num_class}
 
 int32_t get_num_target(void) {{
@@ -109,10 +323,164 @@ const char* get_threshold_type(void) {{
 const char* get_leaf_output_type(void) {{
   return "{leaf_output_type}";
 }}
+{missing_fast_path}
+{predict_function_signature} {{
+)TL2CGENTEMPLATE";
+
+char const* const predict_function_signature_template
+    = "void predict(union Entry* data, int pred_margin,\n"
+      "    {leaf_output_ctype}* RESTRICT result)";
 
+// With the fast path for rows without missing values, the trees are evaluated by predict_row(),
+// which is told by its caller whether any feature used by the model is missing.
+char const* const predict_row_signature_template
+    = "static void predict_row(union Entry* data, int has_missing, int pred_margin,\n"
+      "    {leaf_output_ctype}* RESTRICT result)";
+
+char const* const predict_row_wrapper_template =
+    R"TL2CGENTEMPLATE(
 void predict(union Entry* data, int pred_margin, {leaf_output_ctype}* result) {{
+  predict_row(data, row_has_missing(data), pred_margin, result);
+}})TL2CGENTEMPLATE";
+
+char const* const predict_batch_template =
+    R"TL2CGENTEMPLATE(
+/*
+ * Predict for nrow dense rows. Row i is given by X[(i * stride):(i * stride + {num_feature})].
+ * NaN and the value of missing are treated as missing values. As with predict(), the outputs
+ * are accumulated into out, which must hold nrow * N_TARGET * MAX_N_CLASS elements. The
+ * postprocessor is applied to all rows at once, after the trees are evaluated.
+ */
+void predict_batch(const {threshold_ctype}* X, size_t nrow, size_t stride,
+    {threshold_ctype} missing, int pred_margin, {leaf_output_ctype}* out) {{
+  union Entry data[{entry_len}];
+  const int missing_is_nan = isnan(missing);
+  size_t i = 0;
+{simd_blocks}
+  for (; i < nrow; ++i) {{
+    const {threshold_ctype}* row = &X[i * stride];{row_missing_init}
+    for (int j = 0; j < {num_feature}; ++j) {{
+      if (isnan(row[j]) || (!missing_is_nan && row[j] == missing)) {{
+        data[j].missing = -1;{row_missing_update}
+      }} else {{
+        data[j].fvalue = row[j];
+      }}
+    }}
+    {predict_call}
+  }}
+  if (!pred_margin) {{
+    postprocess_batch(out, nrow);
+  }}
+}}
+)TL2CGENTEMPLATE";
+
+char const* const tree_range_header_template =
+    R"TL2CGENTEMPLATE(
+{dllexport}int32_t get_num_tree(void);
+{dllexport}void predict_range(union Entry* data, int32_t tree_begin, int32_t tree_end,
+    int pred_margin, {leaf_output_ctype}* result);
+)TL2CGENTEMPLATE";
+
+char const* const tree_range_template =
+    R"TL2CGENTEMPLATE(
+static void (* const tree_function[])({tree_function_params}) = {{
+{tree_function_list}
+}};
+{array_num_tree_before}
+int32_t get_num_tree(void) {{
+  return {num_tree};
+}}
+
+/*
+ * Predict with the trees in the range [tree_begin, tree_end) only, where
+ * 0 <= tree_begin <= tree_end <= get_num_tree(). Averaging, base_scores and the postprocessor
+ * are applied as in predict().
+ */
+void predict_range(union Entry* data, int32_t tree_begin, int32_t tree_end,
+    int pred_margin, {leaf_output_ctype}* RESTRICT result) {{
+)TL2CGENTEMPLATE";
+
+char const* const tree_range_loop_template =
+    R"TL2CGENTEMPLATE(for (int32_t tree_id = tree_begin; tree_id < tree_end; ++tree_id) {{
+  tree_function[tree_id]({tree_function_args});
+}})TL2CGENTEMPLATE";
+
+char const* const tree_range_average_template =
+    R"TL2CGENTEMPLATE(
+// Average tree outputs over the trees in the range
+for (int i = 0; i < N_TARGET * MAX_N_CLASS; ++i) {{
+  const int32_t count = num_tree_before[tree_end * N_TARGET * MAX_N_CLASS + i]
+                        - num_tree_before[tree_begin * N_TARGET * MAX_N_CLASS + i];
+  if (count > 0) {{
+    result[i] /= count;
+  }}
+}})TL2CGENTEMPLATE";
+
+char const* const decision_header_template =
+    R"TL2CGENTEMPLATE({dllexport}int predict_decision(union Entry* data, double threshold);
+)TL2CGENTEMPLATE";
+
+char const* const decision_start_template =
+    R"TL2CGENTEMPLATE(
+{array_remaining_output}
+/*
+ * Return 1 if the margin, i.e. the prediction with pred_margin=1, is greater than threshold,
+ * and 0 otherwise. The evaluation stops as soon as the outputs of the remaining trees can no
+ * longer change the decision.
+ */
+int predict_decision(union Entry* data, double threshold) {{
+  {leaf_output_ctype} result[1] = {{0}};
+)TL2CGENTEMPLATE";
+
+char const* const decision_loop_template =
+    R"TL2CGENTEMPLATE(for (int32_t tree_id = 0; tree_id < {num_tree}; ++tree_id) {{
+  tree_function[tree_id]({tree_function_args});
+  /* Widen the bounds by the largest rounding error that the remaining additions can make */
+  const double margin = (double)result[0] + {base_score};
+  const double slack = ({num_tree} + 2 - tree_id) * {epsilon}
+                       * (fabs((double)result[0]) + remaining_abs[tree_id + 1] + {abs_base_score});
+  if (margin + remaining_min[tree_id + 1] - slack > threshold) {{
+    return 1;
+  }}
+  if (margin + remaining_max[tree_id + 1] + slack <= threshold) {{
+    return 0;
+  }}
+}}
+result[0] += {base_score};
+return result[0] > threshold;)TL2CGENTEMPLATE";
+
+char const* const simd_header_template =
+    R"TL2CGENTEMPLATE(
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define USE_SIMD_KERNELS
+#endif
+
+void finish_prediction(int pred_margin, {leaf_output_ctype}* result);
 )TL2CGENTEMPLATE";
 
+char const* const simd_blocks_template =
+    R"TL2CGENTEMPLATE(#ifdef USE_SIMD_KERNELS
+  /* Evaluate blocks of 16 (AVX-512) or 8 (AVX2) rows with SIMD kernels. Offsets of the
+     feature values within each block must fit in int32_t. */
+  if (stride <= (size_t)(INT32_MAX - {num_feature}) / 16) {{
+    if (__builtin_cpu_supports("avx512f")) {{
+      for (; i + 16 <= nrow; i += 16) {{
+{avx512_calls}
+        for (size_t r = i; r < i + 16; ++r) {{
+          finish_prediction(1, &out[r * N_TARGET * MAX_N_CLASS]);
+        }}
+      }}
+    }} else if (__builtin_cpu_supports("avx2")) {{
+      for (; i + 8 <= nrow; i += 8) {{
+{avx2_calls}
+        for (size_t r = i; r < i + 8; ++r) {{
+          finish_prediction(1, &out[r * N_TARGET * MAX_N_CLASS]);
+        }}
+      }}
+    }}
+  }}
+#endif)TL2CGENTEMPLATE";
+
 void HandleMainNode(ast::MainNode const* node, CodeCollection& gencode) {
   auto const threshold_ctype_str = GetThresholdCType(node);
   auto const leaf_output_ctype_str = GetLeafOutputCType(node);
@@ -124,17 +492,72 @@ void HandleMainNode(ast::MainNode const* node, CodeCollection& gencode) {
   gencode.PushFragment(fmt::format(header_template, "threshold_ctype"_a = threshold_ctype_str,
       "leaf_output_ctype"_a = leaf_output_ctype_str, "dllexport"_a = DLLEXPORT_KEYWORD,
       "num_target"_a = num_target, "max_num_class"_a = max_num_class));
+  std::string const& leaf_output_precision = node->meta_->leaf_output_precision_;
+  if (leaf_output_precision == "float16" || leaf_output_precision == "bfloat16") {
+    gencode.PushFragment(leaf_decode_template);
+  }
+  std::vector<int> simd_layout_ids;
+  FindSIMDLayouts(node, simd_layout_ids);
+  if (!simd_layout_ids.empty()) {
+    gencode.PushFragment(
+        fmt::format(simd_header_template, "leaf_output_ctype"_a = leaf_output_ctype_str));
+  }
+  if (!node->meta_->categorical_bitmap_.empty()) {
+    gencode.PushFragment("extern const uint64_t categorical_bitmap[];");
+  }
+  std::vector<ast::TreeFunctionNode const*> tree_list;
+  FindTreeFunctions(node, tree_list);
+  std::sort(tree_list.begin(), tree_list.end(),
+      [](auto const* lhs, auto const* rhs) { return lhs->tree_id_ < rhs->tree_id_; });
+  if (!tree_list.empty()) {
+    gencode.PushFragment(fmt::format(tree_range_header_template,
+        "dllexport"_a = DLLEXPORT_KEYWORD, "leaf_output_ctype"_a = leaf_output_ctype_str));
+  }
+  // predict_decision() is generated for models with a single output that add up tree outputs
+  std::string array_remaining_output;
+  if (!tree_list.empty() && num_target == 1 && max_num_class == 1 && !node->average_factor_) {
+    array_remaining_output = RenderRemainingOutputArrays(tree_list);
+    if (!array_remaining_output.empty()) {
+      gencode.PushFragment(
+          fmt::format(decision_header_template, "dllexport"_a = DLLEXPORT_KEYWORD));
+    }
+  }
 
+  ast::MissingFastPathNode const* missing_fast_path = FindMissingFastPath(node);
   gencode.SwitchToSourceFile("main.c");
   gencode.PushFragment(fmt::format(main_start_template,
       "array_is_categorical"_a = RenderIsCategoricalArray(node->meta_->is_categorical_),
+      "array_categorical_bitmap"_a
+      = RenderCategoricalBitmapArray(node->meta_->categorical_bitmap_),
       "array_num_class"_a = RenderNumClassArray(node->meta_->num_class_),
       "num_feature"_a = node->meta_->num_feature_, "threshold_type"_a = GetThresholdTypeStr(node),
       "leaf_output_type"_a = GetLeafOutputTypeStr(node),
-      "leaf_output_ctype"_a = leaf_output_ctype_str));
+      "missing_fast_path"_a = RenderMissingFastPath(missing_fast_path),
+      "predict_function_signature"_a = fmt::format(
+          (missing_fast_path ? predict_row_signature_template
+                             : predict_function_signature_template),
+          "leaf_output_ctype"_a = leaf_output_ctype_str)));
   gencode.ChangeIndent(1);
   TL2CGEN_CHECK_EQ(node->children_.size(), 1);
+  bool const local_accumulator = HasInlineOutput(node->children_[0]);
+  if (local_accumulator) {
+    gencode.PushFragment(RenderLocalAccumulatorStart(node));
+    gencode.ChangeIndent(1);
+  }
   GenerateCodeFromAST(node->children_[0], gencode);
+  if (local_accumulator) {
+    gencode.ChangeIndent(-1);
+    gencode.PushFragment(RenderLocalAccumulatorEnd());
+  }
+  if (!simd_layout_ids.empty()) {
+    // SIMD kernels only evaluate the trees; the remaining steps are shared with predict()
+    gencode.PushFragment("finish_prediction(pred_margin, result);");
+    gencode.ChangeIndent(-1);
+    gencode.PushFragment(fmt::format(
+        "}}\n\nvoid finish_prediction(int pred_margin, {leaf_output_ctype}* result) {{",
+        "leaf_output_ctype"_a = leaf_output_ctype_str));
+    gencode.ChangeIndent(1);
+  }
 
   // Tree averaging
   if (node->average_factor_) {
@@ -144,27 +567,106 @@ void HandleMainNode(ast::MainNode const* node, CodeCollection& gencode) {
       for (std::int32_t class_id = 0; class_id < num_class[target_id]; ++class_id) {
         gencode.PushFragment(fmt::format("result[{offset}] /= {average_factor};",
             "offset"_a = target_id * max_num_class + class_id,
-            "average_factor"_a = average_factor[class_id]));
+            "average_factor"_a = average_factor[target_id * max_num_class + class_id]));
       }
     }
   }
 
-  // Apply base_scores
-  gencode.PushFragment("\n// Apply base_scores");
-  for (std::int32_t target_id = 0; target_id < num_target; ++target_id) {
-    for (std::int32_t class_id = 0; class_id < num_class[target_id]; ++class_id) {
-      gencode.PushFragment(fmt::format("result[{offset}] += {base_score};",
-          "offset"_a = target_id * max_num_class + class_id,
-          "base_score"_a = ToStringHighPrecision(node->base_scores_[class_id])));
+  // Apply base_scores and postprocessor
+  auto push_base_scores_and_postprocessor = [&]() {
+    gencode.PushFragment("\n// Apply base_scores");
+    for (std::int32_t target_id = 0; target_id < num_target; ++target_id) {
+      for (std::int32_t class_id = 0; class_id < num_class[target_id]; ++class_id) {
+        gencode.PushFragment(fmt::format("result[{offset}] += {base_score};",
+            "offset"_a = target_id * max_num_class + class_id,
+            "base_score"_a
+            = ToStringHighPrecision(node->base_scores_[target_id * max_num_class + class_id])));
+      }
     }
-  }
-
-  // Apply postprocessor
-  gencode.PushFragment(
-      "\n// Apply postprocessor"
-      "\nif (!pred_margin) { postprocess(result); }");
+    gencode.PushFragment(
+        "\n// Apply postprocessor"
+        "\nif (!pred_margin) { postprocess(result); }");
+  };
+  push_base_scores_and_postprocessor();
   gencode.ChangeIndent(-1);
   gencode.PushFragment("}");
+  if (missing_fast_path) {
+    gencode.PushFragment(
+        fmt::format(predict_row_wrapper_template, "leaf_output_ctype"_a = leaf_output_ctype_str));
+  }
+  std::string simd_blocks;
+  if (!simd_layout_ids.empty()) {
+    std::string avx2_calls, avx512_calls;
+    for (int layout_id : simd_layout_ids) {
+      char const* const call_template
+          = "{sep}        predict_array{layout_id}_{isa}(&X[i * stride], stride, missing, "
+            "&out[i * N_TARGET * MAX_N_CLASS]);";
+      char const* const sep = (avx2_calls.empty() ? "" : "\n");
+      avx2_calls += fmt::format(
+          call_template, "sep"_a = sep, "layout_id"_a = layout_id, "isa"_a = "avx2");
+      avx512_calls += fmt::format(
+          call_template, "sep"_a = sep, "layout_id"_a = layout_id, "isa"_a = "avx512");
+    }
+    simd_blocks = fmt::format(simd_blocks_template, "num_feature"_a = node->meta_->num_feature_,
+        "avx2_calls"_a = avx2_calls, "avx512_calls"_a = avx512_calls);
+  }
+  gencode.PushFragment(fmt::format(predict_batch_template,
+      "threshold_ctype"_a = threshold_ctype_str, "leaf_output_ctype"_a = leaf_output_ctype_str,
+      "num_feature"_a = node->meta_->num_feature_,
+      "entry_len"_a = std::max(node->meta_->num_feature_, 1), "simd_blocks"_a = simd_blocks,
+      // Rows without any missing value skip the check of the used features
+      "row_missing_init"_a = (missing_fast_path ? "\n    int any_missing = 0;" : ""),
+      "row_missing_update"_a = (missing_fast_path ? "\n        any_missing = 1;" : ""),
+      "predict_call"_a = (missing_fast_path
+                              ? "predict_row(data, any_missing && row_has_missing(data), 1,\n"
+                                "        &out[i * N_TARGET * MAX_N_CLASS]);"
+                              : "predict(data, 1, &out[i * N_TARGET * MAX_N_CLASS]);")));
+  if (!tree_list.empty()) {
+    ArrayFormatter formatter(80, 2);
+    for (std::size_t tree_id = 0; tree_id < tree_list.size(); ++tree_id) {
+      TL2CGEN_CHECK_EQ(tree_list[tree_id]->tree_id_, static_cast<int>(tree_id))
+          << "Tree functions are incomplete";
+      formatter << fmt::format("predict_tree{}", tree_id);
+    }
+    gencode.PushFragment(fmt::format(tree_range_template,
+        "leaf_output_ctype"_a = leaf_output_ctype_str,
+        "tree_function_params"_a = GetTreeFunctionParams(tree_list[0]),
+        "tree_function_list"_a = formatter.str(),
+        "array_num_tree_before"_a
+        = (node->average_factor_
+                ? RenderNumTreeBeforeArray(*node->meta_, tree_list, max_num_class)
+                : std::string()),
+        "num_tree"_a = tree_list.size()));
+    gencode.ChangeIndent(1);
+    if (auto const* quantizer = dynamic_cast<ast::QuantizerNode const*>(node->children_[0])) {
+      gencode.PushFragment(RenderQuantizeLoop(quantizer));
+    }
+    gencode.PushFragment(fmt::format(
+        tree_range_loop_template, "tree_function_args"_a = GetTreeFunctionArgs(tree_list[0])));
+    if (node->average_factor_) {
+      gencode.PushFragment(tree_range_average_template);
+    }
+    push_base_scores_and_postprocessor();
+    gencode.ChangeIndent(-1);
+    gencode.PushFragment("}");
+  }
+  if (!array_remaining_output.empty()) {
+    double const base_score = node->base_scores_[0];
+    gencode.PushFragment(fmt::format(decision_start_template,
+        "array_remaining_output"_a = array_remaining_output,
+        "leaf_output_ctype"_a = leaf_output_ctype_str));
+    gencode.ChangeIndent(1);
+    if (auto const* quantizer = dynamic_cast<ast::QuantizerNode const*>(node->children_[0])) {
+      gencode.PushFragment(RenderQuantizeLoop(quantizer));
+    }
+    gencode.PushFragment(fmt::format(decision_loop_template, "num_tree"_a = tree_list.size(),
+        "tree_function_args"_a = GetTreeFunctionArgs(tree_list[0]),
+        "base_score"_a = ToStringHighPrecision(base_score),
+        "abs_base_score"_a = ToStringHighPrecision(std::fabs(base_score)),
+        "epsilon"_a = (leaf_output_ctype_str == "float" ? "FLT_EPSILON" : "DBL_EPSILON")));
+    gencode.ChangeIndent(-1);
+    gencode.PushFragment("}");
+  }
   gencode.PushFragment(GetPostprocessorFunc(*node->meta_, node->postprocessor_));
 }
 
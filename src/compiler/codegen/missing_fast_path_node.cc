@@ -0,0 +1,31 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file missing_fast_path_node.cc
+ * \brief Convert MissingFastPathNode in AST into C code
+ * \author Hyunsu Cho
+ */
+
+#include <tl2cgen/detail/compiler/ast/ast.h>
+#include <tl2cgen/detail/compiler/codegen/codegen.h>
+#include <tl2cgen/logging.h>
+
+namespace tl2cgen::compiler::detail::codegen {
+
+void HandleMissingFastPathNode(ast::MissingFastPathNode const* node, CodeCollection& gencode) {
+  TL2CGEN_CHECK_EQ(node->children_.size(), 1);
+  // has_missing is computed by the caller, from the features in node->feature_list_
+  gencode.PushFragment("if (LIKELY(!has_missing)) {");
+  gencode.ChangeIndent(1);
+  gencode.PushFragment("/* Fast path: no missing value in the features used by the model */");
+  gencode.SetAssumeNoMissing(true);
+  GenerateCodeFromAST(node->children_[0], gencode);
+  gencode.SetAssumeNoMissing(false);
+  gencode.ChangeIndent(-1);
+  gencode.PushFragment("} else {");
+  gencode.ChangeIndent(1);
+  GenerateCodeFromAST(node->children_[0], gencode);
+  gencode.ChangeIndent(-1);
+  gencode.PushFragment("}");
+}
+
+}  // namespace tl2cgen::compiler::detail::codegen
@@ -0,0 +1,73 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file outlined_subtree_node.cc
+ * \brief Convert OutlinedSubtreeNode in AST into C code
+ * \author Hyunsu Cho
+ */
+
+#include <fmt/format.h>
+#include <tl2cgen/detail/compiler/ast/ast.h>
+#include <tl2cgen/detail/compiler/codegen/codegen.h>
+#include <tl2cgen/logging.h>
+
+#include <string>
+
+using namespace fmt::literals;
+
+namespace {
+
+namespace ast = tl2cgen::compiler::detail::ast;
+
+char const* const cold_function_name_template = "predict_cold{func_id}";
+char const* const cold_function_signature_template
+    = "void {cold_function_name}({params})";
+char const* const cold_source_start_template =
+    R"TL2CGENTEMPLATE(
+{cold_function_signature} {{
+)TL2CGENTEMPLATE";
+
+// Cold functions are collected in a separate source file for each translation unit, so that
+// they stay away from the frequently executed code.
+std::string GetColdSourceFile(ast::ASTNode const* node) {
+  for (ast::ASTNode const* p = node->parent_; p; p = p->parent_) {
+    if (auto const* tu = dynamic_cast<ast::TranslationUnitNode const*>(p)) {
+      return fmt::format("cold{unit_id}.c", "unit_id"_a = tu->unit_id_);
+    }
+  }
+  return "cold.c";
+}
+
+}  // anonymous namespace
+
+namespace tl2cgen::compiler::detail::codegen {
+
+void HandleOutlinedSubtreeNode(ast::OutlinedSubtreeNode const* node, CodeCollection& gencode) {
+  TL2CGEN_CHECK_EQ(node->children_.size(), 1);
+  std::string const cold_function_name
+      = fmt::format(cold_function_name_template, "func_id"_a = node->func_id_)
+        + gencode.GetFunctionSuffix();
+  std::string const cold_function_signature = fmt::format(cold_function_signature_template,
+      "cold_function_name"_a = cold_function_name, "params"_a = GetTreeFunctionParams(node));
+
+  auto current_file = gencode.GetCurrentSourceFile();
+  gencode.PushFragment(fmt::format("{cold_function_name}({args});",
+      "cold_function_name"_a = cold_function_name, "args"_a = GetTreeFunctionArgs(node)));
+  gencode.SwitchToSourceFile("header.h");
+  gencode.PushFragment(fmt::format("COLD_FUNCTION {};", cold_function_signature));
+  std::string const cold_source_file = GetColdSourceFile(node);
+  bool const new_source_file = !gencode.HasSourceFile(cold_source_file);
+  gencode.SwitchToSourceFile(cold_source_file);
+  if (new_source_file) {
+    gencode.PushFragment("\n#include \"header.h\"");
+  }
+  gencode.PushFragment(fmt::format(
+      cold_source_start_template, "cold_function_signature"_a = cold_function_signature));
+  gencode.ChangeIndent(1);
+  gencode.PushFragment("unsigned int tmp;");
+  GenerateCodeFromAST(node->children_[0], gencode);
+  gencode.ChangeIndent(-1);
+  gencode.PushFragment("}");
+  gencode.SwitchToSourceFile(current_file);  // Switch back context
+}
+
+}  // namespace tl2cgen::compiler::detail::codegen
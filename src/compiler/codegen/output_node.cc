@@ -8,15 +8,54 @@
 #include <fmt/format.h>
 #include <tl2cgen/detail/compiler/ast/ast.h>
 #include <tl2cgen/detail/compiler/codegen/codegen.h>
+#include <tl2cgen/detail/compiler/codegen/table_util.h>
 #include <tl2cgen/logging.h>
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <string>
+#include <type_traits>
 #include <variant>
+#include <vector>
 
 using namespace fmt::literals;
 
+namespace {
+
+// Leaf vectors are stored in a static table, so that each leaf is accumulated with a single loop
+// (which the C compiler can vectorize) instead of one statement per element.
+char const* const leaf_vector_template =
+    R"TL2CGENTEMPLATE({{
+  static const {leaf_storage_ctype} leaf_vector[] = {{
+{array_leaf_vector}
+  }};
+  for (int k = 0; k < {leaf_len}; ++k) {{
+    result[{result_index}] += {leaf_value};
+  }}
+}})TL2CGENTEMPLATE";
+
+// Render code to add leaf_vector[k] to result[offset + k * stride], for each k
+template <typename LeafOutputT>
+std::string RenderLeafVector(std::vector<LeafOutputT> const& leaf_vector,
+    tl2cgen::compiler::detail::ast::ModelMeta const& meta, std::string const& leaf_output_ctype,
+    std::int32_t offset, std::int32_t stride) {
+  namespace codegen = tl2cgen::compiler::detail::codegen;
+  std::string result_index = (stride == 1) ? "k" : fmt::format("k * {}", stride);
+  if (offset != 0) {
+    result_index = fmt::format("{} + {}", offset, result_index);
+  }
+  return fmt::format(leaf_vector_template,
+      "leaf_storage_ctype"_a = codegen::GetLeafStorageCType(meta, leaf_output_ctype),
+      "array_leaf_vector"_a
+      = codegen::IndentMultiLineString(codegen::RenderLeafOutputArray(leaf_vector, meta), 2),
+      "leaf_len"_a = leaf_vector.size(), "result_index"_a = result_index,
+      "leaf_value"_a = codegen::RenderLeafOutputDecode("leaf_vector[k]", meta));
+}
+
+}  // anonymous namespace
+
 namespace tl2cgen::compiler::detail::codegen {
 
 void HandleOutputNode(ast::OutputNode const* node, CodeCollection& gencode) {
@@ -25,6 +64,7 @@ void HandleOutputNode(ast::OutputNode const* node, CodeCollection& gencode) {
   std::int32_t const num_target = node->meta_->num_target_;
   std::vector<std::int32_t> const& num_class = node->meta_->num_class_;
   std::int32_t const max_num_class = *std::max_element(num_class.begin(), num_class.end());
+  std::string const leaf_output_ctype = GetLeafOutputCType(node);
 
   // In the predict() function, the result[] array represents the slice output(row_id, :, :)
   // that holds the prediction for a single row.
@@ -35,6 +75,18 @@ void HandleOutputNode(ast::OutputNode const* node, CodeCollection& gencode) {
           std::array<std::int32_t, 2> const expected_shape{num_target, max_num_class};
           TL2CGEN_CHECK(node->meta_->leaf_vector_shape_ == expected_shape);
           TL2CGEN_CHECK_EQ(leaf_output.size(), num_target * max_num_class);
+          if (leaf_output.size() > 1) {
+            // output(row_id, :, :) += leaf(:, :)
+            // Fill zeros into the slots of classes that do not exist in a target.
+            auto leaf_vector = leaf_output;
+            for (std::int32_t target_id = 0; target_id < num_target; ++target_id) {
+              std::fill(leaf_vector.begin() + target_id * max_num_class + num_class[target_id],
+                  leaf_vector.begin() + (target_id + 1) * max_num_class, 0);
+            }
+            gencode.PushFragment(
+                RenderLeafVector(leaf_vector, *node->meta_, leaf_output_ctype, 0, 1));
+            return;
+          }
           for (std::int32_t target_id = 0; target_id < num_target; ++target_id) {
             for (std::int32_t class_id = 0; class_id < num_class[target_id]; ++class_id) {
               // output(row_id, target_id, class_id) += leaf(target_id, class_id)
@@ -50,6 +102,12 @@ void HandleOutputNode(ast::OutputNode const* node, CodeCollection& gencode) {
           TL2CGEN_CHECK_EQ(leaf_output.size(), num_target);
           TL2CGEN_CHECK_GE(node->class_id_, 0);
           auto const class_id = node->class_id_;
+          if (num_target > 1) {
+            // output(row_id, :, class_id) += leaf(:)
+            gencode.PushFragment(RenderLeafVector(
+                leaf_output, *node->meta_, leaf_output_ctype, class_id, max_num_class));
+            return;
+          }
           for (std::int32_t target_id = 0; target_id < num_target; ++target_id) {
             // output(row_id, target_id, class_id) += leaf(target_id)
             gencode.PushFragment(fmt::format("result[{offset}] += {leaf};",
@@ -63,6 +121,14 @@ void HandleOutputNode(ast::OutputNode const* node, CodeCollection& gencode) {
           TL2CGEN_CHECK_EQ(leaf_output.size(), max_num_class);
           TL2CGEN_CHECK_GE(node->target_id_, 0);
           auto const target_id = node->target_id_;
+          if (num_class[target_id] > 1) {
+            // output(row_id, target_id, :) += leaf(:)
+            std::vector<std::decay_t<decltype(leaf_output[0])>> leaf_vector(
+                leaf_output.begin(), leaf_output.begin() + num_class[target_id]);
+            gencode.PushFragment(RenderLeafVector(
+                leaf_vector, *node->meta_, leaf_output_ctype, target_id * max_num_class, 1));
+            return;
+          }
           for (std::int32_t class_id = 0; class_id < num_class[target_id]; ++class_id) {
             // output(row_id, target_id, class_id) += leaf(class_id)
             gencode.PushFragment(fmt::format("result[{offset}] += {leaf};",
@@ -34,8 +34,10 @@ std::string GetCopySignCFunc(std::string const& leaf_output_ctype) {
   }
 }
 
-std::string GetExpCFunc(std::string const& leaf_output_ctype) {
-  if (leaf_output_ctype == "float") {
+std::string GetExpCFunc(std::string const& leaf_output_ctype, bool fast_math) {
+  if (fast_math) {
+    return "fast_exp";
+  } else if (leaf_output_ctype == "float") {
     return "expf";
   } else if (leaf_output_ctype == "double") {
     return "exp";
@@ -45,8 +47,10 @@ std::string GetExpCFunc(std::string const& leaf_output_ctype) {
   }
 }
 
-std::string GetExp2CFunc(std::string const& leaf_output_ctype) {
-  if (leaf_output_ctype == "float") {
+std::string GetExp2CFunc(std::string const& leaf_output_ctype, bool fast_math) {
+  if (fast_math) {
+    return "fast_exp2";
+  } else if (leaf_output_ctype == "float") {
     return "exp2f";
   } else if (leaf_output_ctype == "double") {
     return "exp2";
@@ -67,10 +71,150 @@ std::string GetLog1pCFunc(std::string const& leaf_output_ctype) {
   }
 }
 
+// Polynomial approximations of exp() and exp2(), used when fast_math_postprocess is set. The
+// argument is split as x = n * ln(2) + r, with integer n and |r| <= ln(2) / 2, and exp(r) is
+// evaluated with its Taylor polynomial. The maximum relative error is about 1.1e-7 for float and
+// 2e-16 for double; see the documentation of CompilerParam::fast_math_postprocess. The functions
+// have no branch, so that the loops calling them can be vectorized.
+char const* const fast_exp_float_template =
+    R"TL2CGENTEMPLATE(
+/* 2^n * exp(r), for |r| <= ln(2) / 2. 2^n is applied in two steps, so that results beyond the
+   range of normal numbers correctly become subnormal, zero or infinity. */
+static inline float fast_exp_reduced(float r, float n) {
+  float p = 1.0f / 5040;
+  p = p * r + 1.0f / 720;
+  p = p * r + 1.0f / 120;
+  p = p * r + 1.0f / 24;
+  p = p * r + 1.0f / 6;
+  p = p * r + 0.5f;
+  p = p * r + 1.0f;
+  p = p * r + 1.0f;
+  const int32_t n1 = (int32_t)n / 2;
+  const int32_t bits1 = (n1 + 127) << 23;
+  const int32_t bits2 = ((int32_t)n - n1 + 127) << 23;
+  float scale1, scale2;
+  memcpy(&scale1, &bits1, sizeof(scale1));
+  memcpy(&scale2, &bits2, sizeof(scale2));
+  return p * scale1 * scale2;
+}
+
+/* Clamp the magnitude of x to limit, by comparing the bit patterns as integers. Unlike
+   floating-point comparisons, integer comparisons do not keep the C compiler from vectorizing
+   the loop. NaN is kept as is. */
+static inline float clamp_magnitude(float x, float limit) {
+  int32_t bits, limit_bits;
+  memcpy(&bits, &x, sizeof(bits));
+  memcpy(&limit_bits, &limit, sizeof(limit_bits));
+  const int32_t magnitude = bits & INT32_MAX;
+  const int32_t clamped
+      = (magnitude > limit_bits && magnitude <= 0x7F800000) ? limit_bits : magnitude;
+  bits = clamped | (bits & INT32_MIN);
+  memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+static inline float fast_exp(float x) {
+  x = clamp_magnitude(x, 104.0f);
+  const float y = x * 1.44269504f;
+  const float n = (float)(int32_t)(y + copysignf(0.5f, y));
+  /* ln(2) is split into two parts, so that n * 0.693145752f is exact */
+  const float r = (x - n * 0.693145752f) - n * 1.42860677e-06f;
+  return fast_exp_reduced(r, n);
+}
+
+static inline float fast_exp2(float x) {
+  x = clamp_magnitude(x, 150.0f);
+  const float n = (float)(int32_t)(x + copysignf(0.5f, x));
+  return fast_exp_reduced((x - n) * 0.693147181f, n);
+}
+)TL2CGENTEMPLATE";
+
+char const* const fast_exp_double_template =
+    R"TL2CGENTEMPLATE(
+/* 2^n * exp(r), for |r| <= ln(2) / 2. 2^n is applied in two steps, so that results beyond the
+   range of normal numbers correctly become subnormal, zero or infinity. */
+static inline double fast_exp_reduced(double r, double n) {
+  double p = 1.0 / 6227020800.0;
+  p = p * r + 1.0 / 479001600.0;
+  p = p * r + 1.0 / 39916800.0;
+  p = p * r + 1.0 / 3628800.0;
+  p = p * r + 1.0 / 362880.0;
+  p = p * r + 1.0 / 40320.0;
+  p = p * r + 1.0 / 5040.0;
+  p = p * r + 1.0 / 720.0;
+  p = p * r + 1.0 / 120.0;
+  p = p * r + 1.0 / 24.0;
+  p = p * r + 1.0 / 6.0;
+  p = p * r + 0.5;
+  p = p * r + 1.0;
+  p = p * r + 1.0;
+  const int32_t n1 = (int32_t)n / 2;
+  const int64_t bits1 = (int64_t)(n1 + 1023) << 52;
+  const int64_t bits2 = (int64_t)((int32_t)n - n1 + 1023) << 52;
+  double scale1, scale2;
+  memcpy(&scale1, &bits1, sizeof(scale1));
+  memcpy(&scale2, &bits2, sizeof(scale2));
+  return p * scale1 * scale2;
+}
+
+/* Clamp the magnitude of x to limit, by comparing the bit patterns as integers. Unlike
+   floating-point comparisons, integer comparisons do not keep the C compiler from vectorizing
+   the loop. NaN is kept as is. */
+static inline double clamp_magnitude(double x, double limit) {
+  int64_t bits, limit_bits;
+  memcpy(&bits, &x, sizeof(bits));
+  memcpy(&limit_bits, &limit, sizeof(limit_bits));
+  const int64_t magnitude = bits & INT64_MAX;
+  const int64_t clamped
+      = (magnitude > limit_bits && magnitude <= 0x7FF0000000000000) ? limit_bits : magnitude;
+  bits = clamped | (bits & INT64_MIN);
+  memcpy(&x, &bits, sizeof(x));
+  return x;
+}
+
+static inline double fast_exp(double x) {
+  x = clamp_magnitude(x, 746.0);
+  const double y = x * 1.4426950408889634;
+  const double n = (double)(int32_t)(y + copysign(0.5, y));
+  /* ln(2) is split into two parts, so that n * 6.93147180369123816490e-01 is exact */
+  const double r = (x - n * 6.93147180369123816490e-01) - n * 1.90821492927058770002e-10;
+  return fast_exp_reduced(r, n);
+}
+
+static inline double fast_exp2(double x) {
+  x = clamp_magnitude(x, 1075.0);
+  const double n = (double)(int32_t)(x + copysign(0.5, x));
+  return fast_exp_reduced((x - n) * 0.69314718055994531, n);
+}
+)TL2CGENTEMPLATE";
+
+// postprocess() applies the postprocessor to a single row
+char const* const postprocess_row_template =
+    R"TL2CGENTEMPLATE(
+void postprocess({leaf_output_type}* result) {{
+  postprocess_batch(result, 1);
+}}
+)TL2CGENTEMPLATE";
+
+std::string GetFastMathFunctions(ast::ModelMeta const& model_meta) {
+  if (!model_meta.fast_math_postprocess_) {
+    return "";
+  }
+  std::string const leaf_output_type = codegen::GetLeafOutputCType(model_meta);
+  if (leaf_output_type == "float") {
+    return fast_exp_float_template;
+  } else if (leaf_output_type == "double") {
+    return fast_exp_double_template;
+  } else {
+    TL2CGEN_LOG(FATAL) << "Unrecognized type: " << leaf_output_type;
+    return "";
+  }
+}
+
 std::string Identity(ast::ModelMeta const& model_meta) {
   return fmt::format(
       R"TL2CGENTEMPLATE(
-void postprocess({leaf_output_type}* result) {{
+void postprocess_batch({leaf_output_type}* result, size_t nrow) {{
   // Do nothing
 }}
 )TL2CGENTEMPLATE",
@@ -81,10 +225,10 @@ std::string SignedSquare(ast::ModelMeta const& model_meta) {
   std::string const leaf_output_type = codegen::GetLeafOutputCType(model_meta);
   return fmt::format(
       R"TL2CGENTEMPLATE(
-void postprocess({leaf_output_type}* result) {{
+void postprocess_batch({leaf_output_type}* result, size_t nrow) {{
   // signed_square
   {leaf_output_type} margin;
-  for (size_t i = 0; i < N_TARGET * MAX_N_CLASS; ++i) {{
+  for (size_t i = 0; i < nrow * N_TARGET * MAX_N_CLASS; ++i) {{
     margin = result[i];
     result[i] = {copysign}(margin * margin, margin);
   }}
@@ -97,9 +241,9 @@ std::string Hinge(ast::ModelMeta const& model_meta) {
   std::string const leaf_output_type = codegen::GetLeafOutputCType(model_meta);
   return fmt::format(
       R"TL2CGENTEMPLATE(
-void postprocess({leaf_output_type}* result) {{
+void postprocess_batch({leaf_output_type}* result, size_t nrow) {{
   // hinge
-  for (size_t i = 0; i < N_TARGET * MAX_N_CLASS; ++i) {{
+  for (size_t i = 0; i < nrow * N_TARGET * MAX_N_CLASS; ++i) {{
     if (result[i] > 0) {{
       result[i] = ({leaf_output_type})(1);
     }} else {{
@@ -117,30 +261,31 @@ std::string Sigmoid(ast::ModelMeta const& model_meta) {
   TL2CGEN_CHECK_GT(alpha, 0.0f) << "sigmoid: alpha must be strictly positive";
   return fmt::format(
       R"TL2CGENTEMPLATE(
-void postprocess({leaf_output_type}* result) {{
+void postprocess_batch({leaf_output_type}* result, size_t nrow) {{
   // sigmoid
   const {leaf_output_type} alpha = ({leaf_output_type}){alpha};
-  for (size_t i = 0; i < N_TARGET * MAX_N_CLASS; ++i) {{
+  for (size_t i = 0; i < nrow * N_TARGET * MAX_N_CLASS; ++i) {{
     result[i] = ({leaf_output_type})(1) / (({leaf_output_type})(1) + {exp}(-alpha * result[i]));
   }}
 }}
 )TL2CGENTEMPLATE",
       "alpha"_a = alpha, "leaf_output_type"_a = leaf_output_type,
-      "exp"_a = GetExpCFunc(leaf_output_type));
+      "exp"_a = GetExpCFunc(leaf_output_type, model_meta.fast_math_postprocess_));
 }
 
 std::string Exponential(ast::ModelMeta const& model_meta) {
   std::string const leaf_output_type = codegen::GetLeafOutputCType(model_meta);
   return fmt::format(
       R"TL2CGENTEMPLATE(
-void postprocess({leaf_output_type}* result) {{
+void postprocess_batch({leaf_output_type}* result, size_t nrow) {{
   // exponential
-  for (size_t i = 0; i < N_TARGET * MAX_N_CLASS; ++i) {{
+  for (size_t i = 0; i < nrow * N_TARGET * MAX_N_CLASS; ++i) {{
     result[i] = {exp}(result[i]);
   }}
 }}
 )TL2CGENTEMPLATE",
-      "leaf_output_type"_a = leaf_output_type, "exp"_a = GetExpCFunc(leaf_output_type));
+      "leaf_output_type"_a = leaf_output_type,
+      "exp"_a = GetExpCFunc(leaf_output_type, model_meta.fast_math_postprocess_));
 }
 
 std::string ExponentialStandardRatio(ast::ModelMeta const& model_meta) {
@@ -148,15 +293,16 @@ std::string ExponentialStandardRatio(ast::ModelMeta const& model_meta) {
   std::string const leaf_output_type = codegen::GetLeafOutputCType(model_meta);
   return fmt::format(
       R"TL2CGENTEMPLATE(
-void postprocess({leaf_output_type}* result) {{
+void postprocess_batch({leaf_output_type}* result, size_t nrow) {{
   // exponential_standard_ratio
   const {leaf_output_type} ratio_c = ({leaf_output_type}){ratio_c};
-  for (size_t i = 0; i < N_TARGET * MAX_N_CLASS; ++i) {{
+  for (size_t i = 0; i < nrow * N_TARGET * MAX_N_CLASS; ++i) {{
     result[i] = {exp2}(-result[i] / ratio_c);
   }}
 }}
 )TL2CGENTEMPLATE",
-      "leaf_output_type"_a = leaf_output_type, "exp2"_a = GetExp2CFunc(leaf_output_type),
+      "leaf_output_type"_a = leaf_output_type,
+      "exp2"_a = GetExp2CFunc(leaf_output_type, model_meta.fast_math_postprocess_),
       "ratio_c"_a = ratio_c);
 }
 
@@ -164,14 +310,15 @@ std::string LogarithmOnePlusExp(ast::ModelMeta const& model_meta) {
   std::string const leaf_output_type = codegen::GetLeafOutputCType(model_meta);
   return fmt::format(
       R"TL2CGENTEMPLATE(
-void postprocess({leaf_output_type}* result) {{
+void postprocess_batch({leaf_output_type}* result, size_t nrow) {{
   // logarithm_one_plus_exp
-  for (size_t i = 0; i < N_TARGET * MAX_N_CLASS; ++i) {{
+  for (size_t i = 0; i < nrow * N_TARGET * MAX_N_CLASS; ++i) {{
     result[i] = {log1p}({exp}(result[i]));
   }}
 }}
 )TL2CGENTEMPLATE",
-      "leaf_output_type"_a = leaf_output_type, "exp"_a = GetExpCFunc(leaf_output_type),
+      "leaf_output_type"_a = leaf_output_type,
+      "exp"_a = GetExpCFunc(leaf_output_type, model_meta.fast_math_postprocess_),
       "log1p"_a = GetLog1pCFunc(leaf_output_type));
 }
 
@@ -180,38 +327,42 @@ std::string Softmax(ast::ModelMeta const& model_meta) {
   std::string const leaf_output_type = codegen::GetLeafOutputCType(model_meta);
   fmt::print(oss,
       R"TL2CGENTEMPLATE(
-// Apply postprocessor for a single target
+// Apply postprocessor for a single target. The exponentials are computed in a loop of their own,
+// which the C compiler can vectorize.
 static void postprocess_impl({leaf_output_type}* target_result, int num_class) {{
   {leaf_output_type} max_margin = target_result[0];
   double norm_const = 0.0;
-  {leaf_output_type} t;
   for (int k = 1; k < num_class; ++k) {{
     if (target_result[k] > max_margin) {{
       max_margin = target_result[k];
     }}
   }}
   for (int k = 0; k < num_class; ++k) {{
-    t = {exp}(target_result[k] - max_margin);
-    norm_const += t;
-    target_result[k] = t;
+    target_result[k] = {exp}(target_result[k] - max_margin);
+  }}
+  for (int k = 0; k < num_class; ++k) {{
+    norm_const += target_result[k];
   }}
   for (int k = 0; k < num_class; ++k) {{
     target_result[k] /= ({leaf_output_type})norm_const;
   }}
 }}
 
-void postprocess({leaf_output_type}* result) {{
+void postprocess_batch({leaf_output_type}* result, size_t nrow) {{
   // softmax
+  for (size_t row_id = 0; row_id < nrow; ++row_id) {{
+    {leaf_output_type}* row_result = &result[row_id * N_TARGET * MAX_N_CLASS];
 )TL2CGENTEMPLATE",
-      "leaf_output_type"_a = leaf_output_type, "exp"_a = GetExpCFunc(leaf_output_type));
+      "leaf_output_type"_a = leaf_output_type,
+      "exp"_a = GetExpCFunc(leaf_output_type, model_meta.fast_math_postprocess_));
 
   auto const max_num_class
       = *std::max_element(model_meta.num_class_.begin(), model_meta.num_class_.end());
   for (std::int32_t target_id = 0; target_id < model_meta.num_target_; ++target_id) {
-    fmt::print(oss, "  postprocess_impl(&result[{offset}], {num_class});\n",
+    fmt::print(oss, "    postprocess_impl(&row_result[{offset}], {num_class});\n",
         "offset"_a = target_id * max_num_class, "num_class"_a = model_meta.num_class_[target_id]);
   }
-  oss << "}\n";
+  oss << "  }\n}\n";
   return oss.str();
 }
 
@@ -231,27 +382,27 @@ static void postprocess_impl({leaf_output_type}* target_result, int num_class) {
   }}
 }}
 
-void postprocess({leaf_output_type}* result) {{
+void postprocess_batch({leaf_output_type}* result, size_t nrow) {{
   // multiclass_ova
+  for (size_t row_id = 0; row_id < nrow; ++row_id) {{
+    {leaf_output_type}* row_result = &result[row_id * N_TARGET * MAX_N_CLASS];
 )TL2CGENTEMPLATE",
-      "leaf_output_type"_a = leaf_output_type, "exp"_a = GetExpCFunc(leaf_output_type),
+      "leaf_output_type"_a = leaf_output_type,
+      "exp"_a = GetExpCFunc(leaf_output_type, model_meta.fast_math_postprocess_),
       "alpha"_a = alpha);
 
   auto const max_num_class
       = *std::max_element(model_meta.num_class_.begin(), model_meta.num_class_.end());
   for (std::int32_t target_id = 0; target_id < model_meta.num_target_; ++target_id) {
-    fmt::print(oss, "  postprocess_impl(&result[{offset}], {num_class});\n",
+    fmt::print(oss, "    postprocess_impl(&row_result[{offset}], {num_class});\n",
         "offset"_a = target_id * max_num_class, "num_class"_a = model_meta.num_class_[target_id]);
   }
-  oss << "}\n";
+  oss << "  }\n}\n";
   return oss.str();
 }
 
-}  // anonymous namespace
-
-namespace tl2cgen::compiler::detail::codegen {
-
-std::string GetPostprocessorFunc(
+// Render postprocess_batch(), which applies the postprocessor to consecutive rows
+std::string GetPostprocessBatchFunc(
     ast::ModelMeta const& model_meta, std::string const& postprocessor) {
   if (postprocessor == "identity") {
     return Identity(model_meta);
@@ -279,4 +430,15 @@ std::string GetPostprocessorFunc(
   }
 }
 
+}  // anonymous namespace
+
+namespace tl2cgen::compiler::detail::codegen {
+
+std::string GetPostprocessorFunc(
+    ast::ModelMeta const& model_meta, std::string const& postprocessor) {
+  return GetFastMathFunctions(model_meta) + GetPostprocessBatchFunc(model_meta, postprocessor)
+         + fmt::format(postprocess_row_template,
+             "leaf_output_type"_a = GetLeafOutputCType(model_meta));
+}
+
 }  // namespace tl2cgen::compiler::detail::codegen
@@ -11,6 +11,11 @@
 #include <tl2cgen/detail/compiler/codegen/format_util.h>
 #include <tl2cgen/logging.h>
 
+#include <cstddef>
+#include <string>
+#include <variant>
+#include <vector>
+
 using namespace fmt::literals;
 
 namespace {
@@ -18,8 +23,30 @@ namespace {
 char const* const quantize_function_signature_template
     = "int quantize({threshold_type} val, unsigned fid)";
 
+// Each feature with thresholds owns a block of threshold[] starting at th_begin[fid]. Slot 0 of
+// the block holds a sentinel (NaN). For a feature with at most max_len_linear_scan thresholds,
+// slots 1..len hold the thresholds. Otherwise, the thresholds are stored in the Eytzinger
+// (breadth-first) layout of a perfect binary search tree of depth th_depth[fid], in which the
+// children of slot k are slots 2k and 2k+1. The tree is padded with NaN, which is never less than
+// the value, so that the padding acts as thresholds above all values and every search takes
+// exactly th_depth[fid] steps. The bin index of a value is (number of thresholds < value) +
+// (number of thresholds <= value), which is 2i+1 for a value equal to the i-th smallest threshold
+// (counting from 0) and even for a value between two thresholds. Bin indices are never negative,
+// so that they cannot be mistaken for the missing-value marker (-1) in data[].
 char const* const quantize_function_template =
     R"TL2CGENTEMPLATE(
+#if defined(__clang__) || defined(__GNUC__)
+#define TRAILING_ONES(x) __builtin_ctz(~(x))
+#else
+static inline int TRAILING_ONES(unsigned x) {{
+  int n = 0;
+  for (; x & 1; x >>= 1) {{
+    ++n;
+  }}
+  return n;
+}}
+#endif
+
 /*
  * \brief Function to convert a feature value into bin index.
  * \param val Feature value, in floating-point
@@ -27,44 +54,42 @@ char const* const quantize_function_template =
  * \return bin Index corresponding to given feature value
  */
 {quantize_function_signature} {{
-  const size_t offset = th_begin[fid];
-  const {threshold_type}* array = &threshold[offset];
-  int len = th_len[fid];
-  int low = 0;
-  int high = len;
-  int mid;
-  {threshold_type} mval;
-  // It is possible th_begin[i] == [total_num_threshold]. This means that
-  // all features i, (i+1), ... are not used for any of the splits in the model.
-  // So in this case, just return something
-  if (offset == {total_num_threshold} || val < array[0]) {{
-    return -10;
-  }}
-  while (low + 1 < high) {{
-    mid = (low + high) / 2;
-    mval = array[mid];
-    if (val == mval) {{
-      return mid * 2;
-    }} else if (val < mval) {{
-      high = mid;
-    }} else {{
-      low = mid;
+  const {threshold_type}* array = &threshold[th_begin[fid]];
+  const unsigned len = th_len[fid];
+  if (len <= {max_len_linear_scan}) {{
+    /* Count the thresholds below the value. The loop has no branch, so that the compiler can
+       vectorize it. */
+    int count = 0;
+    for (unsigned i = 1; i <= len; ++i) {{
+      count += (array[i] < val) + (array[i] <= val);
     }}
+    return count;
   }}
-  if (array[low] == val) {{
-    return low * 2;
-  }} else if (high == len) {{
-    return len * 2;
-  }} else {{
-    return low * 2 + 1;
+  /* Walk down the search tree. The tree is perfect, so the number of steps depends only on the
+     feature, and the comparisons only decide which child to visit next. No branch depends on
+     the value. */
+  const int depth = th_depth[fid];
+  unsigned k = 1;
+  for (int d = 0; d < depth; ++d) {{
+    k = 2 * k + (array[k] < val);
   }}
+  /* Undo the right turns taken after the last left turn, to find the smallest threshold that is
+     not less than the value. k becomes 0 (the sentinel) if there is no such threshold. */
+  k >>= TRAILING_ONES(k) + 1;
+  return lower_bin[th_begin[fid] + k] + (array[k] == val);
 }}
 )TL2CGENTEMPLATE";
 
+// Only the features listed in quantized_feature[], i.e. the features with at least one threshold,
+// are quantized. The trees never read the quantized values of other features.
 char const* const quantize_loop_template =
     R"TL2CGENTEMPLATE(
 // Quantize data
-for (int i = 0; i < {num_feature}; ++i) {{
+static const unsigned quantized_feature[] = {{
+{array_quantized_feature}
+}};
+for (size_t j = 0; j < {num_quantized_feature}; ++j) {{
+  const unsigned i = quantized_feature[j];
   if (data[i].missing != -1 && !is_categorical[i]) {{
     data[i].qvalue = quantize(data[i].fvalue, i);
   }}
@@ -72,6 +97,24 @@ for (int i = 0; i < {num_feature}; ++i) {{
 
 )TL2CGENTEMPLATE";
 
+// The quantized values go into a compact buffer of narrow integers, leaving data[] unchanged.
+// Missing values and categorical features are marked with the minimum value of the type. The
+// entries of features without thresholds are left uninitialized.
+char const* const quantize_loop_narrow_template =
+    R"TL2CGENTEMPLATE(
+// Quantize data
+static const unsigned quantized_feature[] = {{
+{array_quantized_feature}
+}};
+int{bin_width}_t bin[{num_feature}];
+for (size_t j = 0; j < {num_quantized_feature}; ++j) {{
+  const unsigned i = quantized_feature[j];
+  bin[i] = (data[i].missing != -1 && !is_categorical[i])
+           ? (int{bin_width}_t)quantize(data[i].fvalue, i) : INT{bin_width}_MIN;
+}}
+
+)TL2CGENTEMPLATE";
+
 char const* const quantize_arrays_template =
     R"TL2CGENTEMPLATE(
 #include "header.h"
@@ -87,66 +130,138 @@ static const int th_begin[] = {{
 static const int th_len[] = {{
 {array_th_len}
 }};
+
+static const int th_depth[] = {{
+{array_th_depth}
+}};
+
+/* lower_bin[th_begin[fid] + k]: bin index of a value just below the threshold in slot k */
+static const int lower_bin[] = {{
+{array_lower_bin}
+}};
 )TL2CGENTEMPLATE";
 
+// Features with at most this many thresholds are quantized by counting the thresholds below the
+// value, rather than by a search
+constexpr std::size_t kMaxLenLinearScan = 64;
+
+// Find the rank (position in ascending order) of the value held in each slot of the Eytzinger
+// layout of n sorted values. The in-order traversal of the implicit search tree rooted at slot 1
+// visits the slots in ascending order of value.
+void AssignEytzingerRanks(
+    std::size_t k, std::size_t n, std::size_t& next_rank, std::vector<std::size_t>& rank) {
+  if (k > n) {
+    return;
+  }
+  AssignEytzingerRanks(2 * k, n, next_rank, rank);
+  rank[k] = next_rank++;
+  AssignEytzingerRanks(2 * k + 1, n, next_rank, rank);
+}
+
 }  // anonymous namespace
 
 namespace tl2cgen::compiler::detail::codegen {
 
+std::string RenderQuantizeLoop(ast::QuantizerNode const* node) {
+  // List the features with at least one threshold
+  ArrayFormatter quantized_feature_formatter(80, 2);
+  std::size_t const num_quantized_feature = std::visit(
+      [&](auto&& threshold_list_concrete) {
+        std::size_t count = 0;
+        for (std::size_t fid = 0; fid < threshold_list_concrete.size(); ++fid) {
+          if (!threshold_list_concrete[fid].empty()) {
+            quantized_feature_formatter << fid;
+            ++count;
+          }
+        }
+        return count;
+      },
+      node->threshold_list_);
+  if (num_quantized_feature == 0) {
+    return "";
+  }
+  if (node->bin_width_ > 0) {
+    return fmt::format(quantize_loop_narrow_template, "num_feature"_a = node->meta_->num_feature_,
+        "bin_width"_a = node->bin_width_,
+        "array_quantized_feature"_a = quantized_feature_formatter.str(),
+        "num_quantized_feature"_a = num_quantized_feature);
+  }
+  return fmt::format(quantize_loop_template,
+      "array_quantized_feature"_a = quantized_feature_formatter.str(),
+      "num_quantized_feature"_a = num_quantized_feature);
+}
+
 void HandleQuantizerNode(ast::QuantizerNode const* node, CodeCollection& gencode) {
   auto threshold_ctype_str = GetThresholdCType(node);
   /* Render arrays needed to convert feature values into bin indices */
-  std::string array_threshold, array_th_begin, array_th_len;
-  // threshold[] : List of all thresholds that occur at least once in the
-  //   ensemble model. For each feature, an ascending list of unique
-  //   thresholds is generated. The range th_begin[i]:(th_begin[i]+th_len[i])
-  //   of the threshold[] array stores the threshold list for feature i.
-  std::size_t total_num_threshold;
-  // to hold total number of (distinct) thresholds
-  {
-    ArrayFormatter formatter(80, 2);
-    std::visit(
-        [&](auto&& threshold_list_concrete) {
-          for (auto const& e : threshold_list_concrete) {
-            // threshold_list had been generated in ASTBuilder::QuantizeThresholds
-            // threshold_list[i][k] stores the k-th threshold of feature i.
-            for (auto v : e) {
-              formatter << v;
+  // threshold[] : For each feature with at least one threshold, a block holding a sentinel
+  //   followed by the distinct thresholds of the feature, either in ascending order (at most
+  //   kMaxLenLinearScan thresholds) or in the Eytzinger layout of a perfect binary search tree
+  //   padded with NaN. The block of feature i starts at th_begin[i].
+  // th_len[] : Number of distinct thresholds of each feature
+  // th_depth[] : Depth of the search tree of each feature; 0 if the thresholds are scanned
+  // lower_bin[] : Bin index of a value just below each element of threshold[]. For the
+  //   sentinel and the padding, this is the bin index of a value above all thresholds of the
+  //   feature.
+  ArrayFormatter threshold_formatter(80, 2);
+  ArrayFormatter th_begin_formatter(80, 2);
+  ArrayFormatter th_len_formatter(80, 2);
+  ArrayFormatter th_depth_formatter(80, 2);
+  ArrayFormatter lower_bin_formatter(80, 2);
+  std::size_t offset = 0;
+  std::visit(
+      [&](auto&& threshold_list_concrete) {
+        for (auto const& e : threshold_list_concrete) {
+          // threshold_list had been generated in ASTBuilder::QuantizeThresholds
+          // threshold_list[i][k] stores the k-th smallest threshold of feature i.
+          std::size_t const num_threshold = e.size();
+          std::size_t depth = 0;
+          std::size_t num_slot = num_threshold;
+          if (num_threshold > kMaxLenLinearScan) {
+            while ((std::size_t{1} << depth) - 1 < num_threshold) {
+              ++depth;
             }
+            num_slot = (std::size_t{1} << depth) - 1;
           }
-        },
-        node->threshold_list_);
-    array_threshold = formatter.str();
-  }
-  {
-    ArrayFormatter formatter(80, 2);
-    std::size_t accum = 0;  // used to compute cumulative sum over threshold counts
-    std::visit(
-        [&](auto&& threshold_list_concrete) {
-          for (auto const& e : threshold_list_concrete) {
-            formatter << accum;
-            accum += e.size();  // e.size() = number of thresholds for each feature
+          th_begin_formatter << offset;
+          th_len_formatter << num_threshold;
+          th_depth_formatter << depth;
+          if (e.empty()) {
+            continue;
           }
-        },
-        node->threshold_list_);
-    total_num_threshold = accum;
-    array_th_begin = formatter.str();
-  }
-  {
-    ArrayFormatter formatter(80, 2);
-    std::visit(
-        [&](auto&& threshold_list_concrete) {
-          for (auto const& e : threshold_list_concrete) {
-            formatter << e.size();
+          threshold_formatter << std::string("NAN");
+          lower_bin_formatter << 2 * num_threshold;
+          if (depth == 0) {
+            for (std::size_t k = 0; k < num_threshold; ++k) {
+              threshold_formatter << e[k];
+              lower_bin_formatter << 2 * k;
+            }
+          } else {
+            std::vector<std::size_t> rank(num_slot + 1, 0);
+            std::size_t next_rank = 0;
+            AssignEytzingerRanks(1, num_slot, next_rank, rank);
+            for (std::size_t k = 1; k <= num_slot; ++k) {
+              if (rank[k] < num_threshold) {
+                threshold_formatter << e[rank[k]];
+                lower_bin_formatter << 2 * rank[k];
+              } else {
+                threshold_formatter << std::string("NAN");
+                lower_bin_formatter << 2 * num_threshold;
+              }
+            }
           }
-        },
-        node->threshold_list_);
-    array_th_len = formatter.str();
-  }
+          offset += num_slot + 1;
+        }
+      },
+      node->threshold_list_);
+  std::string const array_threshold = threshold_formatter.str();
+  std::string const array_th_begin = th_begin_formatter.str();
+  std::string const array_th_len = th_len_formatter.str();
+  std::string const array_th_depth = th_depth_formatter.str();
+  std::string const array_lower_bin = lower_bin_formatter.str();
   auto current_file = gencode.GetCurrentSourceFile();
   if (!array_threshold.empty() && !array_th_begin.empty() && !array_th_len.empty()) {
-    gencode.PushFragment(
-        fmt::format(quantize_loop_template, "num_feature"_a = node->meta_->num_feature_));
+    gencode.PushFragment(RenderQuantizeLoop(node));
 
     gencode.SwitchToSourceFile("header.h");
     std::string const quantize_function_signature = fmt::format(
@@ -156,10 +271,13 @@ void HandleQuantizerNode(ast::QuantizerNode const* node, CodeCollection& gencode
     gencode.SwitchToSourceFile("quantize.c");
     gencode.PushFragment(fmt::format(quantize_arrays_template,
         "array_threshold"_a = array_threshold, "threshold_type"_a = threshold_ctype_str,
-        "array_th_begin"_a = array_th_begin, "array_th_len"_a = array_th_len));
+        "array_th_begin"_a = array_th_begin, "array_th_len"_a = array_th_len,
+        "array_th_depth"_a = array_th_depth,
+        "array_lower_bin"_a = array_lower_bin));
     gencode.PushFragment(fmt::format(quantize_function_template,
         "quantize_function_signature"_a = quantize_function_signature,
-        "total_num_threshold"_a = total_num_threshold, "threshold_type"_a = threshold_ctype_str));
+        "threshold_type"_a = threshold_ctype_str,
+        "max_len_linear_scan"_a = kMaxLenLinearScan));
     gencode.SwitchToSourceFile(current_file);  // Switch back context
   }
   TL2CGEN_CHECK_EQ(node->children_.size(), 1);
@@ -0,0 +1,311 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file quickscorer_node.cc
+ * \brief Convert QuickScorerNode in AST into C code
+ * \author Hyunsu Cho
+ */
+
+#include <fmt/format.h>
+#include <tl2cgen/detail/compiler/ast/ast.h>
+#include <tl2cgen/detail/compiler/codegen/codegen.h>
+#include <tl2cgen/detail/compiler/codegen/table_util.h>
+#include <tl2cgen/logging.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using namespace fmt::literals;
+
+namespace {
+
+namespace ast = tl2cgen::compiler::detail::ast;
+namespace codegen = tl2cgen::compiler::detail::codegen;
+
+char const* const qs_function_name_template = "predict_quickscorer{layout_id}";
+char const* const qs_function_signature_template
+    = "void {qs_function_name}(union Entry* data, {leaf_output_ctype}* RESTRICT result)";
+
+char const* const qs_source_template =
+    R"TL2CGENTEMPLATE(
+#include "header.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CTZ64(x) __builtin_ctzll(x)
+#elif defined(_MSC_VER) && defined(_WIN64)
+#include <intrin.h>
+static __inline int CTZ64(uint64_t x) {{
+  unsigned long index;
+  _BitScanForward64(&index, x);
+  return (int)index;
+}}
+#else
+static int CTZ64(uint64_t x) {{
+  int index = 0;
+  while (!(x & 1)) {{
+    x >>= 1;
+    ++index;
+  }}
+  return index;
+}}
+#endif
+
+/*
+ * Leaves of each tree are numbered from left to right. The set of leaves that remain reachable
+ * is tracked as a bitvector of {num_word} 64-bit word(s) per tree; the exit leaf is the lowest
+ * set bit. All test nodes are normalized into the form (feature value < threshold).
+ *
+ * Test nodes are grouped by feature and sorted by threshold. For the i-th used feature
+ * feature_id[i], its test nodes are stored in [test_begin[i], test_begin[i+1]):
+ *   test_threshold[k]: threshold of the test
+ *   test_tree[k]: tree that contains the test
+ *   test_mask[k]: bitvector that clears the leaves in the left subtree of the test
+ * If the feature value is missing, the masks in [missing_begin[i], missing_begin[i+1]) are
+ * applied instead. These belong to the tests that send missing values to the right.
+ */
+static const int32_t feature_id[] = {{
+{array_feature_id}
+}};
+
+static const int32_t test_begin[] = {{
+{array_test_begin}
+}};
+
+static const {threshold_array_ctype} test_threshold[] = {{
+{array_test_threshold}
+}};
+
+static const int32_t test_tree[] = {{
+{array_test_tree}
+}};
+
+static const uint64_t test_mask[] = {{
+{array_test_mask}
+}};
+
+static const int32_t missing_begin[] = {{
+{array_missing_begin}
+}};
+
+static const int32_t missing_tree[] = {{
+{array_missing_tree}
+}};
+
+static const uint64_t missing_mask[] = {{
+{array_missing_mask}
+}};
+
+/* leaf_begin[t]: ID of the leftmost leaf of tree t */
+static const int32_t leaf_begin[] = {{
+{array_leaf_begin}
+}};
+
+{leaf_arrays}
+{qs_function_signature} {{
+  uint64_t leafset[{num_tree} * {num_word}];
+  memset(leafset, 0xFF, sizeof(leafset));
+  for (int i = 0; i < {num_feature_used}; ++i) {{
+    const union Entry* x = &data[feature_id[i]];
+    if (x->missing == -1) {{
+      for (int k = missing_begin[i]; k < missing_begin[i + 1]; ++k) {{
+{apply_missing_mask}
+      }}
+    }} else {{
+      /* Every test with threshold <= feature value evaluates to false */
+      for (int k = test_begin[i]; k < test_begin[i + 1] && test_threshold[k] <= x->{value_field};
+           ++k) {{
+{apply_test_mask}
+      }}
+    }}
+  }}
+  for (int tree_id = 0; tree_id < {num_tree}; ++tree_id) {{
+{find_exit_leaf}
+{accumulate_leaf}
+  }}
+}}
+)TL2CGENTEMPLATE";
+
+// Test nodes of a group of trees, along with the leaf ranges of their left subtrees
+template <typename ThresholdType, typename LeafOutputType>
+class QuickScorerLayout {
+ public:
+  struct TestNode {
+    std::uint32_t split_index;
+    codegen::NormalizedNumericalTest<ThresholdType> test;
+    std::int32_t tree_id;
+    // Leaves in the left subtree, numbered relative to the leftmost leaf of the tree
+    std::int32_t left_leaf_begin;
+    std::int32_t left_leaf_end;
+  };
+
+  QuickScorerLayout(ast::ModelMeta const& meta, bool quantized)
+      : quantized_(quantized), leaf_(meta) {}
+
+  void AddTree(ast::ASTNode const* tree_head) {
+    leaf_.AddTree();
+    leaf_begin_.push_back(static_cast<std::int32_t>(leaf_.leaf_value_.size() / leaf_.leaf_len_));
+    auto const [begin, end] = Visit(tree_head, static_cast<std::int32_t>(leaf_begin_.size() - 1));
+    TL2CGEN_CHECK_EQ(begin, 0);
+    max_num_leaf_ = std::max(max_num_leaf_, end);
+  }
+
+  // Sort the test nodes by feature, then by threshold
+  void SortTests() {
+    std::stable_sort(test_.begin(), test_.end(), [&](TestNode const& a, TestNode const& b) {
+      if (a.split_index != b.split_index) {
+        return a.split_index < b.split_index;
+      }
+      return quantized_ ? (a.test.quantized_threshold < b.test.quantized_threshold)
+                        : (a.test.threshold < b.test.threshold);
+    });
+  }
+
+  // Bitvector (of num_word words) that clears the leaves in the left subtree of a test node
+  std::vector<std::uint64_t> GetMask(TestNode const& node, std::int32_t num_word) const {
+    std::vector<std::uint64_t> mask(num_word, ~std::uint64_t(0));
+    for (std::int32_t i = node.left_leaf_begin; i < node.left_leaf_end; ++i) {
+      mask[i / 64] &= ~(std::uint64_t(1) << (i % 64));
+    }
+    return mask;
+  }
+
+  bool quantized_;
+  codegen::LeafOutputTable<LeafOutputType> leaf_;
+  std::vector<TestNode> test_;
+  std::vector<std::int32_t> leaf_begin_;  // leaf_begin_[t]: ID of the leftmost leaf of tree t
+  std::int32_t max_num_leaf_{0};
+
+ private:
+  // Returns the range of leaves in the subtree, numbered relative to the leftmost leaf of the tree
+  std::pair<std::int32_t, std::int32_t> Visit(ast::ASTNode const* node, std::int32_t tree_id) {
+    if (auto const* output_node = dynamic_cast<ast::OutputNode const*>(node)) {
+      std::int32_t const leaf_id = leaf_.AddLeaf(output_node) - leaf_begin_[tree_id];
+      return {leaf_id, leaf_id + 1};
+    }
+    auto const* num_cond = dynamic_cast<ast::NumericalConditionNode const*>(node);
+    TL2CGEN_CHECK(num_cond) << "QuickScorer only supports numerical tests";
+    auto const test = codegen::NormalizeNumericalTest<ThresholdType>(num_cond, quantized_);
+    if (test.bypass) {
+      return Visit(test.bypass, tree_id);
+    }
+    TL2CGEN_CHECK(!test.equality_test) << "QuickScorer does not support equality tests";
+    auto const left = Visit(test.left_child, tree_id);
+    auto const right = Visit(test.right_child, tree_id);
+    test_.push_back({num_cond->split_index_, test, tree_id, left.first, left.second});
+    return {left.first, right.second};
+  }
+};
+
+}  // anonymous namespace
+
+namespace tl2cgen::compiler::detail::codegen {
+
+void HandleQuickScorerNode(ast::QuickScorerNode const* node, CodeCollection& gencode) {
+  auto const threshold_ctype_str = GetThresholdCType(node);
+  auto const leaf_output_ctype_str = GetLeafOutputCType(node);
+  bool const quantized = IsInputQuantized(node);
+  std::string const qs_function_name
+      = fmt::format(qs_function_name_template, "layout_id"_a = node->layout_id_);
+  std::string const qs_function_signature = fmt::format(qs_function_signature_template,
+      "qs_function_name"_a = qs_function_name, "leaf_output_ctype"_a = leaf_output_ctype_str);
+
+  std::string qs_source = std::visit(
+      [&](auto&& meta) {
+        using TypeMetaT = std::remove_const_t<std::remove_reference_t<decltype(meta)>>;
+        using ThresholdT = typename TypeMetaT::threshold_type;
+        using LeafOutputT = typename TypeMetaT::leaf_output_type;
+        QuickScorerLayout<ThresholdT, LeafOutputT> layout(*node->meta_, quantized);
+        for (ast::ASTNode const* tree_head : node->children_) {
+          layout.AddTree(tree_head);
+        }
+        layout.SortTests();
+        std::int32_t const num_word = std::max((layout.max_num_leaf_ + 63) / 64, 1);
+
+        std::vector<std::int32_t> feature_id, test_begin, test_tree, missing_begin, missing_tree;
+        std::vector<std::string> test_threshold;
+        std::vector<std::uint64_t> test_mask, missing_mask;
+        for (std::size_t k = 0; k < layout.test_.size(); ++k) {
+          auto const& e = layout.test_[k];
+          if (k == 0 || e.split_index != layout.test_[k - 1].split_index) {
+            feature_id.push_back(static_cast<std::int32_t>(e.split_index));
+            test_begin.push_back(static_cast<std::int32_t>(test_tree.size()));
+            missing_begin.push_back(static_cast<std::int32_t>(missing_tree.size()));
+          }
+          std::vector<std::uint64_t> const mask = layout.GetMask(e, num_word);
+          test_threshold.push_back(RenderThreshold(e.test, quantized));
+          test_tree.push_back(e.tree_id);
+          test_mask.insert(test_mask.end(), mask.begin(), mask.end());
+          if (!e.test.default_left) {
+            missing_tree.push_back(e.tree_id);
+            missing_mask.insert(missing_mask.end(), mask.begin(), mask.end());
+          }
+        }
+        test_begin.push_back(static_cast<std::int32_t>(test_tree.size()));
+        missing_begin.push_back(static_cast<std::int32_t>(missing_tree.size()));
+
+        std::string apply_test_mask, apply_missing_mask, find_exit_leaf;
+        if (num_word == 1) {
+          apply_test_mask = "        leafset[test_tree[k]] &= test_mask[k];";
+          apply_missing_mask = "        leafset[missing_tree[k]] &= missing_mask[k];";
+          find_exit_leaf
+              = "    const int leaf_id = leaf_begin[tree_id] + CTZ64(leafset[tree_id]);";
+        } else {
+          apply_test_mask = fmt::format(
+              "        for (int w = 0; w < {num_word}; ++w) {{\n"
+              "          leafset[test_tree[k] * {num_word} + w] &= test_mask[k * {num_word} + w];\n"
+              "        }}",
+              "num_word"_a = num_word);
+          apply_missing_mask = fmt::format(
+              "        for (int w = 0; w < {num_word}; ++w) {{\n"
+              "          leafset[missing_tree[k] * {num_word} + w]\n"
+              "              &= missing_mask[k * {num_word} + w];\n"
+              "        }}",
+              "num_word"_a = num_word);
+          find_exit_leaf = fmt::format(
+              "    const uint64_t* tree_leafset = &leafset[tree_id * {num_word}];\n"
+              "    int w = 0;\n"
+              "    while (tree_leafset[w] == 0) {{\n"
+              "      ++w;\n"
+              "    }}\n"
+              "    const int leaf_id = leaf_begin[tree_id] + 64 * w + CTZ64(tree_leafset[w]);",
+              "num_word"_a = num_word);
+        }
+
+        return fmt::format(qs_source_template, "num_word"_a = num_word,
+            "array_feature_id"_a = RenderArray(feature_id),
+            "array_test_begin"_a = RenderArray(test_begin),
+            "threshold_array_ctype"_a = (quantized ? "int" : threshold_ctype_str),
+            "array_test_threshold"_a = RenderArray(test_threshold),
+            "array_test_tree"_a = RenderArray(test_tree),
+            "array_test_mask"_a = RenderArray(test_mask),
+            "array_missing_begin"_a = RenderArray(missing_begin),
+            "array_missing_tree"_a = RenderArray(missing_tree),
+            "array_missing_mask"_a = RenderArray(missing_mask),
+            "array_leaf_begin"_a = RenderArray(layout.leaf_begin_),
+            "leaf_arrays"_a = layout.leaf_.RenderArrays(leaf_output_ctype_str),
+            "qs_function_signature"_a = qs_function_signature,
+            "num_tree"_a = node->children_.size(), "num_feature_used"_a = feature_id.size(),
+            "value_field"_a = (quantized ? "qvalue" : "fvalue"),
+            "apply_test_mask"_a = apply_test_mask, "apply_missing_mask"_a = apply_missing_mask,
+            "find_exit_leaf"_a = find_exit_leaf,
+            "accumulate_leaf"_a = layout.leaf_.RenderAccumulation("leaf_id", 4));
+      },
+      node->meta_->type_meta_);
+
+  auto current_file = gencode.GetCurrentSourceFile();
+  gencode.PushFragment(
+      fmt::format("{qs_function_name}(data, result);", "qs_function_name"_a = qs_function_name));
+  gencode.SwitchToSourceFile("header.h");
+  gencode.PushFragment(fmt::format("{};", qs_function_signature));
+  gencode.SwitchToSourceFile(
+      fmt::format("quickscorer{layout_id}.c", "layout_id"_a = node->layout_id_));
+  gencode.PushFragment(qs_source);
+  gencode.SwitchToSourceFile(current_file);  // Switch back context
+}
+
+}  // namespace tl2cgen::compiler::detail::codegen
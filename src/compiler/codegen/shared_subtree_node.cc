@@ -0,0 +1,56 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file shared_subtree_node.cc
+ * \brief Convert SharedSubtreeNode in AST into C code
+ * \author Hyunsu Cho
+ */
+
+#include <fmt/format.h>
+#include <tl2cgen/detail/compiler/ast/ast.h>
+#include <tl2cgen/detail/compiler/codegen/codegen.h>
+#include <tl2cgen/logging.h>
+
+#include <string>
+
+using namespace fmt::literals;
+
+namespace {
+
+char const* const shared_function_name_template = "predict_shared{func_id}";
+char const* const shared_function_start_template =
+    R"TL2CGENTEMPLATE(
+static inline void {shared_function_name}({params}) {{
+)TL2CGENTEMPLATE";
+
+}  // anonymous namespace
+
+namespace tl2cgen::compiler::detail::codegen {
+
+void HandleSharedSubtreeNode(ast::SharedSubtreeNode const* node, CodeCollection& gencode) {
+  std::string const shared_function_name
+      = fmt::format(shared_function_name_template, "func_id"_a = node->func_id_)
+        + gencode.GetFunctionSuffix();
+  gencode.PushFragment(fmt::format("{shared_function_name}({args});",
+      "shared_function_name"_a = shared_function_name, "args"_a = GetTreeFunctionArgs(node)));
+  if (node->definition_) {
+    TL2CGEN_CHECK_EQ(node->children_.size(), 0);
+    return;
+  }
+  TL2CGEN_CHECK_EQ(node->children_.size(), 1);
+
+  // The shared function is defined in the header, so that every translation unit can use it and
+  // the C compiler remains free to inline it.
+  auto current_file = gencode.GetCurrentSourceFile();
+  gencode.SwitchToSourceFile("header.h");
+  gencode.PushFragment(fmt::format(shared_function_start_template,
+      "shared_function_name"_a = shared_function_name,
+      "params"_a = GetTreeFunctionParams(node)));
+  gencode.ChangeIndent(1);
+  gencode.PushFragment("unsigned int tmp;");
+  GenerateCodeFromAST(node->children_[0], gencode);
+  gencode.ChangeIndent(-1);
+  gencode.PushFragment("}");
+  gencode.SwitchToSourceFile(current_file);  // Switch back context
+}
+
+}  // namespace tl2cgen::compiler::detail::codegen
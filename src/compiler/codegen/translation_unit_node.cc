@@ -16,11 +16,9 @@ namespace {
 
 char const* const unit_function_name_template = "predict_unit{unit_id}";
 char const* const unit_function_signature_template
-    = "void {unit_function_name}(union Entry* data, {leaf_output_type}* result)";
+    = "void {unit_function_name}({params})";
 char const* const unit_source_start_template =
     R"TL2CGENTEMPLATE(
-#include "header.h"
-
 {unit_function_signature} {{
 )TL2CGENTEMPLATE";
 
@@ -30,22 +28,37 @@ namespace tl2cgen::compiler::detail::codegen {
 
 void HandleTranslationUnitNode(ast::TranslationUnitNode const* node, CodeCollection& gencode) {
   TL2CGEN_CHECK_EQ(node->children_.size(), 1);
-  auto leaf_output_ctype_str = GetLeafOutputCType(node);
   std::string const unit_function_name
-      = fmt::format(unit_function_name_template, "unit_id"_a = node->unit_id_);
+      = fmt::format(unit_function_name_template, "unit_id"_a = node->unit_id_)
+        + gencode.GetFunctionSuffix();
   std::string const unit_function_signature = fmt::format(unit_function_signature_template,
-      "unit_function_name"_a = unit_function_name, "leaf_output_type"_a = leaf_output_ctype_str);
+      "unit_function_name"_a = unit_function_name, "params"_a = GetTreeFunctionParams(node));
 
   auto current_file = gencode.GetCurrentSourceFile();
-  gencode.PushFragment(fmt::format(
-      "{unit_function_name}(data, result);", "unit_function_name"_a = unit_function_name));
+  gencode.PushFragment(fmt::format("{unit_function_name}({args});",
+      "unit_function_name"_a = unit_function_name, "args"_a = GetTreeFunctionArgs(node)));
   gencode.SwitchToSourceFile("header.h");
   gencode.PushFragment(fmt::format("{};", unit_function_signature));
-  gencode.SwitchToSourceFile(fmt::format("tu{unit_id}.c", "unit_id"_a = node->unit_id_));
+  std::string const unit_source_file
+      = fmt::format("tu{unit_id}.c", "unit_id"_a = node->unit_id_);
+  bool const new_source_file = !gencode.HasSourceFile(unit_source_file);
+  gencode.SwitchToSourceFile(unit_source_file);
+  if (new_source_file) {
+    gencode.PushFragment("\n#include \"header.h\"");
+  }
   gencode.PushFragment(fmt::format(
       unit_source_start_template, "unit_function_signature"_a = unit_function_signature));
   gencode.ChangeIndent(1);
+  bool const local_accumulator = HasInlineOutput(node->children_[0]);
+  if (local_accumulator) {
+    gencode.PushFragment(RenderLocalAccumulatorStart(node));
+    gencode.ChangeIndent(1);
+  }
   GenerateCodeFromAST(node->children_[0], gencode);
+  if (local_accumulator) {
+    gencode.ChangeIndent(-1);
+    gencode.PushFragment(RenderLocalAccumulatorEnd());
+  }
   gencode.ChangeIndent(-1);
   gencode.PushFragment("}");
   gencode.SwitchToSourceFile(current_file);  // Switch back context
@@ -0,0 +1,72 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file tree_function_node.cc
+ * \brief Convert TreeFunctionNode in AST into C code
+ * \author Hyunsu Cho
+ */
+
+#include <fmt/format.h>
+#include <tl2cgen/detail/compiler/ast/ast.h>
+#include <tl2cgen/detail/compiler/codegen/codegen.h>
+#include <tl2cgen/logging.h>
+
+#include <string>
+
+using namespace fmt::literals;
+
+namespace {
+
+namespace ast = tl2cgen::compiler::detail::ast;
+
+char const* const tree_function_name_template = "predict_tree{tree_id}";
+char const* const tree_function_signature_template
+    = "void {tree_function_name}({params})";
+char const* const tree_source_start_template =
+    R"TL2CGENTEMPLATE(
+{tree_function_signature} {{
+)TL2CGENTEMPLATE";
+
+// Tree functions are collected in a separate source file for each translation unit
+std::string GetTreeSourceFile(ast::ASTNode const* node) {
+  for (ast::ASTNode const* p = node->parent_; p; p = p->parent_) {
+    if (auto const* tu = dynamic_cast<ast::TranslationUnitNode const*>(p)) {
+      return fmt::format("tree{unit_id}.c", "unit_id"_a = tu->unit_id_);
+    }
+  }
+  return "tree.c";
+}
+
+}  // anonymous namespace
+
+namespace tl2cgen::compiler::detail::codegen {
+
+void HandleTreeFunctionNode(ast::TreeFunctionNode const* node, CodeCollection& gencode) {
+  TL2CGEN_CHECK_EQ(node->children_.size(), 1);
+  std::string const tree_function_name
+      = fmt::format(tree_function_name_template, "tree_id"_a = node->tree_id_)
+        + gencode.GetFunctionSuffix();
+  std::string const tree_function_signature = fmt::format(tree_function_signature_template,
+      "tree_function_name"_a = tree_function_name, "params"_a = GetTreeFunctionParams(node));
+
+  auto current_file = gencode.GetCurrentSourceFile();
+  gencode.PushFragment(fmt::format("{tree_function_name}({args});",
+      "tree_function_name"_a = tree_function_name, "args"_a = GetTreeFunctionArgs(node)));
+  gencode.SwitchToSourceFile("header.h");
+  gencode.PushFragment(fmt::format("{};", tree_function_signature));
+  std::string const tree_source_file = GetTreeSourceFile(node);
+  bool const new_source_file = !gencode.HasSourceFile(tree_source_file);
+  gencode.SwitchToSourceFile(tree_source_file);
+  if (new_source_file) {
+    gencode.PushFragment("\n#include \"header.h\"");
+  }
+  gencode.PushFragment(fmt::format(
+      tree_source_start_template, "tree_function_signature"_a = tree_function_signature));
+  gencode.ChangeIndent(1);
+  gencode.PushFragment("unsigned int tmp;");
+  GenerateCodeFromAST(node->children_[0], gencode);
+  gencode.ChangeIndent(-1);
+  gencode.PushFragment("}");
+  gencode.SwitchToSourceFile(current_file);  // Switch back context
+}
+
+}  // namespace tl2cgen::compiler::detail::codegen
@@ -13,6 +13,7 @@
 #include <tl2cgen/detail/filesystem.h>
 #include <treelite/tree.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <string>
@@ -38,11 +39,54 @@ detail::ast::ASTBuilder LowerToAST(
     auto const annotation = annotator.Get();
     builder.LoadDataCounts(annotation);
   }
+  if (param.leaf_output_precision != "native") {
+    builder.ReduceLeafOutputPrecision(param.leaf_output_precision);
+  }
+  if (param.prune_redundant_tests > 0) {
+    builder.PruneRedundantTests();
+  }
+  if (param.dedup_subtrees > 0 && param.tree_functions == 0) {
+    // Folding removes trees, which would change the meaning of a range of trees
+    builder.FoldConstantTrees();
+  }
   builder.SplitIntoTUs(param.parallel_comp);
+  if (param.dedup_subtrees > 0) {
+    builder.ShareDuplicateSubtrees();
+  }
+  if (param.annotate_in != "NULL" && param.tree_layout == "if_else") {
+    builder.OutlineColdSubtrees();
+  }
+  if (param.tree_functions > 0) {
+    builder.GenerateTreeFunctions();
+  }
+  if (param.tree_layout == "array") {
+    builder.ConvertToArrayLayout(std::max(param.interleave_trees, 1));
+  } else if (param.tree_layout == "quickscorer") {
+    builder.ConvertToQuickScorer();
+  }
+  builder.GenerateCategoricalBitmapTable();
   if (param.quantize > 0) {
     builder.GenerateIsCategoricalArray();
     builder.QuantizeThresholds();
   }
+  if (param.integer_compare > 0) {
+    builder.EnableIntegerComparisons();
+  }
+  if (param.branchless_depth > 0) {
+    builder.ConvertToBranchlessSubtrees(param.branchless_depth);
+  }
+  if (param.simd > 0) {
+    builder.EnableSIMDKernels();
+  }
+  if (param.missing_fast_path > 0) {
+    builder.GenerateMissingFastPath();
+  }
+  if (param.fast_math_postprocess > 0) {
+    builder.EnableFastMathPostprocessor();
+  }
+  if (param.narrow_thresholds > 0) {
+    builder.NarrowThresholds();
+  }
   return builder;
 }
 
@@ -36,10 +36,84 @@ CompilerParam CompilerParam::ParseFromJSON(char const* param_json_str) {
     } else if (key == "native_lib_name") {
       TL2CGEN_CHECK(e.value.IsString()) << "Expected a string for 'native_lib_name'";
       param.native_lib_name = e.value.GetString();
+    } else if (key == "tree_layout") {
+      TL2CGEN_CHECK(e.value.IsString()) << "Expected a string for 'tree_layout'";
+      param.tree_layout = e.value.GetString();
+      TL2CGEN_CHECK(param.tree_layout == "if_else" || param.tree_layout == "array"
+                    || param.tree_layout == "quickscorer")
+          << "'tree_layout' must be one of: 'if_else', 'array', 'quickscorer'";
+    } else if (key == "simd") {
+      TL2CGEN_CHECK(e.value.IsInt()) << "Expected an integer for 'simd'";
+      param.simd = e.value.GetInt();
+      TL2CGEN_CHECK_GE(param.simd, 0) << "'simd' must be 0 or greater";
+    } else if (key == "branchless_depth") {
+      TL2CGEN_CHECK(e.value.IsInt()) << "Expected an integer for 'branchless_depth'";
+      param.branchless_depth = e.value.GetInt();
+      TL2CGEN_CHECK(param.branchless_depth >= 0 && param.branchless_depth <= 8)
+          << "'branchless_depth' must be between 0 and 8";
+    } else if (key == "interleave_trees") {
+      TL2CGEN_CHECK(e.value.IsInt()) << "Expected an integer for 'interleave_trees'";
+      param.interleave_trees = e.value.GetInt();
+      TL2CGEN_CHECK(param.interleave_trees >= 0 && param.interleave_trees <= 16)
+          << "'interleave_trees' must be between 0 and 16";
+    } else if (key == "integer_compare") {
+      TL2CGEN_CHECK(e.value.IsInt()) << "Expected an integer for 'integer_compare'";
+      param.integer_compare = e.value.GetInt();
+      TL2CGEN_CHECK_GE(param.integer_compare, 0) << "'integer_compare' must be 0 or greater";
+    } else if (key == "tree_functions") {
+      TL2CGEN_CHECK(e.value.IsInt()) << "Expected an integer for 'tree_functions'";
+      param.tree_functions = e.value.GetInt();
+      TL2CGEN_CHECK_GE(param.tree_functions, 0) << "'tree_functions' must be 0 or greater";
+    } else if (key == "dedup_subtrees") {
+      TL2CGEN_CHECK(e.value.IsInt()) << "Expected an integer for 'dedup_subtrees'";
+      param.dedup_subtrees = e.value.GetInt();
+      TL2CGEN_CHECK_GE(param.dedup_subtrees, 0) << "'dedup_subtrees' must be 0 or greater";
+    } else if (key == "missing_fast_path") {
+      TL2CGEN_CHECK(e.value.IsInt()) << "Expected an integer for 'missing_fast_path'";
+      param.missing_fast_path = e.value.GetInt();
+      TL2CGEN_CHECK_GE(param.missing_fast_path, 0) << "'missing_fast_path' must be 0 or greater";
+    } else if (key == "fast_math_postprocess") {
+      TL2CGEN_CHECK(e.value.IsInt()) << "Expected an integer for 'fast_math_postprocess'";
+      param.fast_math_postprocess = e.value.GetInt();
+      TL2CGEN_CHECK_GE(param.fast_math_postprocess, 0)
+          << "'fast_math_postprocess' must be 0 or greater";
+    } else if (key == "leaf_output_precision") {
+      TL2CGEN_CHECK(e.value.IsString()) << "Expected a string for 'leaf_output_precision'";
+      param.leaf_output_precision = e.value.GetString();
+      TL2CGEN_CHECK(param.leaf_output_precision == "native"
+                    || param.leaf_output_precision == "float16"
+                    || param.leaf_output_precision == "bfloat16"
+                    || param.leaf_output_precision == "int16")
+          << "'leaf_output_precision' must be one of: 'native', 'float16', 'bfloat16', 'int16'";
+    } else if (key == "narrow_thresholds") {
+      TL2CGEN_CHECK(e.value.IsInt()) << "Expected an integer for 'narrow_thresholds'";
+      param.narrow_thresholds = e.value.GetInt();
+      TL2CGEN_CHECK_GE(param.narrow_thresholds, 0) << "'narrow_thresholds' must be 0 or greater";
+    } else if (key == "prune_redundant_tests") {
+      TL2CGEN_CHECK(e.value.IsInt()) << "Expected an integer for 'prune_redundant_tests'";
+      param.prune_redundant_tests = e.value.GetInt();
+      TL2CGEN_CHECK_GE(param.prune_redundant_tests, 0)
+          << "'prune_redundant_tests' must be 0 or greater";
     } else {
       TL2CGEN_LOG(FATAL) << "Unrecognized key '" << key << "' in JSON";
     }
   }
+  TL2CGEN_CHECK(param.simd == 0 || param.tree_layout == "array")
+      << "'simd' requires 'tree_layout' to be 'array'";
+  TL2CGEN_CHECK(param.branchless_depth == 0 || param.tree_layout == "if_else")
+      << "'branchless_depth' requires 'tree_layout' to be 'if_else'";
+  TL2CGEN_CHECK(param.interleave_trees <= 1 || param.tree_layout == "array")
+      << "'interleave_trees' requires 'tree_layout' to be 'array'";
+  TL2CGEN_CHECK(param.integer_compare == 0 || param.tree_layout == "if_else")
+      << "'integer_compare' requires 'tree_layout' to be 'if_else'";
+  TL2CGEN_CHECK(param.tree_functions == 0 || param.tree_layout == "if_else")
+      << "'tree_functions' requires 'tree_layout' to be 'if_else'";
+  TL2CGEN_CHECK(param.dedup_subtrees == 0 || param.tree_layout == "if_else")
+      << "'dedup_subtrees' requires 'tree_layout' to be 'if_else'";
+  TL2CGEN_CHECK(param.missing_fast_path == 0 || param.tree_layout == "if_else")
+      << "'missing_fast_path' requires 'tree_layout' to be 'if_else'";
+  TL2CGEN_CHECK(param.narrow_thresholds == 0 || param.tree_layout == "array")
+      << "'narrow_thresholds' requires 'tree_layout' to be 'array'";
 
   return param;
 }
@@ -0,0 +1,433 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file jit.cc
+ * \brief Compile a tree model into machine code in memory, using libgccjit
+ * \author Hyunsu Cho
+ */
+#include <tl2cgen/compiler.h>
+#include <tl2cgen/compiler_param.h>
+#include <tl2cgen/detail/compiler/ast/builder.h>
+#include <tl2cgen/detail/operator_comp.h>
+#include <tl2cgen/detail/predictor/finish_prediction.h>
+#include <tl2cgen/detail/predictor/shared_library.h>
+#include <tl2cgen/logging.h>
+#include <treelite/enum/operator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#ifdef TL2CGEN_USE_GCCJIT
+#include <libgccjit.h>
+#endif
+
+#ifdef TL2CGEN_USE_GCCJIT
+
+namespace {
+
+namespace ast = tl2cgen::compiler::detail::ast;
+using tl2cgen::predictor::detail::PredictionFinisher;
+using tl2cgen::predictor::detail::SharedLibrary;
+
+// Optimization level for libgccjit. The compile time grows quickly with the level for the large
+// functions produced from tree models, and -O1 already lays out the branches well.
+constexpr int kOptimizationLevel = 1;
+
+// Functions exported by the compiled module
+char const* const kExportedFunctions[] = {"get_num_target", "get_num_class", "get_num_feature",
+    "get_threshold_type", "get_leaf_output_type", "predict"};
+
+// Machine code compiled in memory. The functions have the same names and signatures as those in
+// the shared library built from the generated C code.
+class JITLibrary : public SharedLibrary {
+ public:
+  JITLibrary(gcc_jit_result* result, std::unique_ptr<PredictionFinisher> finisher)
+      : result_(result), finisher_(std::move(finisher)) {
+    libpath_ = "<JIT-compiled module>";
+  }
+  ~JITLibrary() override {
+    gcc_jit_result_release(result_);
+  }
+  FunctionHandle LoadFunction(char const* name) const override {
+    void* func_handle = gcc_jit_result_get_code(result_, name);
+    TL2CGEN_CHECK(func_handle) << "JIT-compiled module does not contain a function " << name
+                               << "().";
+    return func_handle;
+  }
+  bool HasFunction(char const* name) const override {
+    // gcc_jit_result_get_code() prints an error for functions that do not exist, so look up
+    // the name in the list instead
+    return std::any_of(std::begin(kExportedFunctions), std::end(kExportedFunctions),
+        [name](char const* e) { return std::strcmp(e, name) == 0; });
+  }
+
+ private:
+  gcc_jit_result* result_;
+  // Referred to by the compiled predict() function, so it must live as long as the result
+  std::unique_ptr<PredictionFinisher> finisher_;
+};
+
+// Called by the compiled predict() function, after the trees are evaluated
+template <typename LeafOutputType>
+void FinishPredictionCallback(void* finisher, int pred_margin, LeafOutputType* result) {
+  static_cast<PredictionFinisher const*>(finisher)->Apply(pred_margin, result);
+}
+
+gcc_jit_comparison GetComparison(treelite::Operator op) {
+  switch (op) {
+  case treelite::Operator::kEQ:
+    return GCC_JIT_COMPARISON_EQ;
+  case treelite::Operator::kLT:
+    return GCC_JIT_COMPARISON_LT;
+  case treelite::Operator::kLE:
+    return GCC_JIT_COMPARISON_LE;
+  case treelite::Operator::kGT:
+    return GCC_JIT_COMPARISON_GT;
+  case treelite::Operator::kGE:
+    return GCC_JIT_COMPARISON_GE;
+  default:
+    TL2CGEN_LOG(FATAL) << "Unrecognized comparison operator " << static_cast<int>(op);
+    return GCC_JIT_COMPARISON_EQ;
+  }
+}
+
+// Get the slots of result[] that a leaf adds to, along with the values to add. The slots are
+// the same as in HandleOutputNode().
+template <typename LeafOutputType>
+std::vector<std::pair<std::int32_t, LeafOutputType>> GetLeafOutputSlots(
+    ast::OutputNode const* node) {
+  std::int32_t const num_target = node->meta_->num_target_;
+  std::vector<std::int32_t> const& num_class = node->meta_->num_class_;
+  std::int32_t const max_num_class = *std::max_element(num_class.begin(), num_class.end());
+  auto const& leaf_output = std::get<std::vector<LeafOutputType>>(node->leaf_output_);
+  std::vector<std::pair<std::int32_t, LeafOutputType>> slots;
+  if (node->target_id_ < 0 && node->class_id_ < 0) {
+    TL2CGEN_CHECK_EQ(leaf_output.size(), num_target * max_num_class);
+    for (std::int32_t target_id = 0; target_id < num_target; ++target_id) {
+      for (std::int32_t class_id = 0; class_id < num_class[target_id]; ++class_id) {
+        std::int32_t const offset = target_id * max_num_class + class_id;
+        slots.emplace_back(offset, leaf_output[offset]);
+      }
+    }
+  } else if (node->target_id_ < 0) {
+    TL2CGEN_CHECK_EQ(leaf_output.size(), num_target);
+    for (std::int32_t target_id = 0; target_id < num_target; ++target_id) {
+      slots.emplace_back(target_id * max_num_class + node->class_id_, leaf_output[target_id]);
+    }
+  } else if (node->class_id_ < 0) {
+    TL2CGEN_CHECK_EQ(leaf_output.size(), max_num_class);
+    for (std::int32_t class_id = 0; class_id < num_class[node->target_id_]; ++class_id) {
+      slots.emplace_back(node->target_id_ * max_num_class + class_id, leaf_output[class_id]);
+    }
+  } else {
+    TL2CGEN_CHECK_EQ(leaf_output.size(), 1);
+    slots.emplace_back(node->target_id_ * max_num_class + node->class_id_, leaf_output[0]);
+  }
+  return slots;
+}
+
+// Lower the AST into libgccjit IR. Each tree becomes an internal function that adds the output
+// of the tree to result[], and predict() calls the tree functions in turn.
+template <typename ThresholdType, typename LeafOutputType>
+class ModuleBuilder {
+ public:
+  explicit ModuleBuilder(gcc_jit_context* ctxt) : ctxt_(ctxt) {
+    constexpr gcc_jit_types threshold_type_enum
+        = std::is_same_v<ThresholdType, float> ? GCC_JIT_TYPE_FLOAT : GCC_JIT_TYPE_DOUBLE;
+    constexpr gcc_jit_types leaf_output_type_enum
+        = std::is_same_v<LeafOutputType, float> ? GCC_JIT_TYPE_FLOAT : GCC_JIT_TYPE_DOUBLE;
+    void_type_ = gcc_jit_context_get_type(ctxt_, GCC_JIT_TYPE_VOID);
+    void_ptr_type_ = gcc_jit_context_get_type(ctxt_, GCC_JIT_TYPE_VOID_PTR);
+    int_type_ = gcc_jit_context_get_type(ctxt_, GCC_JIT_TYPE_INT);
+    int32_type_ = gcc_jit_context_get_int_type(ctxt_, 4, 1);
+    uint_type_ = gcc_jit_context_get_type(ctxt_, GCC_JIT_TYPE_UNSIGNED_INT);
+    bool_type_ = gcc_jit_context_get_type(ctxt_, GCC_JIT_TYPE_BOOL);
+    threshold_type_ = gcc_jit_context_get_type(ctxt_, threshold_type_enum);
+    leaf_output_type_ = gcc_jit_context_get_type(ctxt_, leaf_output_type_enum);
+    result_ptr_type_ = gcc_jit_type_get_pointer(leaf_output_type_);
+    // union Entry { int missing; ThresholdType fvalue; };
+    missing_field_ = gcc_jit_context_new_field(ctxt_, nullptr, int_type_, "missing");
+    fvalue_field_ = gcc_jit_context_new_field(ctxt_, nullptr, threshold_type_, "fvalue");
+    gcc_jit_field* fields[] = {missing_field_, fvalue_field_};
+    entry_ptr_type_ = gcc_jit_type_get_pointer(
+        gcc_jit_context_new_union_type(ctxt_, nullptr, "Entry", 2, fields));
+  }
+
+  void AddQueryFunctions(ast::ModelMeta const& meta, std::string const& threshold_type,
+      std::string const& leaf_output_type) {
+    AddInt32QueryFunction("get_num_target", meta.num_target_);
+    AddInt32QueryFunction("get_num_feature", meta.num_feature_);
+    AddStringQueryFunction("get_threshold_type", threshold_type);
+    AddStringQueryFunction("get_leaf_output_type", leaf_output_type);
+    // void get_num_class(int32_t* out)
+    gcc_jit_param* out
+        = gcc_jit_context_new_param(ctxt_, nullptr, gcc_jit_type_get_pointer(int32_type_), "out");
+    gcc_jit_function* func = gcc_jit_context_new_function(
+        ctxt_, nullptr, GCC_JIT_FUNCTION_EXPORTED, void_type_, "get_num_class", 1, &out, 0);
+    gcc_jit_block* block = gcc_jit_function_new_block(func, nullptr);
+    for (std::int32_t target_id = 0; target_id < meta.num_target_; ++target_id) {
+      gcc_jit_block_add_assignment(block, nullptr,
+          gcc_jit_context_new_array_access(
+              ctxt_, nullptr, gcc_jit_param_as_rvalue(out), IntConst(target_id)),
+          gcc_jit_context_new_rvalue_from_int(ctxt_, int32_type_, meta.num_class_[target_id]));
+    }
+    gcc_jit_block_end_with_void_return(block, nullptr);
+  }
+
+  // static void predict_tree{tree_id}(union Entry* data, LeafOutputType* result)
+  gcc_jit_function* AddTreeFunction(ast::ASTNode const* tree_head, int tree_id) {
+    gcc_jit_param* params[] = {gcc_jit_context_new_param(ctxt_, nullptr, entry_ptr_type_, "data"),
+        gcc_jit_context_new_param(ctxt_, nullptr, result_ptr_type_, "result")};
+    std::string const name = "predict_tree" + std::to_string(tree_id);
+    gcc_jit_function* func = gcc_jit_context_new_function(
+        ctxt_, nullptr, GCC_JIT_FUNCTION_INTERNAL, void_type_, name.c_str(), 2, params, 0);
+    LowerNode(func, gcc_jit_param_as_rvalue(params[0]), gcc_jit_param_as_rvalue(params[1]),
+        tree_head, gcc_jit_function_new_block(func, nullptr));
+    return func;
+  }
+
+  // void predict(union Entry* data, int pred_margin, LeafOutputType* result)
+  void AddPredictFunction(
+      std::vector<gcc_jit_function*> const& tree_funcs, PredictionFinisher const* finisher) {
+    gcc_jit_param* params[] = {gcc_jit_context_new_param(ctxt_, nullptr, entry_ptr_type_, "data"),
+        gcc_jit_context_new_param(ctxt_, nullptr, int_type_, "pred_margin"),
+        gcc_jit_context_new_param(ctxt_, nullptr, result_ptr_type_, "result")};
+    gcc_jit_function* func = gcc_jit_context_new_function(
+        ctxt_, nullptr, GCC_JIT_FUNCTION_EXPORTED, void_type_, "predict", 3, params, 0);
+    gcc_jit_block* block = gcc_jit_function_new_block(func, nullptr);
+    gcc_jit_rvalue* tree_args[]
+        = {gcc_jit_param_as_rvalue(params[0]), gcc_jit_param_as_rvalue(params[2])};
+    for (gcc_jit_function* tree_func : tree_funcs) {
+      gcc_jit_block_add_eval(
+          block, nullptr, gcc_jit_context_new_call(ctxt_, nullptr, tree_func, 2, tree_args));
+    }
+    // Tree averaging, base scores and the postprocessor are applied by the callback
+    gcc_jit_type* callback_param_types[] = {void_ptr_type_, int_type_, result_ptr_type_};
+    gcc_jit_type* callback_type = gcc_jit_context_new_function_ptr_type(
+        ctxt_, nullptr, void_type_, 3, callback_param_types, 0);
+    gcc_jit_rvalue* callback = gcc_jit_context_new_rvalue_from_ptr(ctxt_, callback_type,
+        reinterpret_cast<void*>(&FinishPredictionCallback<LeafOutputType>));
+    gcc_jit_rvalue* callback_args[] = {
+        gcc_jit_context_new_rvalue_from_ptr(
+            ctxt_, void_ptr_type_, const_cast<PredictionFinisher*>(finisher)),
+        gcc_jit_param_as_rvalue(params[1]), gcc_jit_param_as_rvalue(params[2])};
+    gcc_jit_block_add_eval(block, nullptr,
+        gcc_jit_context_new_call_through_ptr(ctxt_, nullptr, callback, 3, callback_args));
+    gcc_jit_block_end_with_void_return(block, nullptr);
+  }
+
+ private:
+  gcc_jit_rvalue* IntConst(int value) {
+    return gcc_jit_context_new_rvalue_from_int(ctxt_, int_type_, value);
+  }
+
+  void AddInt32QueryFunction(char const* name, std::int32_t value) {
+    gcc_jit_function* func = gcc_jit_context_new_function(
+        ctxt_, nullptr, GCC_JIT_FUNCTION_EXPORTED, int32_type_, name, 0, nullptr, 0);
+    gcc_jit_block* block = gcc_jit_function_new_block(func, nullptr);
+    gcc_jit_block_end_with_return(
+        block, nullptr, gcc_jit_context_new_rvalue_from_int(ctxt_, int32_type_, value));
+  }
+
+  void AddStringQueryFunction(char const* name, std::string const& value) {
+    gcc_jit_function* func = gcc_jit_context_new_function(ctxt_, nullptr,
+        GCC_JIT_FUNCTION_EXPORTED, gcc_jit_context_get_type(ctxt_, GCC_JIT_TYPE_CONST_CHAR_PTR),
+        name, 0, nullptr, 0);
+    gcc_jit_block* block = gcc_jit_function_new_block(func, nullptr);
+    gcc_jit_block_end_with_return(
+        block, nullptr, gcc_jit_context_new_string_literal(ctxt_, value.c_str()));
+  }
+
+  // Lower a node into the given block, which the node terminates
+  void LowerNode(gcc_jit_function* func, gcc_jit_rvalue* data, gcc_jit_rvalue* result,
+      ast::ASTNode const* node, gcc_jit_block* block) {
+    if (auto const* output_node = dynamic_cast<ast::OutputNode const*>(node)) {
+      for (auto const& [offset, value] : GetLeafOutputSlots<LeafOutputType>(output_node)) {
+        gcc_jit_block_add_assignment_op(block, nullptr,
+            gcc_jit_context_new_array_access(ctxt_, nullptr, result, IntConst(offset)),
+            GCC_JIT_BINARY_OP_PLUS,
+            gcc_jit_context_new_rvalue_from_double(ctxt_, leaf_output_type_, value));
+      }
+      gcc_jit_block_end_with_void_return(block, nullptr);
+      return;
+    }
+    auto const* cond_node = dynamic_cast<ast::ConditionNode const*>(node);
+    TL2CGEN_CHECK(cond_node) << "The JIT backend does not support the node: " << node->GetDump();
+    TL2CGEN_CHECK_EQ(node->children_.size(), 2);
+    gcc_jit_block* left_block = gcc_jit_function_new_block(func, nullptr);
+    gcc_jit_block* right_block = gcc_jit_function_new_block(func, nullptr);
+    gcc_jit_block* test_block = gcc_jit_function_new_block(func, nullptr);
+    gcc_jit_lvalue* entry = gcc_jit_context_new_array_access(
+        ctxt_, nullptr, data, IntConst(static_cast<int>(cond_node->split_index_)));
+    gcc_jit_rvalue* missing
+        = gcc_jit_lvalue_as_rvalue(gcc_jit_lvalue_access_field(entry, nullptr, missing_field_));
+    gcc_jit_rvalue* fvalue
+        = gcc_jit_lvalue_as_rvalue(gcc_jit_lvalue_access_field(entry, nullptr, fvalue_field_));
+    gcc_jit_rvalue* is_missing = gcc_jit_context_new_comparison(
+        ctxt_, nullptr, GCC_JIT_COMPARISON_EQ, missing, IntConst(-1));
+    gcc_jit_block_end_with_conditional(block, nullptr, is_missing,
+        cond_node->default_left_ ? left_block : right_block, test_block);
+
+    if (auto const* num_node = dynamic_cast<ast::NumericalConditionNode const*>(node)) {
+      auto const threshold = std::get<ThresholdType>(num_node->threshold_);
+      if (std::isinf(threshold)) {
+        // The outcome is the same for all finite feature values, as in the generated C code
+        bool const result_for_finite = tl2cgen::detail::CompareWithOp(
+            static_cast<ThresholdType>(0), num_node->op_, threshold);
+        gcc_jit_block_end_with_jump(
+            test_block, nullptr, result_for_finite ? left_block : right_block);
+      } else {
+        gcc_jit_block_end_with_conditional(test_block, nullptr,
+            gcc_jit_context_new_comparison(ctxt_, nullptr, GetComparison(num_node->op_), fvalue,
+                gcc_jit_context_new_rvalue_from_double(ctxt_, threshold_type_, threshold)),
+            left_block, right_block);
+      }
+    } else {
+      auto const* cat_node = dynamic_cast<ast::CategoricalConditionNode const*>(node);
+      TL2CGEN_CHECK(cat_node);
+      LowerCategoricalTest(func, fvalue, cat_node,
+          cat_node->category_list_right_child_ ? right_block : left_block,
+          cat_node->category_list_right_child_ ? left_block : right_block, test_block);
+    }
+    LowerNode(func, data, result, node->children_[0], left_block);
+    LowerNode(func, data, result, node->children_[1], right_block);
+  }
+
+  // Jump to member_block if the feature value is in the category list, and to nonmember_block
+  // otherwise. The value is converted to unsigned int only if it is in range, as in the
+  // generated C code, and the membership is decided by a switch over ranges of categories.
+  void LowerCategoricalTest(gcc_jit_function* func, gcc_jit_rvalue* fvalue,
+      ast::CategoricalConditionNode const* node, gcc_jit_block* member_block,
+      gcc_jit_block* nonmember_block, gcc_jit_block* block) {
+    std::vector<std::uint32_t> const& category_list = node->category_list_;
+    if (category_list.empty()) {
+      gcc_jit_block_end_with_jump(block, nullptr, nonmember_block);
+      return;
+    }
+    double const num_category_bound = static_cast<double>(category_list.back()) + 1.0;
+    gcc_jit_rvalue* in_range = gcc_jit_context_new_binary_op(ctxt_, nullptr,
+        GCC_JIT_BINARY_OP_LOGICAL_AND, bool_type_,
+        gcc_jit_context_new_comparison(ctxt_, nullptr, GCC_JIT_COMPARISON_GE, fvalue,
+            gcc_jit_context_new_rvalue_from_double(ctxt_, threshold_type_, 0.0)),
+        gcc_jit_context_new_comparison(ctxt_, nullptr, GCC_JIT_COMPARISON_LT, fvalue,
+            gcc_jit_context_new_rvalue_from_double(ctxt_, threshold_type_, num_category_bound)));
+    gcc_jit_block* switch_block = gcc_jit_function_new_block(func, nullptr);
+    gcc_jit_block_end_with_conditional(block, nullptr, in_range, switch_block, nonmember_block);
+
+    std::vector<gcc_jit_case*> cases;
+    for (std::size_t i = 0; i < category_list.size();) {
+      std::size_t j = i;
+      while (j + 1 < category_list.size() && category_list[j + 1] == category_list[j] + 1) {
+        ++j;
+      }
+      cases.push_back(gcc_jit_context_new_case(ctxt_,
+          gcc_jit_context_new_rvalue_from_long(ctxt_, uint_type_, category_list[i]),
+          gcc_jit_context_new_rvalue_from_long(ctxt_, uint_type_, category_list[j]),
+          member_block));
+      i = j + 1;
+    }
+    gcc_jit_block_end_with_switch(switch_block, nullptr,
+        gcc_jit_context_new_cast(ctxt_, nullptr, fvalue, uint_type_), nonmember_block,
+        static_cast<int>(cases.size()), cases.data());
+  }
+
+  gcc_jit_context* ctxt_;
+  gcc_jit_type* void_type_;
+  gcc_jit_type* void_ptr_type_;
+  gcc_jit_type* int_type_;
+  gcc_jit_type* int32_type_;
+  gcc_jit_type* uint_type_;
+  gcc_jit_type* bool_type_;
+  gcc_jit_type* threshold_type_;
+  gcc_jit_type* leaf_output_type_;
+  gcc_jit_type* result_ptr_type_;
+  gcc_jit_type* entry_ptr_type_;
+  gcc_jit_field* missing_field_;
+  gcc_jit_field* fvalue_field_;
+};
+
+// Collect the heads of the trees under the prediction function
+void CollectTrees(ast::ASTNode const* node, std::vector<ast::ASTNode const*>& trees) {
+  if (dynamic_cast<ast::ConditionNode const*>(node) || dynamic_cast<ast::OutputNode const*>(node)) {
+    trees.push_back(node);
+    return;
+  }
+  for (ast::ASTNode const* child : node->children_) {
+    CollectTrees(child, trees);
+  }
+}
+
+}  // anonymous namespace
+
+#endif  // TL2CGEN_USE_GCCJIT
+
+namespace tl2cgen::compiler {
+
+std::unique_ptr<predictor::detail::SharedLibrary> CompileModelJIT(
+    treelite::Model const& model, CompilerParam const& param) {
+#ifdef TL2CGEN_USE_GCCJIT
+  // Only the passes that change the predictions are applied. The other passes choose the layout
+  // of the C code, which does not apply here.
+  detail::ast::ASTBuilder builder;
+  builder.BuildAST(model);
+  if (param.leaf_output_precision != "native") {
+    builder.ReduceLeafOutputPrecision(param.leaf_output_precision);
+  }
+  if (param.prune_redundant_tests > 0) {
+    builder.PruneRedundantTests();
+  }
+
+  auto const* main_node = dynamic_cast<ast::MainNode const*>(builder.GetRootNode());
+  TL2CGEN_CHECK(main_node);
+  ast::ModelMeta const& meta = *main_node->meta_;
+  auto finisher = std::make_unique<PredictionFinisher>(meta.num_class_,
+      main_node->average_factor_.value_or(std::vector<std::int32_t>{}), main_node->base_scores_,
+      main_node->postprocessor_, meta.sigmoid_alpha_, meta.ratio_c_);
+  std::vector<ast::ASTNode const*> trees;
+  CollectTrees(main_node, trees);
+
+  gcc_jit_context* ctxt = gcc_jit_context_acquire();
+  TL2CGEN_CHECK(ctxt) << "Failed to create a libgccjit context";
+  gcc_jit_context_set_int_option(ctxt, GCC_JIT_INT_OPTION_OPTIMIZATION_LEVEL, kOptimizationLevel);
+  std::visit(
+      [&](auto&& type_meta) {
+        using TypeMetaT = std::remove_const_t<std::remove_reference_t<decltype(type_meta)>>;
+        using ThresholdType = typename TypeMetaT::threshold_type;
+        using LeafOutputType = typename TypeMetaT::leaf_output_type;
+        ModuleBuilder<ThresholdType, LeafOutputType> module(ctxt);
+        module.AddQueryFunctions(meta, std::is_same_v<ThresholdType, float> ? "float32" : "float64",
+            std::is_same_v<LeafOutputType, float> ? "float32" : "float64");
+        std::vector<gcc_jit_function*> tree_funcs;
+        for (std::size_t i = 0; i < trees.size(); ++i) {
+          tree_funcs.push_back(module.AddTreeFunction(trees[i], static_cast<int>(i)));
+        }
+        module.AddPredictFunction(tree_funcs, finisher.get());
+      },
+      meta.type_meta_);
+  gcc_jit_result* result = gcc_jit_context_compile(ctxt);
+  if (!result) {
+    std::string const error = gcc_jit_context_get_first_error(ctxt)
+                                  ? gcc_jit_context_get_first_error(ctxt)
+                                  : "unknown error";
+    gcc_jit_context_release(ctxt);
+    TL2CGEN_LOG(FATAL) << "libgccjit failed to compile the model: " << error;
+  }
+  gcc_jit_context_release(ctxt);
+  TL2CGEN_LOG(INFO) << "Compiled " << trees.size() << " tree(s) in memory with libgccjit";
+  return std::make_unique<JITLibrary>(result, std::move(finisher));
+#else
+  TL2CGEN_LOG(FATAL) << "TL2cgen was not built with libgccjit. Rebuild it with the CMake option "
+                     << "-DUSE_GCCJIT=ON to compile models in memory.";
+  return nullptr;
+#endif
+}
+
+}  // namespace tl2cgen::compiler
@@ -0,0 +1,234 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file leaf_output_deviation.cc
+ * \brief Measure how much the predictions change when leaf outputs are stored with reduced
+ *        precision
+ * \author Hyunsu Cho
+ */
+
+#include <tl2cgen/compiler.h>
+#include <tl2cgen/compiler_param.h>
+#include <tl2cgen/data_matrix.h>
+#include <tl2cgen/detail/compiler/leaf_precision.h>
+#include <tl2cgen/detail/math_funcs.h>
+#include <tl2cgen/detail/operator_comp.h>
+#include <tl2cgen/detail/threading_utils/parallel_for.h>
+#include <tl2cgen/logging.h>
+#include <treelite/enum/operator.h>
+#include <treelite/enum/tree_node_type.h>
+#include <treelite/tree.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using tl2cgen::detail::threading_utils::ThreadConfig;
+
+template <typename ElementType>
+union Entry {
+  int missing;
+  ElementType fvalue;
+};
+
+// Find the leaf reached by a row. The tests are evaluated in the same way as in
+// BranchAnnotator::Annotate().
+template <typename ElementType, typename ThresholdType, typename LeafOutputType>
+int FindLeaf(
+    treelite::Tree<ThresholdType, LeafOutputType> const& tree, Entry<ElementType> const* data) {
+  int nid = 0;
+  while (!tree.IsLeaf(nid)) {
+    unsigned const split_index = tree.SplitIndex(nid);
+    if (data[split_index].missing == -1) {
+      nid = tree.DefaultChild(nid);
+      continue;
+    }
+    bool result = true;
+    if (tree.NodeType(nid) == treelite::TreeNodeType::kNumericalTestNode) {
+      ThresholdType const threshold = tree.Threshold(nid);
+      treelite::Operator const op = tree.ComparisonOp(nid);
+      auto const fvalue = static_cast<ElementType>(data[split_index].fvalue);
+      result = tl2cgen::detail::CompareWithOp(fvalue, op, threshold);
+    } else {
+      auto const fvalue = data[split_index].fvalue;
+      auto const category_list = tree.CategoryList(nid);
+      result = (std::binary_search(
+          category_list.begin(), category_list.end(), static_cast<std::uint32_t>(fvalue)));
+      if (tree.CategoryListRightChild(nid)) {
+        result = !result;
+      }
+    }
+    nid = result ? tree.LeftChild(nid) : tree.RightChild(nid);
+  }
+  return nid;
+}
+
+// Add the values of a leaf to the slots of the margin scores that receive the leaf output
+void AddToOutputSlots(treelite::Model const& model, std::size_t tree_id,
+    std::vector<double> const& leaf, std::int32_t max_num_class, double* out) {
+  std::int32_t const target_id = model.target_id[tree_id];
+  std::int32_t const class_id = model.class_id[tree_id];
+  if (target_id < 0 && class_id < 0) {
+    for (std::int32_t i = 0; i < model.num_target; ++i) {
+      for (std::int32_t j = 0; j < model.num_class[i]; ++j) {
+        out[i * max_num_class + j] += leaf[i * max_num_class + j];
+      }
+    }
+  } else if (target_id < 0) {
+    for (std::int32_t i = 0; i < model.num_target; ++i) {
+      out[i * max_num_class + class_id] += leaf[i];
+    }
+  } else if (class_id < 0) {
+    for (std::int32_t j = 0; j < model.num_class[target_id]; ++j) {
+      out[target_id * max_num_class + j] += leaf[j];
+    }
+  } else {
+    out[target_id * max_num_class + class_id] += leaf[0];
+  }
+}
+
+template <typename ThresholdType, typename LeafOutputType>
+double ComputeLeafOutputDeviationImpl(treelite::Model const& model,
+    treelite::ModelPreset<ThresholdType, LeafOutputType> const& model_preset,
+    std::string const& precision, tl2cgen::DMatrix const* dmat, int nthread) {
+  namespace detail = tl2cgen::compiler::detail;
+  std::size_t const num_tree = model_preset.trees.size();
+  std::int32_t const max_num_class
+      = *std::max_element(model.num_class.Data(), model.num_class.Data() + model.num_target);
+  std::size_t const num_slot = static_cast<std::size_t>(model.num_target) * max_num_class;
+
+  // Use the same scale as ASTBuilder::ReduceLeafOutputPrecision()
+  double max_abs_leaf_output = 0.0;
+  for (auto const& tree : model_preset.trees) {
+    for (int nid = 0; nid < tree.num_nodes; ++nid) {
+      if (tree.IsLeaf(nid)) {
+        std::vector<LeafOutputType> const leaf
+            = tree.HasLeafVector(nid) ? tree.LeafVector(nid)
+                                      : std::vector<LeafOutputType>{tree.LeafValue(nid)};
+        for (LeafOutputType e : leaf) {
+          max_abs_leaf_output = std::max(max_abs_leaf_output, std::fabs(static_cast<double>(e)));
+        }
+      }
+    }
+  }
+  int const scale_exponent
+      = (precision == "int16") ? detail::GetInt16LeafScaleExponent(max_abs_leaf_output) : 0;
+
+  // leaf_delta[tree_id][nid]: change in the leaf output caused by rounding
+  std::vector<std::vector<std::vector<double>>> leaf_delta(num_tree);
+  for (std::size_t tree_id = 0; tree_id < num_tree; ++tree_id) {
+    auto const& tree = model_preset.trees[tree_id];
+    leaf_delta[tree_id].resize(tree.num_nodes);
+    for (int nid = 0; nid < tree.num_nodes; ++nid) {
+      if (tree.IsLeaf(nid)) {
+        std::vector<LeafOutputType> const leaf
+            = tree.HasLeafVector(nid) ? tree.LeafVector(nid)
+                                      : std::vector<LeafOutputType>{tree.LeafValue(nid)};
+        for (LeafOutputType e : leaf) {
+          auto const rounded = static_cast<LeafOutputType>(
+              detail::RoundLeafOutput(static_cast<double>(e), precision, scale_exponent));
+          leaf_delta[tree_id][nid].push_back(
+              static_cast<double>(rounded) - static_cast<double>(e));
+        }
+      }
+    }
+  }
+
+  // If the tree outputs are averaged, the deviation is averaged too
+  std::vector<double> scale(num_slot, 1.0);
+  if (model.average_tree_output) {
+    std::vector<double> num_contrib(num_slot, 0.0);
+    for (std::size_t tree_id = 0; tree_id < num_tree; ++tree_id) {
+      std::vector<double> const ones(num_slot, 1.0);
+      AddToOutputSlots(model, tree_id, ones, max_num_class, num_contrib.data());
+    }
+    for (std::size_t i = 0; i < num_slot; ++i) {
+      scale[i] = (num_contrib[i] > 0) ? 1.0 / num_contrib[i] : 0.0;
+    }
+  }
+
+  ThreadConfig const thread_config
+      = tl2cgen::detail::threading_utils::ConfigureThreadConfig(nthread);
+  std::vector<double> max_deviation_tloc(thread_config.nthread, 0.0);
+  std::vector<double> deviation_tloc(thread_config.nthread * num_slot);
+  auto sched = tl2cgen::detail::threading_utils::ParallelSchedule::Static();
+  std::visit(
+      [&](auto&& concrete_dmat) {
+        using DMatrixType = std::remove_const_t<std::remove_reference_t<decltype(concrete_dmat)>>;
+        using ElementType = std::remove_const_t<
+            std::remove_reference_t<decltype(concrete_dmat.data_[0])>>;
+        std::uint64_t const num_col = std::max<std::uint64_t>(
+            concrete_dmat.num_col_, static_cast<std::uint64_t>(model.num_feature));
+        std::vector<Entry<ElementType>> inst(thread_config.nthread * num_col, {-1});
+        tl2cgen::detail::threading_utils::ParallelFor(std::uint64_t(0),
+            concrete_dmat.GetNumRow(), thread_config, sched,
+            [&](std::uint64_t rid, int thread_id) {
+              Entry<ElementType>* row_inst = &inst[thread_id * num_col];
+              if constexpr (std::is_same_v<DMatrixType, tl2cgen::DenseDMatrix<ElementType>>) {
+                ElementType const missing_value = concrete_dmat.missing_value_;
+                bool const nan_missing = tl2cgen::detail::math::CheckNAN(missing_value);
+                ElementType const* row = &concrete_dmat.data_[rid * concrete_dmat.num_col_];
+                for (std::uint64_t j = 0; j < concrete_dmat.num_col_; ++j) {
+                  if (tl2cgen::detail::math::CheckNAN(row[j])) {
+                    TL2CGEN_CHECK(nan_missing) << "The missing_value argument must be set to NaN "
+                                                  "if there is any NaN in the matrix.";
+                  } else if (nan_missing || row[j] != missing_value) {
+                    row_inst[j].fvalue = row[j];
+                  }
+                }
+              } else {
+                for (std::uint64_t i = concrete_dmat.row_ptr_[rid];
+                     i < concrete_dmat.row_ptr_[rid + 1]; ++i) {
+                  if (!tl2cgen::detail::math::CheckNAN(concrete_dmat.data_[i])) {
+                    row_inst[concrete_dmat.col_ind_[i]].fvalue = concrete_dmat.data_[i];
+                  }
+                }
+              }
+              double* deviation = &deviation_tloc[thread_id * num_slot];
+              std::fill(deviation, deviation + num_slot, 0.0);
+              for (std::size_t tree_id = 0; tree_id < num_tree; ++tree_id) {
+                int const nid = FindLeaf(model_preset.trees[tree_id], row_inst);
+                AddToOutputSlots(
+                    model, tree_id, leaf_delta[tree_id][nid], max_num_class, deviation);
+              }
+              for (std::size_t i = 0; i < num_slot; ++i) {
+                max_deviation_tloc[thread_id] = std::max(
+                    max_deviation_tloc[thread_id], std::fabs(deviation[i] * scale[i]));
+              }
+              for (std::uint64_t j = 0; j < num_col; ++j) {
+                row_inst[j].missing = -1;
+              }
+            });
+      },
+      dmat->variant_);
+  return *std::max_element(max_deviation_tloc.begin(), max_deviation_tloc.end());
+}
+
+}  // anonymous namespace
+
+namespace tl2cgen::compiler {
+
+double ComputeLeafOutputDeviation(treelite::Model const& model, CompilerParam const& param,
+    tl2cgen::DMatrix const* dmat, int nthread) {
+  TL2CGEN_CHECK(dmat) << "Dangling data matrix reference detected";
+  if (param.leaf_output_precision == "native") {
+    return 0.0;
+  }
+  double const deviation = std::visit(
+      [&](auto&& model_preset) {
+        return ComputeLeafOutputDeviationImpl(
+            model, model_preset, param.leaf_output_precision, dmat, nthread);
+      },
+      model.variant_);
+  TL2CGEN_LOG(INFO) << "Storing leaf outputs as " << param.leaf_output_precision
+                    << " changes the margin scores by at most " << deviation
+                    << " on the validation data";
+  return deviation;
+}
+
+}  // namespace tl2cgen::compiler
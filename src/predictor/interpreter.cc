@@ -0,0 +1,271 @@
+/*!
+ * Copyright (c) 2024 by Contributors
+ * \file interpreter.cc
+ * \author Hyunsu Cho
+ * \brief Evaluate a tree model directly, without generating and compiling C code
+ */
+
+#include <tl2cgen/detail/operator_comp.h>
+#include <tl2cgen/detail/predictor/finish_prediction.h>
+#include <tl2cgen/detail/predictor/interpreter.h>
+#include <tl2cgen/logging.h>
+#include <tl2cgen/predictor.h>
+#include <treelite/enum/operator.h>
+#include <treelite/tree.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using tl2cgen::predictor::detail::Entry;
+using tl2cgen::predictor::detail::InterpreterPreset;
+using tl2cgen::predictor::detail::InterpreterVariant;
+using tl2cgen::predictor::detail::PredictionFinisher;
+
+// Same as ComputeAverageFactor() in src/compiler/ast/build.cc
+std::vector<std::int32_t> ComputeAverageFactor(treelite::Model const& model) {
+  if (!model.average_tree_output) {
+    return {};
+  }
+  std::int32_t const max_num_class
+      = *std::max_element(model.num_class.Data(), model.num_class.Data() + model.num_target);
+  std::vector<std::int32_t> average_factor(model.num_target * max_num_class, 0);
+  std::size_t const num_tree = model.GetNumTree();
+  for (std::size_t tree_id = 0; tree_id < num_tree; ++tree_id) {
+    if (model.target_id[tree_id] < 0 && model.class_id[tree_id] < 0) {
+      for (std::int32_t target_id = 0; target_id < model.num_target; ++target_id) {
+        for (std::int32_t class_id = 0; class_id < model.num_class[target_id]; ++class_id) {
+          average_factor[target_id * max_num_class + class_id] += 1;
+        }
+      }
+    } else if (model.target_id[tree_id] < 0) {
+      std::int32_t const class_id = model.class_id[tree_id];
+      for (std::int32_t target_id = 0; target_id < model.num_target; ++target_id) {
+        average_factor[target_id * max_num_class + class_id] += 1;
+      }
+    } else if (model.class_id[tree_id] < 0) {
+      std::int32_t const target_id = model.target_id[tree_id];
+      for (std::int32_t class_id = 0; class_id < model.num_class[target_id]; ++class_id) {
+        average_factor[target_id * max_num_class + class_id] += 1;
+      }
+    } else {
+      average_factor[model.target_id[tree_id] * max_num_class + model.class_id[tree_id]] += 1;
+    }
+  }
+  return average_factor;
+}
+
+// Get the output slots that receive the leaf outputs of a tree, along with the positions of the
+// corresponding elements in the leaf vector. Mirrors ASTBuilder::HandleOutputNode().
+std::vector<std::pair<std::int32_t, std::int32_t>> GetOutputSlots(
+    treelite::Model const& model, std::size_t tree_id, std::int32_t max_num_class) {
+  std::int32_t const target_id = model.target_id[tree_id];
+  std::int32_t const class_id = model.class_id[tree_id];
+  std::vector<std::pair<std::int32_t, std::int32_t>> slots;
+  if (target_id < 0 && class_id < 0) {
+    for (std::int32_t i = 0; i < model.num_target; ++i) {
+      for (std::int32_t j = 0; j < model.num_class[i]; ++j) {
+        slots.emplace_back(i * max_num_class + j, i * max_num_class + j);
+      }
+    }
+  } else if (target_id < 0) {
+    for (std::int32_t i = 0; i < model.num_target; ++i) {
+      slots.emplace_back(i * max_num_class + class_id, i);
+    }
+  } else if (class_id < 0) {
+    for (std::int32_t j = 0; j < model.num_class[target_id]; ++j) {
+      slots.emplace_back(target_id * max_num_class + j, j);
+    }
+  } else {
+    slots.emplace_back(target_id * max_num_class + class_id, 0);
+  }
+  return slots;
+}
+
+// Append the nodes of a tree to the flat arrays and return the ID of its root
+template <typename ThresholdType, typename LeafOutputType>
+std::int32_t FlattenTree(treelite::Tree<ThresholdType, LeafOutputType> const& tree,
+    std::vector<std::pair<std::int32_t, std::int32_t>> const& slots,
+    InterpreterPreset<ThresholdType, LeafOutputType>& out) {
+  struct StackEntry {
+    int nid;  // Node ID in the tree
+    std::int32_t parent;  // Node ID of the parent in the flat arrays; -1 for the root
+    bool is_left_child;
+  };
+  auto const root_id = static_cast<std::int32_t>(out.left_child_.size());
+  std::vector<std::pair<int, std::int32_t>> test_nodes;  // (Node ID in tree, ID in flat arrays)
+  // Visit the nodes in pre-order. Push the right child first, so that the left child comes
+  // right after its parent.
+  std::vector<StackEntry> stack{{0, -1, false}};
+  while (!stack.empty()) {
+    StackEntry const e = stack.back();
+    stack.pop_back();
+    auto const flat_id = static_cast<std::int32_t>(out.left_child_.size());
+    if (e.parent >= 0) {
+      (e.is_left_child ? out.left_child_ : out.right_child_)[e.parent] = flat_id;
+    }
+    out.left_child_.push_back(-1);
+    out.right_child_.push_back(-1);
+    out.default_child_.push_back(-1);
+    out.split_index_.push_back(0);
+    out.threshold_.push_back(ThresholdType(0));
+    out.op_.push_back(treelite::Operator::kNone);
+    out.category_test_.push_back(-1);
+    out.leaf_output_begin_.push_back(-1);
+    if (tree.IsLeaf(e.nid)) {
+      out.leaf_output_begin_[flat_id] = static_cast<std::int32_t>(out.leaf_output_.size());
+      if (tree.HasLeafVector(e.nid)) {
+        std::vector<LeafOutputType> const leaf_vector = tree.LeafVector(e.nid);
+        for (auto const& [slot, elem_id] : slots) {
+          out.leaf_output_.push_back(leaf_vector[elem_id]);
+        }
+      } else {
+        TL2CGEN_CHECK_EQ(slots.size(), 1);
+        out.leaf_output_.push_back(tree.LeafValue(e.nid));
+      }
+      continue;
+    }
+    out.split_index_[flat_id] = tree.SplitIndex(e.nid);
+    if (tree.NodeType(e.nid) == treelite::TreeNodeType::kCategoricalTestNode) {
+      std::vector<std::uint32_t> category_list = tree.CategoryList(e.nid);
+      std::sort(category_list.begin(), category_list.end());
+      out.category_test_[flat_id]
+          = static_cast<std::int32_t>(out.category_list_right_child_.size());
+      out.category_list_.insert(
+          out.category_list_.end(), category_list.begin(), category_list.end());
+      out.category_list_begin_.push_back(static_cast<std::int32_t>(out.category_list_.size()));
+      out.category_list_right_child_.push_back(tree.CategoryListRightChild(e.nid) ? 1 : 0);
+    } else {
+      out.threshold_[flat_id] = tree.Threshold(e.nid);
+      out.op_[flat_id] = tree.ComparisonOp(e.nid);
+    }
+    test_nodes.emplace_back(e.nid, flat_id);
+    stack.push_back({tree.RightChild(e.nid), flat_id, false});
+    stack.push_back({tree.LeftChild(e.nid), flat_id, true});
+  }
+
+  // The children are known only after the whole tree is visited
+  for (auto const& [nid, flat_id] : test_nodes) {
+    std::int32_t const left_child = out.left_child_[flat_id];
+    std::int32_t const right_child = out.right_child_[flat_id];
+    out.default_child_[flat_id] = tree.DefaultLeft(nid) ? left_child : right_child;
+    if (out.category_test_[flat_id] < 0 && std::isinf(out.threshold_[flat_id])) {
+      // The outcome is the same for all finite feature values, as in the generated C code
+      bool const result_for_finite = tl2cgen::detail::CompareWithOp(
+          ThresholdType(0), out.op_[flat_id], out.threshold_[flat_id]);
+      out.left_child_[flat_id] = out.right_child_[flat_id]
+          = (result_for_finite ? left_child : right_child);
+    }
+  }
+  return root_id;
+}
+
+template <typename ThresholdType, typename LeafOutputType>
+InterpreterPreset<ThresholdType, LeafOutputType> FlattenModel(treelite::Model const& model,
+    treelite::ModelPreset<ThresholdType, LeafOutputType> const& model_preset) {
+  std::int32_t const max_num_class
+      = *std::max_element(model.num_class.Data(), model.num_class.Data() + model.num_target);
+  InterpreterPreset<ThresholdType, LeafOutputType> out{
+      PredictionFinisher(model.num_class.AsVector(), ComputeAverageFactor(model),
+          model.base_scores.AsVector(), model.postprocessor, model.sigmoid_alpha, model.ratio_c)};
+  std::size_t num_node = 0;
+  for (auto const& tree : model_preset.trees) {
+    num_node += tree.num_nodes;
+  }
+  out.left_child_.reserve(num_node);
+  out.right_child_.reserve(num_node);
+  out.default_child_.reserve(num_node);
+  out.split_index_.reserve(num_node);
+  out.threshold_.reserve(num_node);
+  out.op_.reserve(num_node);
+  out.category_test_.reserve(num_node);
+  out.leaf_output_begin_.reserve(num_node);
+  out.output_slot_begin_.push_back(0);
+  out.category_list_begin_.push_back(0);
+  for (std::size_t tree_id = 0; tree_id < model_preset.trees.size(); ++tree_id) {
+    auto const slots = GetOutputSlots(model, tree_id, max_num_class);
+    for (auto const& [slot, elem_id] : slots) {
+      out.output_slot_.push_back(slot);
+    }
+    out.output_slot_begin_.push_back(static_cast<std::int32_t>(out.output_slot_.size()));
+    out.tree_root_.push_back(FlattenTree(model_preset.trees[tree_id], slots, out));
+  }
+  return out;
+}
+
+}  // anonymous namespace
+
+namespace tl2cgen::predictor::detail {
+
+template <typename ThresholdType, typename LeafOutputType>
+void InterpreterPreset<ThresholdType, LeafOutputType>::Predict(
+    Entry<ThresholdType> const* data, int pred_margin, LeafOutputType* result) const {
+  std::size_t const num_tree = tree_root_.size();
+  for (std::size_t tree_id = 0; tree_id < num_tree; ++tree_id) {
+    std::int32_t nid = tree_root_[tree_id];
+    while (left_child_[nid] >= 0) {
+      Entry<ThresholdType> const& entry = data[split_index_[nid]];
+      if (entry.missing == -1) {
+        nid = default_child_[nid];
+        continue;
+      }
+      bool result = true;
+      std::int32_t const test_id = category_test_[nid];
+      if (test_id < 0) {
+        result = tl2cgen::detail::CompareWithOp(entry.fvalue, op_[nid], threshold_[nid]);
+      } else {
+        // The feature value is converted to an unsigned integer only if it is in range, as in
+        // the generated C code
+        std::uint32_t const* first = category_list_.data() + category_list_begin_[test_id];
+        std::uint32_t const* last = category_list_.data() + category_list_begin_[test_id + 1];
+        result = first != last && entry.fvalue >= 0
+                 && entry.fvalue < static_cast<ThresholdType>(last[-1] + 1.0)
+                 && std::binary_search(first, last, static_cast<std::uint32_t>(entry.fvalue));
+        if (category_list_right_child_[test_id]) {
+          result = !result;
+        }
+      }
+      nid = result ? left_child_[nid] : right_child_[nid];
+    }
+    std::int32_t const slot_begin = output_slot_begin_[tree_id];
+    std::int32_t const num_slot = output_slot_begin_[tree_id + 1] - slot_begin;
+    LeafOutputType const* leaf_output = &leaf_output_[leaf_output_begin_[nid]];
+    for (std::int32_t i = 0; i < num_slot; ++i) {
+      result[output_slot_[slot_begin + i]] += leaf_output[i];
+    }
+  }
+  finisher_.Apply(pred_margin, result);
+}
+
+Interpreter::Interpreter(treelite::Model const& model)
+    : variant_(std::visit(
+        [&model](auto&& model_preset) -> InterpreterVariant {
+          return FlattenModel(model, model_preset);
+        },
+        model.variant_)),
+      num_feature_(model.num_feature),
+      num_target_(model.num_target),
+      num_class_(model.num_class.AsVector()) {}
+
+std::string Interpreter::GetThresholdType() const {
+  return std::visit(
+      [](auto&& interpreter) -> std::string {
+        using ThresholdType =
+            typename std::remove_reference_t<decltype(interpreter)>::threshold_type;
+        return std::is_same_v<ThresholdType, float> ? "float32" : "float64";
+      },
+      variant_);
+}
+
+template class InterpreterPreset<float, float>;
+template class InterpreterPreset<double, double>;
+
+}  // namespace tl2cgen::predictor::detail
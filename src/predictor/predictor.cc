@@ -7,6 +7,7 @@
 
 #include <tl2cgen/data_matrix.h>
 #include <tl2cgen/detail/math_funcs.h>
+#include <tl2cgen/detail/predictor/interpreter.h>
 #include <tl2cgen/detail/threading_utils/omp_config.h>
 #include <tl2cgen/detail/threading_utils/parallel_for.h>
 #include <tl2cgen/logging.h>
@@ -18,7 +19,12 @@
 #include <cstddef>
 #include <cstdint>
 #include <experimental/mdspan>
+#include <limits>
 #include <memory>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace {
 
@@ -53,6 +59,8 @@ inline std::vector<std::uint64_t> SplitBatch(
   return row_ptr;
 }
 
+// Run prediction for rows [rbegin, rend) of the data matrix. The output for row rid is stored at
+// output_view[rid - rbegin].
 template <typename ThresholdType, typename LeafOutputType, typename ElementType, typename PredFunc>
 inline void ApplyBatch(tl2cgen::CSRDMatrix<ElementType> const* dmat, int num_feature,
     std::uint64_t rbegin, std::uint64_t rend, bool pred_margin,
@@ -68,9 +76,13 @@ inline void ApplyBatch(tl2cgen::CSRDMatrix<ElementType> const* dmat, int num_fea
     std::uint64_t const ibegin = row_ptr[rid];
     std::uint64_t const iend = row_ptr[rid + 1];
     for (std::uint64_t i = ibegin; i < iend; ++i) {
-      inst[col_ind[i]].fvalue = static_cast<ThresholdType>(data[i]);
+      // Like the dense matrix, treat an explicit NaN as missing
+      if (!tl2cgen::detail::math::CheckNAN(data[i])) {
+        inst[col_ind[i]].fvalue = static_cast<ThresholdType>(data[i]);
+      }
     }
-    auto output_slice = stdex::submdspan(output_view, rid, stdex::full_extent, stdex::full_extent);
+    auto output_slice
+        = stdex::submdspan(output_view, rid - rbegin, stdex::full_extent, stdex::full_extent);
     static_assert(std::is_same_v<decltype(output_slice), Array2DView<LeafOutputType>>);
     func(inst.data(), static_cast<int>(pred_margin), output_slice.data_handle());
     for (std::uint64_t i = ibegin; i < iend; ++i) {
@@ -102,7 +114,8 @@ inline void ApplyBatch(tl2cgen::DenseDMatrix<ElementType> const* dmat, int num_f
         inst[j].fvalue = static_cast<ThresholdType>(row[j]);
       }
     }
-    auto output_slice = stdex::submdspan(output_view, rid, stdex::full_extent, stdex::full_extent);
+    auto output_slice
+        = stdex::submdspan(output_view, rid - rbegin, stdex::full_extent, stdex::full_extent);
     static_assert(std::is_same_v<decltype(output_slice), Array2DView<LeafOutputType>>);
     func(inst.data(), static_cast<int>(pred_margin), output_slice.data_handle());
     for (std::uint64_t j = 0; j < num_col; ++j) {
@@ -111,13 +124,39 @@ inline void ApplyBatch(tl2cgen::DenseDMatrix<ElementType> const* dmat, int num_f
   }
 }
 
+// Run prediction with predict_batch() from the shared library, which loops over the rows of a
+// dense matrix by itself. The element type and the number of columns must match the model. The
+// output for row rid is stored at output_view[rid - rbegin].
+template <typename ThresholdType, typename LeafOutputType, typename PredBatchFunc>
+inline void ApplyBatchInLibrary(tl2cgen::DenseDMatrix<ThresholdType> const* dmat,
+    std::uint64_t rbegin, std::uint64_t rend, bool pred_margin,
+    Array3DView<LeafOutputType> output_view, PredBatchFunc func) {
+  TL2CGEN_CHECK(rbegin < rend && rend <= dmat->num_row_);
+  std::uint64_t const num_col = dmat->num_col_;
+  ThresholdType const* data = dmat->data_.data();
+  if (!tl2cgen::detail::math::CheckNAN(dmat->missing_value_)) {
+    // predict_batch() treats NaN as missing; keep the behavior of ApplyBatch() instead
+    for (std::uint64_t i = rbegin * num_col; i < rend * num_col; ++i) {
+      TL2CGEN_CHECK(!tl2cgen::detail::math::CheckNAN(data[i]))
+          << "The missing_value argument must be set to NaN if there is any NaN in the matrix.";
+    }
+  }
+  func(&data[rbegin * num_col], static_cast<std::size_t>(rend - rbegin),
+      static_cast<std::size_t>(num_col), dmat->missing_value_, static_cast<int>(pred_margin),
+      output_view.data_handle());
+}
+
 }  // anonymous namespace
 
 namespace tl2cgen::predictor {
 
-Predictor::Predictor(char const* libpath, int num_worker_thread) {
+Predictor::Predictor(char const* libpath, int num_worker_thread)
+    : Predictor(std::make_unique<detail::SharedLibrary>(libpath), num_worker_thread) {}
+
+Predictor::Predictor(std::unique_ptr<detail::SharedLibrary> lib, int num_worker_thread) {
+  TL2CGEN_CHECK(lib) << "Found a dangling reference to the library";
   thread_config_ = tl2cgen::detail::threading_utils::ConfigureThreadConfig(num_worker_thread);
-  lib_ = std::make_unique<detail::SharedLibrary>(libpath);
+  lib_ = std::move(lib);
 
   using Int32QueryFunc = std::int32_t (*)();
   using Int32VecQueryFunc = void (*)(std::int32_t*);
@@ -145,20 +184,115 @@ Predictor::Predictor(char const* libpath, int num_worker_thread) {
       = lib_->LoadFunctionWithSignature<StringQueryFunc>("get_leaf_output_type");
   leaf_output_type_ = leaf_output_type_query_func();
 
+  /* 5. Query number of trees, if the library supports prediction with a range of trees */
+  num_tree_ = -1;
+  if (lib_->HasFunction("get_num_tree")) {
+    auto* num_tree_query_func = lib_->LoadFunctionWithSignature<Int32QueryFunc>("get_num_tree");
+    num_tree_ = num_tree_query_func();
+  }
+
   /* 8. Load appropriate function for margin prediction */
   pred_func_ = std::make_unique<PredictFunction>(DataTypeFromString(threshold_type_),
       DataTypeFromString(leaf_output_type_), *lib_, num_feature_, num_target_, max_num_class_);
 }
 
+Predictor::Predictor(std::unique_ptr<detail::Interpreter> interpreter, int num_worker_thread) {
+  TL2CGEN_CHECK(interpreter) << "Found a dangling reference to the interpreter";
+  thread_config_ = tl2cgen::detail::threading_utils::ConfigureThreadConfig(num_worker_thread);
+  interpreter_ = std::move(interpreter);
+
+  num_target_ = interpreter_->GetNumTarget();
+  num_class_ = interpreter_->GetNumClass();
+  max_num_class_ = *std::max_element(num_class_.begin(), num_class_.end());
+  num_feature_ = interpreter_->GetNumFeature();
+  threshold_type_ = interpreter_->GetThresholdType();
+  leaf_output_type_ = threshold_type_;
+  num_tree_ = -1;
+  pred_func_ = std::make_unique<PredictFunction>(
+      *interpreter_, num_feature_, num_target_, max_num_class_);
+}
+
+Predictor::~Predictor() = default;
+
+PredictFunction::PredictFunction(detail::Interpreter const& interpreter, std::int32_t num_feature,
+    std::int32_t num_target, std::int32_t max_num_class) {
+  variant_ = std::visit(
+      [&](auto&& interpreter_concrete) -> detail::PredictFunctionVariant {
+        using InterpreterType = std::remove_reference_t<decltype(interpreter_concrete)>;
+        using PredFuncType = detail::PredictFunctionPreset<typename InterpreterType::threshold_type,
+            typename InterpreterType::leaf_output_type>;
+        return PredFuncType(interpreter_concrete, num_feature, num_target, max_num_class);
+      },
+      interpreter.variant_);
+}
+
 template <typename ThresholdType, typename LeafOutputType>
 void detail::PredictFunctionPreset<ThresholdType, LeafOutputType>::PredictBatch(DMatrix const* dmat,
     std::uint64_t rbegin, std::uint64_t rend, bool pred_margin, LeafOutputType* out_pred) const {
   TL2CGEN_CHECK(rbegin < rend && rend <= dmat->GetNumRow());
+  PredictRows(dmat, rbegin, rend, pred_margin, &out_pred[rbegin * num_target_ * max_num_class_]);
+}
+
+template <typename ThresholdType, typename LeafOutputType>
+void detail::PredictFunctionPreset<ThresholdType, LeafOutputType>::PredictRows(DMatrix const* dmat,
+    std::uint64_t rbegin, std::uint64_t rend, bool pred_margin, LeafOutputType* out_rows) const {
+  if (interpreter_) {
+    auto output_view
+        = Array3DView<LeafOutputType>(out_rows, rend - rbegin, num_target_, max_num_class_);
+    auto pred_func = [interpreter = interpreter_](
+                         Entry<ThresholdType>* data, int pred_margin, LeafOutputType* result) {
+      interpreter->Predict(data, pred_margin, result);
+    };
+    std::visit(
+        [this, &pred_func, rbegin, rend, pred_margin, output_view](auto&& concrete_dmat) {
+          return ApplyBatch<ThresholdType, LeafOutputType>(
+              &concrete_dmat, num_feature_, rbegin, rend, pred_margin, output_view, pred_func);
+        },
+        dmat->variant_);
+    return;
+  }
   using PredFunc = void (*)(Entry<ThresholdType>*, int, LeafOutputType*);
   auto* pred_func = reinterpret_cast<PredFunc>(handle_);
   TL2CGEN_CHECK(pred_func) << "The predict() function has incorrect signature.";
   auto output_view
-      = Array3DView<LeafOutputType>(out_pred, dmat->GetNumRow(), num_target_, max_num_class_);
+      = Array3DView<LeafOutputType>(out_rows, rend - rbegin, num_target_, max_num_class_);
+  using PredBatchFunc = void (*)(
+      ThresholdType const*, std::size_t, std::size_t, ThresholdType, int, LeafOutputType*);
+  auto* pred_batch_func = reinterpret_cast<PredBatchFunc>(batch_handle_);
+  std::visit(
+      [this, &pred_func, pred_batch_func, rbegin, rend, pred_margin, output_view](
+          auto&& concrete_dmat) {
+        using DMatrixType = std::remove_const_t<std::remove_reference_t<decltype(concrete_dmat)>>;
+        if constexpr (std::is_same_v<DMatrixType, DenseDMatrix<ThresholdType>>) {
+          if (pred_batch_func
+              && concrete_dmat.num_col_ == static_cast<std::uint64_t>(num_feature_)) {
+            return ApplyBatchInLibrary<ThresholdType, LeafOutputType>(
+                &concrete_dmat, rbegin, rend, pred_margin, output_view, pred_batch_func);
+          }
+        }
+        return ApplyBatch<ThresholdType, LeafOutputType>(
+            &concrete_dmat, num_feature_, rbegin, rend, pred_margin, output_view, pred_func);
+      },
+      dmat->variant_);
+}
+
+template <typename ThresholdType, typename LeafOutputType>
+void detail::PredictFunctionPreset<ThresholdType, LeafOutputType>::PredictBatch(DMatrix const* dmat,
+    std::uint64_t rbegin, std::uint64_t rend, bool pred_margin, std::int32_t tree_begin,
+    std::int32_t tree_end, LeafOutputType* out_pred) const {
+  TL2CGEN_CHECK(rbegin < rend && rend <= dmat->GetNumRow());
+  using PredRangeFunc
+      = void (*)(Entry<ThresholdType>*, std::int32_t, std::int32_t, int, LeafOutputType*);
+  auto* pred_range_func = reinterpret_cast<PredRangeFunc>(range_handle_);
+  TL2CGEN_CHECK(pred_range_func)
+      << "The shared library does not support prediction with a range of trees. Generate it "
+      << "with the compiler parameter tree_functions=1.";
+  auto output_view = Array3DView<LeafOutputType>(
+      &out_pred[rbegin * num_target_ * max_num_class_], rend - rbegin, num_target_, max_num_class_);
+  auto pred_func = [pred_range_func, tree_begin, tree_end](
+                       Entry<ThresholdType>* data, int pred_margin, LeafOutputType* result) {
+    pred_range_func(data, tree_begin, tree_end, pred_margin, result);
+  };
   std::visit(
       [this, &pred_func, rbegin, rend, pred_margin, output_view](auto&& concrete_dmat) {
         return ApplyBatch<ThresholdType, LeafOutputType>(
@@ -167,8 +301,88 @@ void detail::PredictFunctionPreset<ThresholdType, LeafOutputType>::PredictBatch(
       dmat->variant_);
 }
 
-void Predictor::PredictBatch(
-    DMatrix const* dmat, int verbose, bool pred_margin, void* out_result) const {
+template <typename ThresholdType, typename LeafOutputType>
+void detail::PredictFunctionPreset<ThresholdType, LeafOutputType>::PredictDecision(
+    DMatrix const* dmat, std::uint64_t rbegin, std::uint64_t rend, double threshold,
+    LeafOutputType* out_pred) const {
+  TL2CGEN_CHECK(rbegin < rend && rend <= dmat->GetNumRow());
+  TL2CGEN_CHECK(!interpreter_) << "PredictDecision() is not supported by the interpreter.";
+  using PredDecisionFunc = int (*)(Entry<ThresholdType>*, double);
+  auto* pred_decision_func = reinterpret_cast<PredDecisionFunc>(decision_handle_);
+  TL2CGEN_CHECK(pred_decision_func)
+      << "The shared library does not support predict_decision(). Generate it with the "
+      << "compiler parameter tree_functions=1, from a model with a single output that does "
+      << "not average tree outputs.";
+  auto output_view = Array3DView<LeafOutputType>(
+      &out_pred[rbegin * num_target_ * max_num_class_], rend - rbegin, num_target_, max_num_class_);
+  auto pred_func = [pred_decision_func, threshold](
+                       Entry<ThresholdType>* data, int, LeafOutputType* result) {
+    result[0] = static_cast<LeafOutputType>(pred_decision_func(data, threshold));
+  };
+  std::visit(
+      [this, &pred_func, rbegin, rend, output_view](auto&& concrete_dmat) {
+        return ApplyBatch<ThresholdType, LeafOutputType>(
+            &concrete_dmat, num_feature_, rbegin, rend, false, output_view, pred_func);
+      },
+      dmat->variant_);
+}
+
+template <typename ThresholdType, typename LeafOutputType>
+void detail::PredictFunctionPreset<ThresholdType, LeafOutputType>::PredictTopK(DMatrix const* dmat,
+    std::uint64_t rbegin, std::uint64_t rend, std::vector<std::int32_t> const& num_class,
+    std::int32_t k, std::int32_t* out_index, LeafOutputType* out_score) const {
+  TL2CGEN_CHECK(rbegin < rend && rend <= dmat->GetNumRow());
+  // Compute the margin scores for a block of rows at a time, so that the scratch buffer stays
+  // small even when the model has many classes
+  constexpr std::uint64_t kBlockSize = 256;
+  std::uint64_t const row_size = static_cast<std::uint64_t>(num_target_) * max_num_class_;
+  std::vector<LeafOutputType> margin(std::min(kBlockSize, rend - rbegin) * row_size);
+  std::vector<std::int32_t> class_id(max_num_class_);
+  auto index_view = Array3DView<std::int32_t>(out_index, dmat->GetNumRow(), num_target_, k);
+  auto score_view = Array3DView<LeafOutputType>(out_score, dmat->GetNumRow(), num_target_, k);
+  for (std::uint64_t block_begin = rbegin; block_begin < rend; block_begin += kBlockSize) {
+    std::uint64_t const block_end = std::min(block_begin + kBlockSize, rend);
+    // predict() accumulates the tree outputs into the output buffer, so clear it first
+    std::fill(margin.begin(), margin.end(), LeafOutputType(0));
+    PredictRows(dmat, block_begin, block_end, true, margin.data());
+    for (std::uint64_t rid = block_begin; rid < block_end; ++rid) {
+      for (std::int32_t target_id = 0; target_id < num_target_; ++target_id) {
+        LeafOutputType const* row_margin
+            = &margin[(rid - block_begin) * row_size + target_id * max_num_class_];
+        std::int32_t const num_class_target = num_class[target_id];
+        std::int32_t const num_selected = std::min(k, num_class_target);
+        std::iota(class_id.begin(), class_id.begin() + num_class_target, 0);
+        // Order by descending score; ties go to the lower class ID, as with argmax. NaN scores
+        // compare false with everything, so they are ordered explicitly after all other scores.
+        std::partial_sort(class_id.begin(), class_id.begin() + num_selected,
+            class_id.begin() + num_class_target, [row_margin](std::int32_t a, std::int32_t b) {
+              bool const a_nan = tl2cgen::detail::math::CheckNAN(row_margin[a]);
+              bool const b_nan = tl2cgen::detail::math::CheckNAN(row_margin[b]);
+              if (a_nan != b_nan) {
+                return b_nan;
+              }
+              if (!a_nan && row_margin[a] != row_margin[b]) {
+                return row_margin[a] > row_margin[b];
+              }
+              return a < b;
+            });
+        for (std::int32_t i = 0; i < k; ++i) {
+          if (i < num_selected) {
+            index_view(rid, target_id, i) = class_id[i];
+            score_view(rid, target_id, i) = row_margin[class_id[i]];
+          } else {
+            index_view(rid, target_id, i) = -1;
+            score_view(rid, target_id, i) = std::numeric_limits<LeafOutputType>::quiet_NaN();
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename PredictSliceFunc>
+void Predictor::PredictBatchImpl(
+    DMatrix const* dmat, int verbose, PredictSliceFunc predict_slice) const {
   std::uint64_t const num_row = dmat->GetNumRow();
   if (num_row == 0) {
     return;
@@ -184,7 +398,7 @@ void Predictor::PredictBatch(
       [&](std::uint64_t thread_id, int) {
         std::uint64_t rbegin = row_ptr[thread_id];
         std::uint64_t rend = row_ptr[thread_id + 1];
-        pred_func_->PredictBatch(dmat, rbegin, rend, pred_margin, out_result);
+        predict_slice(rbegin, rend);
       });
   double const tend = GetTime();
   if (verbose > 0) {
@@ -192,9 +406,61 @@ void Predictor::PredictBatch(
   }
 }
 
+void Predictor::PredictBatch(
+    DMatrix const* dmat, int verbose, bool pred_margin, void* out_result) const {
+  PredictBatchImpl(dmat, verbose, [&](std::uint64_t rbegin, std::uint64_t rend) {
+    pred_func_->PredictBatch(dmat, rbegin, rend, pred_margin, out_result);
+  });
+}
+
+void Predictor::PredictBatch(DMatrix const* dmat, int verbose, bool pred_margin,
+    std::int32_t tree_begin, std::int32_t tree_end, void* out_result) const {
+  TL2CGEN_CHECK_GE(num_tree_, 0)
+      << "The shared library does not support prediction with a range of trees. Generate it "
+      << "with the compiler parameter tree_functions=1.";
+  TL2CGEN_CHECK(0 <= tree_begin && tree_begin <= tree_end && tree_end <= num_tree_)
+      << "Invalid range of trees [" << tree_begin << ", " << tree_end << "); the model has "
+      << num_tree_ << " trees";
+  PredictBatchImpl(dmat, verbose, [&](std::uint64_t rbegin, std::uint64_t rend) {
+    pred_func_->PredictBatch(dmat, rbegin, rend, pred_margin, tree_begin, tree_end, out_result);
+  });
+}
+
+void Predictor::PredictDecision(
+    DMatrix const* dmat, int verbose, double threshold, void* out_result) const {
+  PredictBatchImpl(dmat, verbose, [&](std::uint64_t rbegin, std::uint64_t rend) {
+    pred_func_->PredictDecision(dmat, rbegin, rend, threshold, out_result);
+  });
+}
+
+void Predictor::PredictTopK(DMatrix const* dmat, int verbose, std::int32_t k,
+    std::int32_t* out_index, void* out_score) const {
+  TL2CGEN_CHECK(1 <= k && k <= max_num_class_)
+      << "k must be between 1 and the number of classes (" << max_num_class_ << "); got " << k;
+  PredictBatchImpl(dmat, verbose, [&](std::uint64_t rbegin, std::uint64_t rend) {
+    pred_func_->PredictTopK(dmat, rbegin, rend, num_class_, k, out_index, out_score);
+  });
+}
+
 template void detail::PredictFunctionPreset<float, float>::PredictBatch(
     DMatrix const*, std::uint64_t, std::uint64_t, bool pred_margin, float* out_pred) const;
 template void detail::PredictFunctionPreset<double, double>::PredictBatch(
     DMatrix const*, std::uint64_t, std::uint64_t, bool pred_margin, double* out_pred) const;
+template void detail::PredictFunctionPreset<float, float>::PredictBatch(DMatrix const*,
+    std::uint64_t, std::uint64_t, bool pred_margin, std::int32_t, std::int32_t,
+    float* out_pred) const;
+template void detail::PredictFunctionPreset<double, double>::PredictBatch(DMatrix const*,
+    std::uint64_t, std::uint64_t, bool pred_margin, std::int32_t, std::int32_t,
+    double* out_pred) const;
+template void detail::PredictFunctionPreset<float, float>::PredictDecision(
+    DMatrix const*, std::uint64_t, std::uint64_t, double, float* out_pred) const;
+template void detail::PredictFunctionPreset<double, double>::PredictDecision(
+    DMatrix const*, std::uint64_t, std::uint64_t, double, double* out_pred) const;
+template void detail::PredictFunctionPreset<float, float>::PredictTopK(DMatrix const*,
+    std::uint64_t, std::uint64_t, std::vector<std::int32_t> const&, std::int32_t, std::int32_t*,
+    float* out_score) const;
+template void detail::PredictFunctionPreset<double, double>::PredictTopK(DMatrix const*,
+    std::uint64_t, std::uint64_t, std::vector<std::int32_t> const&, std::int32_t, std::int32_t*,
+    double* out_score) const;
 
 }  // namespace tl2cgen::predictor
@@ -51,4 +51,14 @@ SharedLibrary::FunctionHandle SharedLibrary::LoadFunction(char const* name) cons
   return reinterpret_cast<SharedLibrary::FunctionHandle>(func_handle);
 }
 
+bool SharedLibrary::HasFunction(char const* name) const {
+  TL2CGEN_CHECK(handle_) << "Shared library was not yet loaded.";
+#ifdef _WIN32
+  FARPROC func_handle = GetProcAddress(static_cast<HMODULE>(handle_), name);
+#else
+  void* func_handle = dlsym(static_cast<void*>(handle_), name);
+#endif
+  return func_handle != nullptr;
+}
+
 }  // namespace tl2cgen::predictor::detail
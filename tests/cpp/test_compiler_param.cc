@@ -21,7 +21,8 @@ TEST(CompilerParam, Basic) {
       "parallel_comp": 100,
       "native_lib_name": "predictor",
       "annotate_in": "annotation.json",
-      "verbose": 3
+      "verbose": 3,
+      "tree_layout": "quickscorer"
     })JSON";
   CompilerParam param = CompilerParam::ParseFromJSON(json_str.c_str());
   EXPECT_EQ(param.quantize, 1);
@@ -29,6 +30,43 @@ TEST(CompilerParam, Basic) {
   EXPECT_EQ(param.native_lib_name, "predictor");
   EXPECT_EQ(param.annotate_in, "annotation.json");
   EXPECT_EQ(param.verbose, 3);
+  EXPECT_EQ(param.tree_layout, "quickscorer");
+
+  json_str = R"JSON(
+    {
+      "tree_layout": "array",
+      "simd": 1,
+      "interleave_trees": 4,
+      "leaf_output_precision": "bfloat16",
+      "narrow_thresholds": 1
+    })JSON";
+  param = CompilerParam::ParseFromJSON(json_str.c_str());
+  EXPECT_EQ(param.tree_layout, "array");
+  EXPECT_EQ(param.simd, 1);
+  EXPECT_EQ(param.interleave_trees, 4);
+  EXPECT_EQ(param.leaf_output_precision, "bfloat16");
+  EXPECT_EQ(param.narrow_thresholds, 1);
+
+  json_str = R"JSON(
+    {
+      "branchless_depth": 3,
+      "integer_compare": 1,
+      "tree_functions": 1,
+      "dedup_subtrees": 1,
+      "missing_fast_path": 1,
+      "fast_math_postprocess": 1,
+      "prune_redundant_tests": 0
+    })JSON";
+  param = CompilerParam::ParseFromJSON(json_str.c_str());
+  EXPECT_EQ(param.tree_layout, "if_else");
+  EXPECT_EQ(param.branchless_depth, 3);
+  EXPECT_EQ(param.integer_compare, 1);
+  EXPECT_EQ(param.tree_functions, 1);
+  EXPECT_EQ(param.dedup_subtrees, 1);
+  EXPECT_EQ(param.missing_fast_path, 1);
+  EXPECT_EQ(param.fast_math_postprocess, 1);
+  EXPECT_EQ(param.prune_redundant_tests, 0);
+  EXPECT_EQ(param.leaf_output_precision, "native");
 }
 
 TEST(CompilerParam, NonExistentKey) {
@@ -65,6 +103,12 @@ TEST(CompilerParam, IncorrectType) {
     })JSON";
   EXPECT_THAT([&]() { CompilerParam::ParseFromJSON(json_str.c_str()); },
       ThrowsMessage<tl2cgen::Error>(HasSubstr("Expected a string for 'native_lib_name'")));
+  json_str = R"JSON(
+    {
+      "tree_layout": 1
+    })JSON";
+  EXPECT_THAT([&]() { CompilerParam::ParseFromJSON(json_str.c_str()); },
+      ThrowsMessage<tl2cgen::Error>(HasSubstr("Expected a string for 'tree_layout'")));
   json_str = R"JSON(
     {
       "parallel_comp": 13bad
@@ -75,13 +119,62 @@ TEST(CompilerParam, IncorrectType) {
 
 TEST(CompilerParam, InvalidRange) {
   std::string json_str;
-  for (auto const& key : std::vector<std::string>{"quantize", "parallel_comp"}) {
+  for (auto const& key : std::vector<std::string>{"quantize", "parallel_comp", "simd",
+           "integer_compare", "tree_functions", "dedup_subtrees", "missing_fast_path",
+           "fast_math_postprocess", "narrow_thresholds", "prune_redundant_tests"}) {
     std::string literal = "-1";
     json_str = fmt::format(R"JSON({{ "{0}": {1} }})JSON", key, literal);
     std::string expected_error = fmt::format("'{}' must be 0 or greater", key);
     EXPECT_THAT([&]() { CompilerParam::ParseFromJSON(json_str.c_str()); },
         ThrowsMessage<tl2cgen::Error>(HasSubstr(expected_error)));
   }
+  json_str = R"JSON({ "tree_layout": "bad_layout" })JSON";
+  EXPECT_THAT([&]() { CompilerParam::ParseFromJSON(json_str.c_str()); },
+      ThrowsMessage<tl2cgen::Error>(HasSubstr("'tree_layout' must be one of")));
+  json_str = R"JSON({ "simd": 1 })JSON";
+  EXPECT_THAT([&]() { CompilerParam::ParseFromJSON(json_str.c_str()); },
+      ThrowsMessage<tl2cgen::Error>(HasSubstr("'simd' requires 'tree_layout' to be 'array'")));
+  for (auto const& literal : std::vector<std::string>{"-1", "9"}) {
+    json_str = fmt::format(R"JSON({{ "branchless_depth": {} }})JSON", literal);
+    EXPECT_THAT([&]() { CompilerParam::ParseFromJSON(json_str.c_str()); },
+        ThrowsMessage<tl2cgen::Error>(HasSubstr("'branchless_depth' must be between 0 and 8")));
+  }
+  json_str = R"JSON({ "tree_layout": "array", "branchless_depth": 2 })JSON";
+  EXPECT_THAT([&]() { CompilerParam::ParseFromJSON(json_str.c_str()); },
+      ThrowsMessage<tl2cgen::Error>(
+          HasSubstr("'branchless_depth' requires 'tree_layout' to be 'if_else'")));
+  for (auto const& literal : std::vector<std::string>{"-1", "17"}) {
+    json_str = fmt::format(R"JSON({{ "interleave_trees": {} }})JSON", literal);
+    EXPECT_THAT([&]() { CompilerParam::ParseFromJSON(json_str.c_str()); },
+        ThrowsMessage<tl2cgen::Error>(HasSubstr("'interleave_trees' must be between 0 and 16")));
+  }
+  json_str = R"JSON({ "interleave_trees": 4 })JSON";
+  EXPECT_THAT([&]() { CompilerParam::ParseFromJSON(json_str.c_str()); },
+      ThrowsMessage<tl2cgen::Error>(
+          HasSubstr("'interleave_trees' requires 'tree_layout' to be 'array'")));
+  json_str = R"JSON({ "tree_layout": "quickscorer", "integer_compare": 1 })JSON";
+  EXPECT_THAT([&]() { CompilerParam::ParseFromJSON(json_str.c_str()); },
+      ThrowsMessage<tl2cgen::Error>(
+          HasSubstr("'integer_compare' requires 'tree_layout' to be 'if_else'")));
+  json_str = R"JSON({ "tree_layout": "array", "tree_functions": 1 })JSON";
+  EXPECT_THAT([&]() { CompilerParam::ParseFromJSON(json_str.c_str()); },
+      ThrowsMessage<tl2cgen::Error>(
+          HasSubstr("'tree_functions' requires 'tree_layout' to be 'if_else'")));
+  json_str = R"JSON({ "tree_layout": "quickscorer", "dedup_subtrees": 1 })JSON";
+  EXPECT_THAT([&]() { CompilerParam::ParseFromJSON(json_str.c_str()); },
+      ThrowsMessage<tl2cgen::Error>(
+          HasSubstr("'dedup_subtrees' requires 'tree_layout' to be 'if_else'")));
+  json_str = R"JSON({ "tree_layout": "array", "missing_fast_path": 1 })JSON";
+  EXPECT_THAT([&]() { CompilerParam::ParseFromJSON(json_str.c_str()); },
+      ThrowsMessage<tl2cgen::Error>(
+          HasSubstr("'missing_fast_path' requires 'tree_layout' to be 'if_else'")));
+  json_str = R"JSON({ "leaf_output_precision": "float8" })JSON";
+  EXPECT_THAT([&]() { CompilerParam::ParseFromJSON(json_str.c_str()); },
+      ThrowsMessage<tl2cgen::Error>(HasSubstr("'leaf_output_precision' must be one of")));
+  json_str = R"JSON({ "narrow_thresholds": 1 })JSON";
+  EXPECT_THAT([&]() { CompilerParam::ParseFromJSON(json_str.c_str()); },
+      ThrowsMessage<tl2cgen::Error>(
+          HasSubstr("'narrow_thresholds' requires 'tree_layout' to be 'array'")));
 }
 
 }  // namespace tl2cgen::compiler
@@ -1,12 +1,15 @@
 """Suite of basic tests"""
 
 import itertools
+import json
 import os
 import pathlib
 import subprocess
 from zipfile import ZipFile
 
+import numpy as np
 import pytest
+import treelite
 from scipy.sparse import csr_matrix
 
 import tl2cgen
@@ -61,6 +64,489 @@ def test_basic(
     check_predictor(predictor, dataset)
 
 
+@pytest.mark.parametrize(
+    "dataset,quantize,parallel_comp,interleave_trees",
+    list(
+        itertools.product(
+            ["mushroom", "dermatology", "toy_categorical"],
+            [True, False],
+            [None, 4],
+            [0, 3],
+        )
+    ),
+)
+def test_array_layout(tmpdir, dataset, quantize, parallel_comp, interleave_trees):
+    """Test C codegen with trees laid out as static node arrays"""
+    libpath = format_libpath_for_example_model(dataset, prefix=tmpdir)
+    model = load_example_model(dataset)
+    toolchain = os_compatible_toolchains()[0]
+    params = {
+        "tree_layout": "array",
+        "quantize": (1 if quantize else 0),
+        "parallel_comp": (parallel_comp if parallel_comp else 0),
+        "interleave_trees": interleave_trees,
+    }
+    tl2cgen.export_lib(
+        model, toolchain=toolchain, libpath=libpath, params=params, verbose=True
+    )
+    predictor = tl2cgen.Predictor(libpath=libpath, verbose=True)
+    check_predictor(predictor, dataset)
+
+
+@pytest.mark.parametrize(
+    "dataset,quantize,parallel_comp",
+    list(
+        itertools.product(
+            ["mushroom", "dermatology", "toy_categorical"], [True, False], [None, 4]
+        )
+    ),
+)
+def test_quickscorer(tmpdir, dataset, quantize, parallel_comp):
+    """Test C codegen with trees evaluated by the QuickScorer algorithm"""
+    libpath = format_libpath_for_example_model(dataset, prefix=tmpdir)
+    model = load_example_model(dataset)
+    toolchain = os_compatible_toolchains()[0]
+    params = {
+        "tree_layout": "quickscorer",
+        "quantize": (1 if quantize else 0),
+        "parallel_comp": (parallel_comp if parallel_comp else 0),
+    }
+    tl2cgen.export_lib(
+        model, toolchain=toolchain, libpath=libpath, params=params, verbose=True
+    )
+    predictor = tl2cgen.Predictor(libpath=libpath, verbose=True)
+    check_predictor(predictor, dataset)
+
+
+@pytest.mark.parametrize(
+    "dataset,quantize,branchless_depth",
+    list(
+        itertools.product(
+            ["mushroom", "dermatology", "toy_categorical"], [True, False], [1, 3, 8]
+        )
+    ),
+)
+def test_branchless(tmpdir, dataset, quantize, branchless_depth):
+    """Test C codegen with the bottom levels of trees evaluated without branches"""
+    libpath = format_libpath_for_example_model(dataset, prefix=tmpdir)
+    model = load_example_model(dataset)
+    toolchain = os_compatible_toolchains()[0]
+    params = {
+        "branchless_depth": branchless_depth,
+        "quantize": (1 if quantize else 0),
+    }
+    tl2cgen.export_lib(
+        model, toolchain=toolchain, libpath=libpath, params=params, verbose=True
+    )
+    predictor = tl2cgen.Predictor(libpath=libpath, verbose=True)
+    check_predictor(predictor, dataset)
+
+
+@pytest.mark.parametrize(
+    "dataset,quantize,parallel_comp",
+    list(
+        itertools.product(
+            ["mushroom", "dermatology", "toy_categorical"], [True, False], [None, 4]
+        )
+    ),
+)
+def test_dedup_subtrees(tmpdir, dataset, quantize, parallel_comp):
+    """Test C codegen with repeated subtrees rendered as shared functions"""
+    libpath = format_libpath_for_example_model(dataset, prefix=tmpdir)
+    model = load_example_model(dataset)
+    toolchain = os_compatible_toolchains()[0]
+    params = {
+        "dedup_subtrees": 1,
+        "quantize": (1 if quantize else 0),
+        "parallel_comp": (parallel_comp if parallel_comp else 0),
+    }
+    tl2cgen.export_lib(
+        model, toolchain=toolchain, libpath=libpath, params=params, verbose=True
+    )
+    predictor = tl2cgen.Predictor(libpath=libpath, verbose=True)
+    check_predictor(predictor, dataset)
+
+
+@pytest.mark.parametrize(
+    "dataset,quantize,parallel_comp",
+    list(
+        itertools.product(
+            ["mushroom", "dermatology", "toy_categorical"], [True, False], [None, 4]
+        )
+    ),
+)
+def test_missing_fast_path(tmpdir, dataset, quantize, parallel_comp):
+    """Test C codegen with a separate path for rows without missing values"""
+    try:
+        from sklearn.datasets import load_svmlight_file
+    except ImportError:
+        pytest.skip("scikit-learn is required")
+
+    libpath = format_libpath_for_example_model(dataset, prefix=tmpdir)
+    model = load_example_model(dataset)
+    toolchain = os_compatible_toolchains()[0]
+    params = {
+        "missing_fast_path": 1,
+        "quantize": (1 if quantize else 0),
+        "parallel_comp": (parallel_comp if parallel_comp else 0),
+    }
+    tl2cgen.export_lib(
+        model, toolchain=toolchain, libpath=libpath, params=params, verbose=True
+    )
+    predictor = tl2cgen.Predictor(libpath=libpath, verbose=True)
+    # The test data is sparse, so most rows take the path with missing-value checks
+    check_predictor(predictor, dataset)
+
+    # Fill in the missing values, so that every row takes the fast path
+    X = load_svmlight_file(example_model_db[dataset].dtest, zero_based=True)[0]
+    X_dense = X.toarray().astype(example_model_db[dataset].dtype)
+    out_margin = predictor.predict(tl2cgen.DMatrix(X_dense), pred_margin=True)
+    expected_margin = treelite.gtil.predict(model, X_dense, pred_margin=True)
+    np.testing.assert_almost_equal(out_margin, expected_margin, decimal=5)
+
+
+@pytest.mark.parametrize(
+    "dataset,parallel_comp",
+    list(itertools.product(["mushroom", "dermatology", "toy_categorical"], [None, 4])),
+)
+def test_fast_math_postprocess(tmpdir, dataset, parallel_comp):
+    """Test C codegen with polynomial approximations of exp() in the postprocessor"""
+    try:
+        from sklearn.datasets import load_svmlight_file
+    except ImportError:
+        pytest.skip("scikit-learn is required")
+
+    libpath = format_libpath_for_example_model(dataset, prefix=tmpdir)
+    model = load_example_model(dataset)
+    toolchain = os_compatible_toolchains()[0]
+    params = {
+        "fast_math_postprocess": 1,
+        "parallel_comp": (parallel_comp if parallel_comp else 0),
+    }
+    tl2cgen.export_lib(
+        model, toolchain=toolchain, libpath=libpath, params=params, verbose=True
+    )
+    predictor = tl2cgen.Predictor(libpath=libpath, verbose=True)
+    check_predictor(predictor, dataset)
+
+    # Dense rows are predicted with predict_batch(), which calls postprocess_batch()
+    X = load_svmlight_file(example_model_db[dataset].dtest, zero_based=True)[0]
+    X_dense = X.toarray().astype(example_model_db[dataset].dtype)
+    X_dense[X_dense == 0] = np.nan
+    out_prob = predictor.predict(tl2cgen.DMatrix(X_dense))
+    expected_prob = treelite.gtil.predict(model, X_dense)
+    np.testing.assert_almost_equal(out_prob, expected_prob, decimal=5)
+
+
+def _max_abs_leaf_output(model):
+    """Largest absolute value of the leaf outputs of a model"""
+
+    def _walk(obj):
+        if isinstance(obj, dict):
+            return max(
+                (
+                    np.max(np.abs(v)) if k == "leaf_value" else _walk(v)
+                    for k, v in obj.items()
+                ),
+                default=0.0,
+            )
+        if isinstance(obj, list):
+            return max((_walk(e) for e in obj), default=0.0)
+        return 0.0
+
+    return _walk(json.loads(model.dump_as_json(pretty_print=False)))
+
+
+@pytest.mark.parametrize(
+    "dataset,tree_layout,leaf_output_precision",
+    list(
+        itertools.product(
+            ["mushroom", "dermatology", "toy_categorical"],
+            ["if_else", "array"],
+            ["float16", "bfloat16", "int16"],
+        )
+    ),
+)
+def test_leaf_output_precision(tmpdir, dataset, tree_layout, leaf_output_precision):
+    """Test C codegen with leaf outputs stored with reduced precision"""
+    try:
+        from sklearn.datasets import load_svmlight_file
+    except ImportError:
+        pytest.skip("scikit-learn is required")
+
+    libpath = format_libpath_for_example_model(dataset, prefix=tmpdir)
+    model = load_example_model(dataset)
+    toolchain = os_compatible_toolchains()[0]
+    params = {
+        "tree_layout": tree_layout,
+        "leaf_output_precision": leaf_output_precision,
+    }
+    if tree_layout == "array":
+        params["narrow_thresholds"] = 1
+    tl2cgen.export_lib(
+        model, toolchain=toolchain, libpath=libpath, params=params, verbose=True
+    )
+    predictor = tl2cgen.Predictor(libpath=libpath, verbose=True)
+
+    X = load_svmlight_file(example_model_db[dataset].dtest, zero_based=True)[0]
+    X_dense = X.toarray().astype(example_model_db[dataset].dtype)
+    X_dense[X_dense == 0] = np.nan
+    dmat = tl2cgen.DMatrix(X_dense)
+    deviation = tl2cgen.compute_leaf_output_deviation(model, dmat, params)
+    # Each leaf output is rounded to the nearest representable value, so every tree adds
+    # at most half a unit in the last place of the largest leaf output
+    max_rel_error = {"float16": 2**-11, "bfloat16": 2**-8, "int16": 2**-14}
+    max_abs_leaf_output = _max_abs_leaf_output(model)
+    if leaf_output_precision != "int16":
+        assert deviation > 0.0
+    assert deviation <= model.num_tree * (
+        max_abs_leaf_output * max_rel_error[leaf_output_precision] + 2**-24
+    )
+
+    out_margin = predictor.predict(dmat, pred_margin=True)
+    expected_margin = treelite.gtil.predict(model, X_dense, pred_margin=True)
+    # Allow for the rounding errors of accumulating the margin scores in float32
+    tol = 1e-5 * max(1.0, np.max(np.abs(expected_margin)))
+    max_diff = np.max(np.abs(out_margin - expected_margin))
+    assert deviation - tol <= max_diff <= deviation + tol
+
+
+@pytest.mark.parametrize(
+    "dataset,quantize,parallel_comp",
+    list(
+        itertools.product(
+            ["mushroom", "dermatology", "toy_categorical"], [True, False], [None, 4]
+        )
+    ),
+)
+def test_tree_range(tmpdir, dataset, quantize, parallel_comp):
+    """Test prediction with a range of trees, using one generated function per tree"""
+    try:
+        from sklearn.datasets import load_svmlight_file
+    except ImportError:
+        pytest.skip("scikit-learn is required")
+
+    libpath = format_libpath_for_example_model(dataset, prefix=tmpdir)
+    model = load_example_model(dataset)
+    toolchain = os_compatible_toolchains()[0]
+    params = {
+        "tree_functions": 1,
+        "quantize": (1 if quantize else 0),
+        "parallel_comp": (parallel_comp if parallel_comp else 0),
+    }
+    tl2cgen.export_lib(
+        model, toolchain=toolchain, libpath=libpath, params=params, verbose=True
+    )
+    predictor = tl2cgen.Predictor(libpath=libpath, verbose=True)
+    check_predictor(predictor, dataset)
+    assert predictor.num_tree == model.num_tree
+
+    dmat = tl2cgen.DMatrix(
+        load_svmlight_file(example_model_db[dataset].dtest, zero_based=True)[0],
+        dtype=example_model_db[dataset].dtype,
+    )
+    num_tree = predictor.num_tree
+    for pred_margin in [True, False]:
+        expected = predictor.predict(dmat, pred_margin=pred_margin)
+        out = predictor.predict(
+            dmat, pred_margin=pred_margin, tree_range=(0, num_tree)
+        )
+        np.testing.assert_almost_equal(out, expected, decimal=5)
+
+    # Margins of adjacent ranges add up, since none of these models average tree outputs.
+    # Each range includes the base score, so subtract the margin of an empty range once.
+    split = num_tree // 2
+    empty = predictor.predict(dmat, pred_margin=True, tree_range=(0, 0))
+    first = predictor.predict(dmat, pred_margin=True, tree_range=(0, split))
+    second = predictor.predict(dmat, pred_margin=True, tree_range=(split, num_tree))
+    full = predictor.predict(dmat, pred_margin=True)
+    np.testing.assert_almost_equal(first + second - empty, full, decimal=5)
+
+    with pytest.raises(tl2cgen.TL2cgenError):
+        predictor.predict(dmat, tree_range=(0, num_tree + 1))
+
+
+@pytest.mark.parametrize("quantize", [True, False])
+def test_predict_decision(tmpdir, quantize):
+    """Test deciding against a threshold, with early exit from the loop over trees"""
+    try:
+        from sklearn.datasets import load_svmlight_file
+    except ImportError:
+        pytest.skip("scikit-learn is required")
+
+    dataset = "mushroom"
+    libpath = format_libpath_for_example_model(dataset, prefix=tmpdir)
+    model = load_example_model(dataset)
+    toolchain = os_compatible_toolchains()[0]
+    params = {"tree_functions": 1, "quantize": (1 if quantize else 0)}
+    tl2cgen.export_lib(
+        model, toolchain=toolchain, libpath=libpath, params=params, verbose=True
+    )
+    predictor = tl2cgen.Predictor(libpath=libpath, verbose=True)
+
+    dmat = tl2cgen.DMatrix(
+        load_svmlight_file(example_model_db[dataset].dtest, zero_based=True)[0],
+        dtype=example_model_db[dataset].dtype,
+    )
+    margin = predictor.predict(dmat, pred_margin=True)
+    for threshold in [-1.0, 0.0, 2.5, float(margin.flat[0])]:
+        out = predictor.predict_decision(dmat, threshold)
+        np.testing.assert_equal(out, (margin > threshold).astype(out.dtype))
+
+    # Multi-class models have no predict_decision()
+    dataset = "dermatology"
+    libpath = format_libpath_for_example_model(dataset, prefix=tmpdir)
+    tl2cgen.export_lib(
+        load_example_model(dataset),
+        toolchain=toolchain,
+        libpath=libpath,
+        params={"tree_functions": 1},
+        verbose=True,
+    )
+    predictor = tl2cgen.Predictor(libpath=libpath, verbose=True)
+    dmat = tl2cgen.DMatrix(
+        load_svmlight_file(example_model_db[dataset].dtest, zero_based=True)[0],
+        dtype=example_model_db[dataset].dtype,
+    )
+    with pytest.raises(tl2cgen.TL2cgenError):
+        predictor.predict_decision(dmat, 0.0)
+
+
+@pytest.mark.parametrize("k", [1, 3, 6])
+def test_predict_topk(tmpdir, k):
+    """Test selecting the classes with the highest scores"""
+    try:
+        from sklearn.datasets import load_svmlight_file
+    except ImportError:
+        pytest.skip("scikit-learn is required")
+
+    dataset = "dermatology"
+    libpath = format_libpath_for_example_model(dataset, prefix=tmpdir)
+    model = load_example_model(dataset)
+    toolchain = os_compatible_toolchains()[0]
+    tl2cgen.export_lib(model, toolchain=toolchain, libpath=libpath, verbose=True)
+    predictor = tl2cgen.Predictor(libpath=libpath, verbose=True)
+
+    dmat = tl2cgen.DMatrix(
+        load_svmlight_file(example_model_db[dataset].dtest, zero_based=True)[0],
+        dtype=example_model_db[dataset].dtype,
+    )
+    margin = predictor.predict(dmat, pred_margin=True)
+    num_class = margin.shape[2]
+    index, score = predictor.predict_topk(dmat, k)
+    assert index.shape == margin.shape[:2] + (k,)
+    assert score.shape == margin.shape[:2] + (k,)
+    # Stable sort of the negated margins puts the lower class ID first among ties
+    expected_index = np.argsort(-margin, axis=2, kind="stable")[:, :, :k]
+    np.testing.assert_equal(index, expected_index)
+    np.testing.assert_equal(score, np.take_along_axis(margin, expected_index, axis=2))
+    if k == 1:
+        prob = predictor.predict(dmat)
+        np.testing.assert_equal(index[:, :, 0], np.argmax(prob, axis=2))
+
+    with pytest.raises(tl2cgen.TL2cgenError):
+        predictor.predict_topk(dmat, 0)
+    with pytest.raises(tl2cgen.TL2cgenError):
+        predictor.predict_topk(dmat, num_class + 1)
+
+
+@pytest.mark.parametrize("dataset", ["mushroom", "dermatology", "toy_categorical"])
+@pytest.mark.parametrize("missing", [None, -999.0])
+@pytest.mark.parametrize("simd", [False, True])
+def test_dense_input(tmpdir, dataset, missing, simd):
+    """Test prediction with dense input, which is handled by predict_batch() in the
+    generated library"""
+    try:
+        from sklearn.datasets import load_svmlight_file
+    except ImportError:
+        pytest.skip("scikit-learn is required")
+
+    libpath = format_libpath_for_example_model(dataset, prefix=tmpdir)
+    model = load_example_model(dataset)
+    toolchain = os_compatible_toolchains()[0]
+    params = {"tree_layout": "array", "simd": 1} if simd else {}
+    tl2cgen.export_lib(
+        model, toolchain=toolchain, libpath=libpath, params=params, verbose=True
+    )
+    predictor = tl2cgen.Predictor(libpath=libpath, verbose=True)
+
+    dtype = example_model_db[dataset].dtype
+    X = load_svmlight_file(
+        example_model_db[dataset].dtest,
+        zero_based=True,
+        n_features=predictor.num_feature,
+    )[0].tocoo()
+    X_dense = np.full(X.shape, np.nan if missing is None else missing, dtype=dtype)
+    X_dense[X.row, X.col] = X.data
+    assert missing is None or not np.any(X.data == missing)
+
+    dmat_sparse = tl2cgen.DMatrix(X.tocsr(), dtype=dtype)
+    dmat_dense = tl2cgen.DMatrix(X_dense, dtype=dtype, missing=missing)
+    for pred_margin in [True, False]:
+        expected = predictor.predict(dmat_sparse, pred_margin=pred_margin)
+        out = predictor.predict(dmat_dense, pred_margin=pred_margin)
+        np.testing.assert_almost_equal(out, expected, decimal=5)
+
+
+@pytest.mark.skipif(os_platform() == "windows", reason="PGO not supported with MSVC")
+@pytest.mark.parametrize("toolchain", os_compatible_toolchains())
+@pytest.mark.parametrize("dataset", ["mushroom", "dermatology", "toy_categorical"])
+def test_pgo(tmpdir, dataset, toolchain):
+    """Test building the library with profile-guided optimization"""
+    try:
+        from sklearn.datasets import load_svmlight_file
+    except ImportError:
+        pytest.skip("scikit-learn is required")
+
+    libpath = format_libpath_for_example_model(dataset, prefix=tmpdir)
+    model = load_example_model(dataset)
+    profile_data = tl2cgen.DMatrix(
+        load_svmlight_file(example_model_db[dataset].dtest, zero_based=True)[0],
+        dtype=example_model_db[dataset].dtype,
+    )
+    try:
+        tl2cgen.export_lib(
+            model,
+            toolchain=toolchain,
+            libpath=libpath,
+            params={"parallel_comp": 4},
+            verbose=True,
+            profile_data=profile_data,
+        )
+    except tl2cgen.TL2cgenError as e:
+        if "llvm-profdata" in str(e):
+            pytest.skip("llvm-profdata is required")
+        raise
+    predictor = tl2cgen.Predictor(libpath=libpath, verbose=True)
+    check_predictor(predictor, dataset)
+
+
+@pytest.mark.parametrize("dataset", ["mushroom", "dermatology", "toy_categorical"])
+def test_jit_compile(dataset):
+    """Test compiling the model in memory with libgccjit"""
+    model = load_example_model(dataset)
+    try:
+        predictor = tl2cgen.jit_compile(model, verbose=True)
+    except tl2cgen.TL2cgenError as e:
+        # The CI job that builds TL2cgen with libgccjit sets TL2CGEN_REQUIRE_GCCJIT, so
+        # that the test fails there instead of being skipped
+        if "not built with libgccjit" in str(e) and not os.environ.get(
+            "TL2CGEN_REQUIRE_GCCJIT"
+        ):
+            pytest.skip("TL2cgen was not built with libgccjit")
+        raise
+    check_predictor(predictor, dataset)
+
+
+@pytest.mark.parametrize("dataset", ["mushroom", "dermatology", "toy_categorical"])
+def test_interpret(dataset):
+    """Test predicting by walking the trees, without code generation"""
+    model = load_example_model(dataset)
+    predictor = tl2cgen.interpret(model)
+    check_predictor(predictor, dataset)
+    assert predictor.num_tree is None
+
+
 @pytest.mark.skipif(os_platform() == "windows", reason="Make unavailable on Windows")
 @pytest.mark.parametrize("toolchain", os_compatible_toolchains())
 @pytest.mark.parametrize("dataset", ["mushroom", "dermatology", "toy_categorical"])
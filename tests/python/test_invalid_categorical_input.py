@@ -66,3 +66,42 @@ def test_invalid_categorical_input(tmpdir, toy_model, test_data, ref_pred):
     dmat = tl2cgen.DMatrix(test_data)
     pred = predictor.predict(dmat)
     np.testing.assert_equal(pred, ref_pred)
+
+
+def test_invalid_categorical_input_large_category_ids(tmpdir):
+    """Test category values with a bitmap spanning multiple 64-bit words. The two trees share
+    the same categorical split, so that the bitmap gets deduplicated."""
+    builder = treelite.ModelBuilder(num_feature=1)
+    for _ in range(2):
+        tree = treelite.ModelBuilder.Tree()
+        tree[0].set_categorical_test_node(
+            feature_id=0,
+            left_categories=[0, 70, 1000],
+            default_left=True,
+            left_child_key=1,
+            right_child_key=2,
+        )
+        tree[1].set_leaf_node(-1.0)
+        tree[2].set_leaf_node(1.0)
+        tree[0].set_root()
+        builder.append(tree)
+    model = builder.commit()
+
+    test_data = np.array(
+        [-1, -0.5, 0, 0.3, 70, 70.5, 71, 1000, 1023.9, 1024, np.nan, np.inf, 1e10],
+        dtype=np.float32,
+    ).reshape((-1, 1))
+    # 1023.9 gets rounded toward the zero and does not match any element of left_categories.
+    # 1024 lies past the end of the bitmap.
+    ref_pred = np.array(
+        [2, 2, -2, -2, -2, -2, 2, -2, 2, 2, -2, 2, 2], dtype=np.float32
+    ).reshape((-1, 1, 1))
+
+    libpath = pathlib.Path(tmpdir).joinpath("mylib" + _libext())
+    toolchain = os_compatible_toolchains()[0]
+    tl2cgen.export_lib(model, toolchain=toolchain, libpath=libpath)
+
+    predictor = tl2cgen.Predictor(libpath=libpath)
+    dmat = tl2cgen.DMatrix(test_data)
+    pred = predictor.predict(dmat)
+    np.testing.assert_equal(pred, ref_pred)
@@ -1,11 +1,19 @@
 """Tests for model builder interface"""
 
+import itertools
 import os
 import pathlib
+import re
 
 import numpy as np
 import pytest
 import treelite
+from treelite.model_builder import (
+    Metadata,
+    ModelBuilder,
+    PostProcessorFunc,
+    TreeAnnotation,
+)
 
 import tl2cgen
 from tl2cgen.contrib.util import _libext
@@ -84,3 +92,235 @@ def test_node_insert_delete(tmpdir, toolchain, test_round_trip):
                         f"Prediction wrong for f0={f0}, f1={f1}, f2={f2}: "
                         + f"expected_pred = {expected_pred} vs actual_pred = {pred}"
                     )
+
+
+@pytest.mark.parametrize("average_tree_output", [True, False])
+@pytest.mark.parametrize("toolchain", os_compatible_toolchains())
+def test_multi_target_multi_class(tmpdir, toolchain, average_tree_output):
+    # pylint: disable=R0914
+    """Test a model with multiple targets and multiple classes per target. Each output
+    [target_id, class_id] has its own base score and its own number of trees."""
+    num_target = 2
+    num_class = 3
+    # Target 1 has two trees per class and target 0 has one, so that the number of trees
+    # to average over differs between the targets
+    target_id = [0] * num_class + [1] * (2 * num_class)
+    class_id = list(range(num_class)) * 3
+    num_tree = len(target_id)
+    builder = ModelBuilder(
+        threshold_type="float64",
+        leaf_output_type="float64",
+        metadata=Metadata(
+            num_feature=2,
+            task_type="kMultiClf",
+            average_tree_output=average_tree_output,
+            num_target=num_target,
+            num_class=[num_class] * num_target,
+            leaf_vector_shape=(1, 1),
+        ),
+        tree_annotation=TreeAnnotation(
+            num_tree=num_tree, target_id=target_id, class_id=class_id
+        ),
+        postprocessor=PostProcessorFunc(name="identity"),
+        base_scores=[0.5, -1.0, 2.0, 10.0, 20.0, -30.0],
+    )
+    for tree_id in range(num_tree):
+        builder.start_tree()
+        builder.start_node(0)
+        builder.numerical_test(
+            feature_id=tree_id % 2,
+            threshold=0.0,
+            default_left=(tree_id % 3 == 0),
+            opname="<",
+            left_child_key=1,
+            right_child_key=2,
+        )
+        builder.end_node()
+        builder.start_node(1)
+        builder.leaf(float(tree_id + 1))
+        builder.end_node()
+        builder.start_node(2)
+        builder.leaf(-0.5 * (tree_id + 1))
+        builder.end_node()
+        builder.end_tree()
+    model = builder.commit()
+
+    libpath = pathlib.Path(tmpdir) / ("libtest" + _libext())
+    tl2cgen.export_lib(model, toolchain=toolchain, libpath=libpath, verbose=True)
+    predictor = tl2cgen.Predictor(libpath=libpath)
+    assert predictor.num_target == num_target
+    np.testing.assert_array_equal(
+        predictor.num_class, np.array([num_class] * num_target, dtype=np.int32)
+    )
+    X = np.array(
+        [[-1.0, -1.0], [-1.0, 1.0], [1.0, -1.0], [1.0, 1.0], [np.nan, 1.0]],
+        dtype=np.float64,
+    )
+    out = predictor.predict(tl2cgen.DMatrix(X, dtype="float64"), pred_margin=True)
+    expected = treelite.gtil.predict(model, X, pred_margin=True)
+    np.testing.assert_almost_equal(out, expected, decimal=5)
+
+
+@pytest.mark.parametrize("prune_redundant_tests", [0, 1])
+@pytest.mark.parametrize("tree_layout", ["if_else", "array", "quickscorer"])
+@pytest.mark.parametrize("toolchain", os_compatible_toolchains())
+def test_prune_redundant_tests(
+    tmpdir, capsys, toolchain, tree_layout, prune_redundant_tests
+):
+    # pylint: disable=R0914
+    """Test removal of tests whose outcome is decided by the tests above them. Each tree
+    repeats its root test below an unrelated test, on both sides of the root, with the
+    same and the opposite default direction, so that missing values decide whether a
+    repeated test can be removed."""
+    opnames = ["<", "<=", ">", ">=", "=="]
+    num_tree = len(opnames) * 2 + 1
+    builder = ModelBuilder(
+        threshold_type="float64",
+        leaf_output_type="float64",
+        metadata=Metadata(
+            num_feature=2,
+            task_type="kRegressor",
+            average_tree_output=False,
+            num_target=1,
+            num_class=[1],
+            leaf_vector_shape=(1, 1),
+        ),
+        tree_annotation=TreeAnnotation(
+            num_tree=num_tree, target_id=[0] * num_tree, class_id=[0] * num_tree
+        ),
+        postprocessor=PostProcessorFunc(name="identity"),
+        base_scores=[0.0],
+    )
+
+    def numerical_test(node_key, feature_id, threshold, opname, default_left):
+        builder.start_node(node_key)
+        builder.numerical_test(
+            feature_id=feature_id,
+            threshold=threshold,
+            default_left=default_left,
+            opname=opname,
+            left_child_key=node_key * 2 + 1,
+            right_child_key=node_key * 2 + 2,
+        )
+        builder.end_node()
+
+    def leaf(node_key, value):
+        builder.start_node(node_key)
+        builder.leaf(value)
+        builder.end_node()
+
+    for tree_id, (opname, default_left) in enumerate(
+        itertools.product(opnames, [True, False])
+    ):
+        builder.start_tree()
+        numerical_test(0, 0, 0.0, opname, default_left)
+        numerical_test(1, 1, 0.5, "<", True)
+        numerical_test(3, 0, 0.0, opname, default_left)
+        numerical_test(4, 0, 0.0, opname, not default_left)
+        numerical_test(2, 0, 0.0, opname, default_left)
+        for leaf_id, node_key in enumerate([7, 8, 9, 10, 5, 6]):
+            leaf(node_key, float(tree_id * 10 + leaf_id + 1))
+        builder.end_tree()
+    # Nested tests with different operators and thresholds
+    builder.start_tree()
+    numerical_test(0, 0, 1.0, "<", True)
+    numerical_test(1, 0, 1.0, "<=", True)
+    numerical_test(2, 0, 0.5, ">", False)
+    numerical_test(5, 0, 1.0, ">=", False)
+    numerical_test(6, 0, 0.0, "==", True)
+    for leaf_id, node_key in enumerate([3, 4, 11, 12, 13, 14]):
+        leaf(node_key, float(-leaf_id - 1))
+    builder.end_tree()
+    model = builder.commit()
+
+    libpath = pathlib.Path(tmpdir) / ("libtest" + _libext())
+    capsys.readouterr()
+    tl2cgen.export_lib(
+        model,
+        toolchain=toolchain,
+        libpath=libpath,
+        params={
+            "tree_layout": tree_layout,
+            "prune_redundant_tests": prune_redundant_tests,
+        },
+        verbose=True,
+    )
+    num_pruned = re.search(
+        r"Removed (\d+) test\(s\) whose outcome is already decided",
+        capsys.readouterr().out,
+    )
+    if prune_redundant_tests:
+        assert num_pruned is not None and int(num_pruned.group(1)) > 0
+    else:
+        assert num_pruned is None
+
+    predictor = tl2cgen.Predictor(libpath=libpath)
+    values = [-1.0, -0.0, 0.0, 0.5, 1.0, 2.0, np.nan]
+    X = np.array(list(itertools.product(values, values)), dtype=np.float64)
+    out = predictor.predict(tl2cgen.DMatrix(X, dtype="float64"))
+    expected = treelite.gtil.predict(model, X)
+    np.testing.assert_almost_equal(out, expected, decimal=5)
+
+
+def test_predict_topk_nan():
+    """Test that classes with a NaN margin score are ranked last by predict_topk()"""
+    num_class = 4
+    builder = ModelBuilder(
+        threshold_type="float32",
+        leaf_output_type="float32",
+        metadata=Metadata(
+            num_feature=1,
+            task_type="kMultiClf",
+            average_tree_output=False,
+            num_target=1,
+            num_class=[num_class],
+            leaf_vector_shape=(1, 1),
+        ),
+        tree_annotation=TreeAnnotation(
+            num_tree=num_class,
+            target_id=[0] * num_class,
+            class_id=list(range(num_class)),
+        ),
+        postprocessor=PostProcessorFunc(name="softmax"),
+        base_scores=[0.0] * num_class,
+    )
+    # Class 1 and class 3 get a NaN score for negative inputs; class 0 and class 2 tie
+    left_leaf = [1.0, np.nan, 1.0, np.nan]
+    right_leaf = [-1.0, 2.0, 0.5, -2.0]
+    for class_id in range(num_class):
+        builder.start_tree()
+        builder.start_node(0)
+        builder.numerical_test(
+            feature_id=0,
+            threshold=0.0,
+            default_left=True,
+            opname="<",
+            left_child_key=1,
+            right_child_key=2,
+        )
+        builder.end_node()
+        builder.start_node(1)
+        builder.leaf(left_leaf[class_id])
+        builder.end_node()
+        builder.start_node(2)
+        builder.leaf(right_leaf[class_id])
+        builder.end_node()
+        builder.end_tree()
+    model = builder.commit()
+
+    # The generated C code cannot hold NaN leaf outputs, so walk the trees instead
+    predictor = tl2cgen.interpret(model)
+    dmat = tl2cgen.DMatrix(np.array([[-1.0], [1.0], [np.nan]], dtype=np.float32))
+    margin = predictor.predict(dmat, pred_margin=True)
+    for k in range(1, num_class + 1):
+        index, score = predictor.predict_topk(dmat, k)
+        # NumPy sorts NaN last; a stable sort puts the lower class ID first among ties
+        expected_index = np.argsort(-margin, axis=2, kind="stable")[:, :, :k]
+        np.testing.assert_equal(index, expected_index)
+        np.testing.assert_equal(
+            score, np.take_along_axis(margin, expected_index, axis=2)
+        )
+    index, _ = predictor.predict_topk(dmat, num_class)
+    np.testing.assert_equal(
+        index[:, 0, :], [[0, 2, 1, 3], [1, 2, 0, 3], [0, 2, 1, 3]]
+    )
@@ -7,6 +7,7 @@ import pathlib
 import numpy as np
 import pytest
 import treelite
+from scipy.sparse import csr_matrix
 
 import tl2cgen
 from tl2cgen.contrib.util import _libext
@@ -150,6 +151,54 @@ def test_xgb_regression(
         np.testing.assert_almost_equal(out_pred, expected_pred, decimal=3)
 
 
+@given(
+    dataset=standard_regression_datasets(),
+    num_boost_round=integers(min_value=3, max_value=10),
+    missing_frac=sampled_from([0.0, 0.1]),
+)
+@settings(**standard_settings())
+def test_xgb_integer_compare(dataset, num_boost_round, missing_frac):
+    """Test whether comparing thresholds as integers gives the same output as the
+    floating-point comparisons"""
+    X, y = dataset
+    X = X.astype(np.float32)
+    if missing_frac > 0.0:
+        rng = np.random.default_rng(seed=0)
+        X[rng.random(X.shape) < missing_frac] = np.nan
+    dtrain = xgb.DMatrix(X, label=y)
+    param = {"max_depth": 8, "eta": 0.1, "verbosity": 0, "objective": "reg:squarederror"}
+    bst = xgb.train(param, dtrain, num_boost_round=num_boost_round)
+    model = treelite.frontend.from_xgboost(bst)
+    toolchain = os_compatible_toolchains()[0]
+
+    preds = []
+    with TemporaryDirectory() as tmpdir:
+        for integer_compare in [0, 1]:
+            libpath = pathlib.Path(tmpdir) / (f"regression{integer_compare}" + _libext())
+            tl2cgen.export_lib(
+                model,
+                toolchain=toolchain,
+                libpath=libpath,
+                params={"integer_compare": integer_compare},
+                verbose=True,
+            )
+            predictor = tl2cgen.Predictor(libpath=libpath, verbose=True)
+            preds.append(predictor.predict(tl2cgen.DMatrix(X, dtype="float32")))
+            # A sparse matrix stores NaN explicitly; it must be treated as missing too.
+            # Keep the zeros, so that the matrix holds the same values as X.
+            X_csr = csr_matrix(
+                (
+                    X.ravel(),
+                    np.tile(np.arange(X.shape[1]), X.shape[0]),
+                    np.arange(0, X.size + 1, X.shape[1]),
+                ),
+                shape=X.shape,
+            )
+            preds.append(predictor.predict(tl2cgen.DMatrix(X_csr, dtype="float32")))
+    for pred in preds[1:]:
+        np.testing.assert_array_equal(preds[0], pred)
+
+
 @given(
     dataset=standard_classification_datasets(
         n_classes=integers(min_value=3, max_value=5), n_informative=just(5)